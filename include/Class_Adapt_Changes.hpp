@@ -0,0 +1,277 @@
+#ifndef CLASS_ADAPT_CHANGES_HPP_
+#define CLASS_ADAPT_CHANGES_HPP_
+
+// =================================================================================== //
+// INCLUDES                                                                            //
+// =================================================================================== //
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+
+// =================================================================================== //
+// NAME SPACES                                                                         //
+// =================================================================================== //
+using namespace std;
+
+// =================================================================================== //
+// CLASS DEFINITION                                                                    //
+// =================================================================================== //
+
+/*!
+ *	\brief Compact set of the changes of the local octants produced by an adapt
+ *
+ *	The new octants vector is described by three lists of records, sorted by new index:
+ *	- kept: runs of unchanged octants, shifted from the old to the new position;
+ *	- refined: old father replaced by nchildren consecutive new octants;
+ *	- coarsened: old family (nchildren consecutive octants) replaced by one new octant.
+ *
+ *	Every new octant belongs to exactly one record, so the user data can be updated
+ *	by block copies of the kept runs plus the fix-ups of refined and coarsened records.
+ */
+class Class_Adapt_Changes {
+
+	template<int dim> friend class Class_Para_Tree;
+
+	// ------------------------------------------------------------------------------- //
+	// TYPES ------------------------------------------------------------------------- //
+public:
+	/*! Run of unchanged octants. */
+	struct Kept {
+		uint32_t from;			/**< First old index of the run */
+		uint32_t to;			/**< First new index of the run */
+		uint32_t length;		/**< Number of octants of the run */
+	};
+	/*! Refined octant. */
+	struct Refined {
+		uint32_t father;		/**< Old index of the father */
+		uint32_t firstChild;	/**< New index of the first child */
+		uint32_t nchildren;		/**< Number of new octants generated by the father */
+	};
+	/*! Coarsened family. */
+	struct Coarsened {
+		uint32_t firstChild;	/**< Old index of the first child */
+		uint32_t nchildren;		/**< Number of old local octants merged in the father */
+		uint32_t to;			/**< New index of the father */
+	};
+
+	// ------------------------------------------------------------------------------- //
+	// MEMBERS ----------------------------------------------------------------------- //
+	vector<Kept>		kept;			/**< Runs of unchanged octants */
+	vector<Refined>		refined;		/**< Refined octants */
+	vector<Coarsened>	coarsened;		/**< Coarsened families */
+	uint32_t			oldSize;		/**< Number of local octants before adapt */
+	uint32_t			newSize;		/**< Number of local octants after adapt */
+
+	// ------------------------------------------------------------------------------- //
+	// CONSTRUCTORS ------------------------------------------------------------------ //
+public:
+	Class_Adapt_Changes() : oldSize(0), newSize(0){};
+
+	// ------------------------------------------------------------------------------- //
+	// METHODS ----------------------------------------------------------------------- //
+public:
+	/*! Clear the change set.
+	 */
+	void clear(){
+		kept.clear();
+		refined.clear();
+		coarsened.clear();
+		oldSize = newSize = 0;
+	};
+
+	/*! Are the local octants unchanged by the adapt?
+	 */
+	bool empty() const{
+		return (refined.empty() && coarsened.empty() && oldSize == newSize
+				&& kept.size() <= 1 && (kept.empty() || kept[0].from == 0));
+	};
+
+	/*! Update a vector of per-octant data with copy policy: the children take the value
+	 * of the father and the father takes the value of its first child.
+	 * The data are updated in place, the unchanged runs are moved by block copies
+	 * (memmove for trivially copyable data).
+	 * \param[in,out] data Vector of size oldSize, on output of size newSize.
+	 */
+	template<class T>
+	void apply(vector<T> & data) const{
+		update(data, Copy<T>());
+	};
+
+	/*! Update a vector of per-octant extensive data (e.g. a computational cost): the children
+	 * take an equal share of the father and the father takes the sum of its local children.
+	 * The data are updated in place, the unchanged runs are moved by block copies
+	 * (memmove for trivially copyable data).
+	 * \param[in,out] data Vector of size oldSize, on output of size newSize.
+	 */
+	template<class T>
+	void applyShare(vector<T> & data) const{
+		update(data, Share<T>());
+	};
+
+private:
+	/*! Copy projection of apply. */
+	template<class T>
+	struct Copy {
+		T refine(const T & father, uint32_t nchildren) const{
+			return father;
+		};
+		T coarse(typename vector<T>::const_iterator firstChild, uint32_t nchildren) const{
+			return *firstChild;
+		};
+	};
+
+	/*! Share projection of applyShare. */
+	template<class T>
+	struct Share {
+		T refine(const T & father, uint32_t nchildren) const{
+			return father * (1.0 / nchildren);
+		};
+		T coarse(typename vector<T>::const_iterator firstChild, uint32_t nchildren) const{
+			T sum = *firstChild;
+			for (uint32_t j = 1; j < nchildren; j++){
+				sum = sum + *(firstChild + j);
+			}
+			return sum;
+		};
+	};
+
+	/*! Record of the change set in new index order: kind (0 kept, 1 refined, 2 coarsened),
+	 * position in its list, first old index read and past the last new index written.
+	 */
+	struct Step {
+		uint8_t kind;
+		uint32_t idx;
+		uint32_t read;
+		uint32_t writeEnd;
+	};
+
+	/*! Update a vector of per-octant data in place with a projection.
+	 * The records are scanned by new index: a record is applied when its new octants do not
+	 * overlap the old octants of the next record, otherwise it is deferred after the next one.
+	 * The old octants read by a record are never overwritten before it is applied, since the
+	 * records are ordered by both old and new index.
+	 */
+	template<class T, class Projection>
+	void update(vector<T> & data, const Projection & projection) const{
+		vector<Step> deferred;
+		Step step, next;
+		size_t ik = 0, ir = 0, ic = 0;
+		bool hasStep;
+
+		if (newSize > data.size()){
+			data.resize(newSize);
+		}
+		hasStep = nextStep(ik, ir, ic, step);
+		while (hasStep){
+			hasStep = nextStep(ik, ir, ic, next);
+			if (hasStep && step.writeEnd > next.read){
+				deferred.push_back(step);
+			}
+			else{
+				applyStep(data, projection, step);
+				while (!deferred.empty()){
+					applyStep(data, projection, deferred.back());
+					deferred.pop_back();
+				}
+			}
+			step = next;
+		}
+		data.resize(newSize);
+	};
+
+	/*! Next record by new index from the positions in the three lists.
+	 */
+	bool nextStep(size_t & ik, size_t & ir, size_t & ic, Step & step) const{
+		uint32_t tok = (ik < kept.size()) ? kept[ik].to : newSize;
+		uint32_t tor = (ir < refined.size()) ? refined[ir].firstChild : newSize;
+		uint32_t toc = (ic < coarsened.size()) ? coarsened[ic].to : newSize;
+		if (tok < tor && tok < toc){
+			Step rec = {0, uint32_t(ik), kept[ik].from, kept[ik].to + kept[ik].length};
+			step = rec;
+			ik++;
+		}
+		else if (tor < toc){
+			Step rec = {1, uint32_t(ir), refined[ir].father, refined[ir].firstChild + refined[ir].nchildren};
+			step = rec;
+			ir++;
+		}
+		else if (toc < newSize){
+			Step rec = {2, uint32_t(ic), coarsened[ic].firstChild, coarsened[ic].to + 1};
+			step = rec;
+			ic++;
+		}
+		else{
+			return false;
+		}
+		return true;
+	};
+
+	/*! Apply one record: a kept run is moved forward or backward as its shift requires,
+	 * the old value of a father or a family is read before writing the new octants.
+	 */
+	template<class T, class Projection>
+	void applyStep(vector<T> & data, const Projection & projection, const Step & step) const{
+		typename vector<T>::iterator first = data.begin();
+		if (step.kind == 0){
+			const Kept & rec = kept[step.idx];
+			if (rec.to < rec.from){
+				copy(first + rec.from, first + rec.from + rec.length, first + rec.to);
+			}
+			else if (rec.to > rec.from){
+				copy_backward(first + rec.from, first + rec.from + rec.length, first + rec.to + rec.length);
+			}
+		}
+		else if (step.kind == 1){
+			const Refined & rec = refined[step.idx];
+			T value = projection.refine(data[rec.father], rec.nchildren);
+			fill(first + rec.firstChild, first + rec.firstChild + rec.nchildren, value);
+		}
+		else{
+			const Coarsened & rec = coarsened[step.idx];
+			typename vector<T>::const_iterator firstChild = data.begin() + rec.firstChild;
+			data[rec.to] = projection.coarse(firstChild, rec.nchildren);
+		}
+	};
+
+	/*! Build the change set from the octants after adapt and a mapper new->old octants.
+	 */
+	template<class OctantsType>
+	void build(const OctantsType & octants, const vector<uint32_t> & mapidx, uint32_t oldSize_){
+		uint32_t i, j, next;
+		uint32_t nocts = octants.size();
+
+		clear();
+		oldSize = oldSize_;
+		newSize = nocts;
+		i = 0;
+		while (i < nocts){
+			j = i+1;
+			if (octants[i].getIsNewR()){
+				while (j < nocts && octants[j].getIsNewR() && mapidx[j] == mapidx[i]){
+					j++;
+				}
+			}
+			// A father built by coarsening can inherit the refinement flag of its family,
+			// a refinement always generates more than one new octant
+			if (octants[i].getIsNewR() && (j-i > 1 || !octants[i].getIsNewC())){
+				Refined rec = {mapidx[i], i, j-i};
+				refined.push_back(rec);
+			}
+			else if (octants[i].getIsNewC()){
+				next = (j < nocts) ? mapidx[j] : oldSize;
+				Coarsened rec = {mapidx[i], next-mapidx[i], i};
+				coarsened.push_back(rec);
+			}
+			else{
+				while (j < nocts && !octants[j].getIsNewR() && !octants[j].getIsNewC() && mapidx[j] == mapidx[j-1]+1){
+					j++;
+				}
+				Kept rec = {mapidx[i], i, j-i};
+				kept.push_back(rec);
+			}
+			i = j;
+		}
+	};
+};
+
+#endif /* CLASS_ADAPT_CHANGES_HPP_ */
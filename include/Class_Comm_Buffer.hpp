@@ -9,6 +9,8 @@
 #include <cstdint>
 #include <typeinfo>
 #include <algorithm>
+#include <cstring>
+#include <cassert>
 #include "mpi.h"
 #include "mpi_datatype_conversion.hpp"
 
@@ -28,6 +30,7 @@ class Class_Comm_Buffer {
 	// ------------------------------------------------------------------------------- //
 	// MEMBERS ----------------------------------------------------------------------- //
 	uint32_t commBufferSize;
+	uint32_t commBufferCapacity;
 	char* commBuffer;
 	int pos;
 	MPI_Comm comm;
@@ -37,19 +40,30 @@ class Class_Comm_Buffer {
 public:
 	Class_Comm_Buffer();
 	Class_Comm_Buffer(MPI_Comm comm_);
+	Class_Comm_Buffer(uint32_t size, MPI_Comm comm_);
 	Class_Comm_Buffer(uint32_t size, char value, MPI_Comm comm_);
 	Class_Comm_Buffer(const Class_Comm_Buffer& other);
+	Class_Comm_Buffer(Class_Comm_Buffer&& other) noexcept;
 	~Class_Comm_Buffer();
 
 	// ------------------------------------------------------------------------------- //
 	// METHODS ----------------------------------------------------------------------- //
-	//TODO routines write and read to write and read POD types in buffer
 	Class_Comm_Buffer& operator=(const Class_Comm_Buffer& rhs);
+	Class_Comm_Buffer& operator=(Class_Comm_Buffer&& rhs) noexcept;
 
+	//set the size of the buffer and rewind it, the memory is reallocated (not initialized) only if the capacity is exceeded
+	void resize(uint32_t size);
+
+	//write and read trivially copyable types in buffer (raw bytes, the buffers are communicated as MPI_BYTE),
+	//reads and writes past the size of the buffer are caught by assertions in debug builds
+	template<class T>
+	void write(const T& val);
 	template<class T>
-	void write(T& val);
+	void write(const T* vals, uint32_t n);
 	template<class T>
 	void read(T& val);
+	template<class T>
+	void read(T* vals, uint32_t n);
 };
 
 #include "Class_Comm_Buffer.tpp"
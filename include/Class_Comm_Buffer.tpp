@@ -1,12 +1,27 @@
 template<class T>
-void Class_Comm_Buffer::write(T& val) {
-	MPI_Datatype datatype = convert<T>();
-	int error = MPI_Pack(&val,1,datatype,commBuffer,commBufferSize,&pos,comm);
+void Class_Comm_Buffer::write(const T& val) {
+	assert(pos + sizeof(T) <= commBufferSize);
+	memcpy(commBuffer + pos, &val, sizeof(T));
+	pos += sizeof(T);
+};
+
+template<class T>
+void Class_Comm_Buffer::write(const T* vals, uint32_t n) {
+	assert(pos + n * sizeof(T) <= commBufferSize);
+	memcpy(commBuffer + pos, vals, n * sizeof(T));
+	pos += n * sizeof(T);
 };
 
 template<class T>
 void Class_Comm_Buffer::read(T& val) {
-	MPI_Datatype datatype = convert<T>();
-	int error = MPI_Unpack(commBuffer,commBufferSize,&pos,&val,1,datatype,comm);
+	assert(pos + sizeof(T) <= commBufferSize);
+	memcpy(&val, commBuffer + pos, sizeof(T));
+	pos += sizeof(T);
 };
 
+template<class T>
+void Class_Comm_Buffer::read(T* vals, uint32_t n) {
+	assert(pos + n * sizeof(T) <= commBufferSize);
+	memcpy(vals, commBuffer + pos, n * sizeof(T));
+	pos += n * sizeof(T);
+};
@@ -0,0 +1,142 @@
+#if NOMPI==0
+#ifndef CLASS_COMM_PLAN_HPP_
+#define CLASS_COMM_PLAN_HPP_
+
+// =================================================================================== //
+// INCLUDES                                                                            //
+// =================================================================================== //
+#include <stdint.h>
+#include <vector>
+#include "mpi.h"
+#include "Class_Comm_Buffer.hpp"
+
+// =================================================================================== //
+// NAME SPACES                                                                         //
+// =================================================================================== //
+using namespace std;
+
+// =================================================================================== //
+// CLASS DEFINITION                                                                    //
+// =================================================================================== //
+
+/*!
+ *	\brief Reusable plan of the ghost data exchange of a mesh state
+ *
+ *	The plan is built by Class_Para_Tree::communicate the first time it is used on a
+ *	ghost layer and it is rebuilt only when the ghost layer changes (adapt, load balance).
+ *	It holds one send and one receive buffer per neighbor process and the ghost offset
+ *	of every neighbor, so the messages carry the user data only.
+ *	For fixed size data the buffers are allocated once and exchanged by persistent
+ *	requests, without any size handshake; for variable size data the buffers are
+ *	reallocated only when their size changes.
+ *	A typed plan exchanges a vector of trivially copyable data directly: the border
+ *	octants are sent by indexed datatypes and the ghost data are received in place.
+ *	The exchange can be split by Class_Para_Tree::communicateBegin/communicateEnd to
+ *	overlap it with the computation on the interior octants.
+ *
+ *	A plan is bound to the user data size policy: one plan for every fixed size
+ *	(or variable size) field avoids rebuilds when several fields are communicated.
+ */
+class Class_Comm_Plan {
+
+	template<int dim> friend class Class_Para_Tree;
+
+	// ------------------------------------------------------------------------------- //
+	// MEMBERS ----------------------------------------------------------------------- //
+	vector<int>					procs;			/**< Neighbor processes */
+	vector<uint32_t>			ghostOffsets;	/**< Index of the first ghost received from each neighbor */
+	vector<uint32_t>			nofGhosts;		/**< Number of ghosts received from each neighbor */
+	vector<Class_Comm_Buffer>	sendBuffers;	/**< Send buffer of each neighbor */
+	vector<Class_Comm_Buffer>	recvBuffers;	/**< Receive buffer of each neighbor */
+	vector<int>					sendSizes;		/**< Size in bytes of the send buffers */
+	vector<int>					recvSizes;		/**< Size in bytes of the receive buffers */
+	vector<MPI_Request>			requests;		/**< Persistent receive and send requests (fixed size only) */
+	vector<MPI_Aint>			sendDispls;		/**< Absolute addresses of the send buffers (variable size only) */
+	vector<MPI_Aint>			recvDispls;		/**< Absolute addresses of the receive buffers (variable size only) */
+	vector<MPI_Datatype>		types;			/**< Receive datatype of every neighbor (variable size and typed data) */
+	vector<MPI_Datatype>		sendTypes;		/**< Indexed datatype of the border octants of every neighbor (typed data only) */
+	MPI_Request					neighborRequest;	/**< Request of the non-blocking neighborhood exchange (variable size only) */
+	bool						pending;		/**< True if an exchange is started and not completed */
+	size_t						fixedSize;		/**< Size in bytes of the data of one octant (0 for variable size) */
+	bool						typed;			/**< True if the plan exchanges a vector of data in place (no buffers) */
+	uint64_t					stamp;			/**< Ghost layer state the plan is built for */
+	bool						built;			/**< True if the plan has been built */
+
+	// ------------------------------------------------------------------------------- //
+	// CONSTRUCTORS ------------------------------------------------------------------ //
+public:
+	Class_Comm_Plan() : neighborRequest(MPI_REQUEST_NULL), pending(false), fixedSize(0), typed(false), stamp(0), built(false){};
+	/*! Copy constructor: persistent requests cannot be shared, so the copy is
+	 * an empty plan that is built at its first use.
+	 */
+	Class_Comm_Plan(const Class_Comm_Plan &) : neighborRequest(MPI_REQUEST_NULL), pending(false), fixedSize(0), typed(false), stamp(0), built(false){};
+	~Class_Comm_Plan(){
+		clear();
+	};
+
+	/*! Assignment operator: the plan is cleared and built at its next use.
+	 */
+	Class_Comm_Plan& operator=(const Class_Comm_Plan & rhs){
+		if (this != &rhs){
+			clear();
+		}
+		return *this;
+	};
+
+	// ------------------------------------------------------------------------------- //
+	// METHODS ----------------------------------------------------------------------- //
+public:
+	/*! Release the buffers and the persistent requests of the plan.
+	 * A started exchange is completed before releasing its buffers.
+	 */
+	void clear(){
+		int finalized = 0;
+		MPI_Finalized(&finalized);
+		if (pending && !finalized){
+			if (!requests.empty()){
+				MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+			}
+			if (neighborRequest != MPI_REQUEST_NULL){
+				MPI_Wait(&neighborRequest, MPI_STATUS_IGNORE);
+			}
+		}
+		pending = false;
+		neighborRequest = MPI_REQUEST_NULL;
+		for (size_t i = 0; i < requests.size() && !finalized; i++){
+			if (requests[i] != MPI_REQUEST_NULL){
+				MPI_Request_free(&requests[i]);
+			}
+		}
+		for (size_t i = 0; i < sendTypes.size() && !finalized; i++){
+			MPI_Type_free(&sendTypes[i]);
+		}
+		sendTypes.clear();
+		requests.clear();
+		procs.clear();
+		ghostOffsets.clear();
+		nofGhosts.clear();
+		sendBuffers.clear();
+		recvBuffers.clear();
+		sendSizes.clear();
+		recvSizes.clear();
+		sendDispls.clear();
+		recvDispls.clear();
+		types.clear();
+		fixedSize = 0;
+		typed = false;
+		stamp = 0;
+		built = false;
+	};
+
+	/*! Is the plan built for a ghost layer state and a data size?
+	 * \param[in] stamp_ Ghost layer state.
+	 * \param[in] fixedSize_ Size in bytes of the data of one octant (0 for variable size).
+	 * \param[in] typed_ True for a typed plan.
+	 */
+	bool isValid(uint64_t stamp_, size_t fixedSize_, bool typed_ = false) const{
+		return (built && stamp == stamp_ && fixedSize == fixedSize_ && typed == typed_);
+	};
+};
+
+#endif /* CLASS_COMM_PLAN_HPP_ */
+#endif /* NOMPI */
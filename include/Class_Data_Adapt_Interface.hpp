@@ -0,0 +1,28 @@
+// Data Transfer Class for Adapt
+
+#ifndef CLASS_DATA_ADAPT_INTERFACE_HPP_
+#define CLASS_DATA_ADAPT_INTERFACE_HPP_
+
+#include <stdint.h>
+
+template <class Impl>
+class Class_Data_Adapt_Interface {
+public:
+	void move(const uint32_t from, const uint32_t to);
+	void refine(const uint32_t father, const uint32_t firstChild, const uint8_t nchildren);
+	void coarse(const uint32_t firstChild, const uint8_t nchildren, const uint32_t to);
+	void resize(uint32_t newSize);
+	void shrink();
+
+protected:
+	Class_Data_Adapt_Interface();
+
+private:
+	//BartonHackman trick
+	Impl& getImpl();
+	const Impl& getImpl() const;
+};
+
+#include "Class_Data_Adapt_Interface.tpp"
+
+#endif /* CLASS_DATA_ADAPT_INTERFACE_HPP_ */
@@ -0,0 +1,38 @@
+template<class Impl>
+inline Class_Data_Adapt_Interface<Impl>::Class_Data_Adapt_Interface() {};
+
+template<class Impl>
+inline void Class_Data_Adapt_Interface<Impl>::move(const uint32_t from, const uint32_t to) {
+	return getImpl().move(from,to);
+}
+
+template<class Impl>
+inline void Class_Data_Adapt_Interface<Impl>::refine(const uint32_t father, const uint32_t firstChild, const uint8_t nchildren) {
+	return getImpl().refine(father,firstChild,nchildren);
+}
+
+template<class Impl>
+inline void Class_Data_Adapt_Interface<Impl>::coarse(const uint32_t firstChild, const uint8_t nchildren, const uint32_t to) {
+	return getImpl().coarse(firstChild,nchildren,to);
+}
+
+template<class Impl>
+inline void Class_Data_Adapt_Interface<Impl>::resize(uint32_t newSize){
+	return getImpl().resize(newSize);
+}
+
+template<class Impl>
+inline void Class_Data_Adapt_Interface<Impl>::shrink(){
+	return getImpl().shrink();
+}
+
+template<class Impl>
+inline Impl& Class_Data_Adapt_Interface<Impl>::getImpl() {
+	return static_cast<Impl &>(*this);
+}
+
+template<class Impl>
+inline const Impl& Class_Data_Adapt_Interface<Impl>::getImpl() const {
+	return static_cast<const Impl &>(*this);
+}
+
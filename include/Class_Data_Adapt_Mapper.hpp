@@ -0,0 +1,60 @@
+#ifndef CLASS_DATA_ADAPT_MAPPER_HPP_
+#define CLASS_DATA_ADAPT_MAPPER_HPP_
+
+// =================================================================================== //
+// INCLUDES                                                                            //
+// =================================================================================== //
+#include "Class_Data_Adapt_Interface.hpp"
+#include <stdint.h>
+#include <vector>
+
+// =================================================================================== //
+// CLASS DEFINITION                                                                    //
+// =================================================================================== //
+
+/*!
+ *	\brief Mapper from new octants to old octants as adapt user data
+ *
+ *	mapidx[i] is the index before adapt of the i-th octant: the father of a new child
+ *	and the first child of a new father. The local tree walks with a mapper
+ *	(refine(mapidx), coarse(mapidx), checkCoarse(..., mapidx)) are the walks with user
+ *	data instantiated on it.
+ */
+class Class_Data_Adapt_Mapper : public Class_Data_Adapt_Interface<Class_Data_Adapt_Mapper> {
+
+	// ------------------------------------------------------------------------------- //
+	// MEMBERS ----------------------------------------------------------------------- //
+	std::vector<uint32_t> & mapidx;		/**< Mapper from new octants to old octants */
+
+	// ------------------------------------------------------------------------------- //
+	// CONSTRUCTORS ------------------------------------------------------------------ //
+public:
+	Class_Data_Adapt_Mapper(std::vector<uint32_t> & mapidx_) : mapidx(mapidx_){};
+
+	// ------------------------------------------------------------------------------- //
+	// METHODS ----------------------------------------------------------------------- //
+public:
+	void move(const uint32_t from, const uint32_t to){
+		mapidx[to] = mapidx[from];
+	};
+
+	void refine(const uint32_t father, const uint32_t firstChild, const uint8_t nchildren){
+		uint32_t oldFather = mapidx[father];
+		for (uint8_t i=0; i<nchildren; i++){
+			mapidx[firstChild+i] = oldFather;
+		}
+	};
+
+	void coarse(const uint32_t firstChild, const uint8_t nchildren, const uint32_t to){
+		mapidx[to] = mapidx[firstChild];
+	};
+
+	void resize(uint32_t newSize){
+		mapidx.resize(newSize);
+		mapidx.shrink_to_fit();
+	};
+
+	void shrink(){};
+};
+
+#endif /* CLASS_DATA_ADAPT_MAPPER_HPP_ */
@@ -0,0 +1,37 @@
+#ifndef CLASS_DATA_ADAPT_NONE_HPP_
+#define CLASS_DATA_ADAPT_NONE_HPP_
+
+// =================================================================================== //
+// INCLUDES                                                                            //
+// =================================================================================== //
+#include "Class_Data_Adapt_Interface.hpp"
+#include <stdint.h>
+
+// =================================================================================== //
+// CLASS DEFINITION                                                                    //
+// =================================================================================== //
+
+/*!
+ *	\brief Empty adapt user data
+ *
+ *	Every call is a no-op: the local tree walks adapting the octants without user data
+ *	(refine(), coarse(), checkCoarse()) are the walks with user data instantiated on it.
+ */
+class Class_Data_Adapt_None : public Class_Data_Adapt_Interface<Class_Data_Adapt_None> {
+
+	// ------------------------------------------------------------------------------- //
+	// CONSTRUCTORS ------------------------------------------------------------------ //
+public:
+	Class_Data_Adapt_None(){};
+
+	// ------------------------------------------------------------------------------- //
+	// METHODS ----------------------------------------------------------------------- //
+public:
+	void move(const uint32_t from, const uint32_t to){};
+	void refine(const uint32_t father, const uint32_t firstChild, const uint8_t nchildren){};
+	void coarse(const uint32_t firstChild, const uint8_t nchildren, const uint32_t to){};
+	void resize(uint32_t newSize){};
+	void shrink(){};
+};
+
+#endif /* CLASS_DATA_ADAPT_NONE_HPP_ */
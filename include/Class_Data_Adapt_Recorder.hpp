@@ -0,0 +1,275 @@
+#ifndef CLASS_DATA_ADAPT_RECORDER_HPP_
+#define CLASS_DATA_ADAPT_RECORDER_HPP_
+
+// =================================================================================== //
+// INCLUDES                                                                            //
+// =================================================================================== //
+#include "Class_Data_Adapt_Interface.hpp"
+#include "Class_Adapt_Changes.hpp"
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+
+// =================================================================================== //
+// CLASS DEFINITION                                                                    //
+// =================================================================================== //
+
+/*!
+ *	\brief Recorder of the change set of an adapt as adapt user data
+ *
+ *	The recorder holds the map new->old octants as a list of runs instead of a vector
+ *	with one entry per octant: a run is a block of consecutive octants that are unchanged
+ *	(with consecutive old indices), children of the same old father or a coarsened father.
+ *	The writes of a local tree walk are consecutive (descending in refine, ascending in
+ *	coarse and checkCoarse), so they are collected in a pending block of runs that is
+ *	merged in the committed runs only when the walk jumps or resizes the data.
+ *	A family coarsened and refined again in the same adapt is recorded as unchanged.
+ *	At the end of the adapt the runs are the records of the Class_Adapt_Changes.
+ */
+class Class_Data_Adapt_Recorder : public Class_Data_Adapt_Interface<Class_Data_Adapt_Recorder> {
+
+	// ------------------------------------------------------------------------------- //
+	// TYPES ------------------------------------------------------------------------- //
+	enum Kind {
+		KEPT,				/**< Unchanged octants, old index from+i */
+		REFINED,			/**< Children of the old octant from */
+		COARSENED,			/**< Father of the old family starting at from */
+		UNSET				/**< Octants added by resize, not written yet */
+	};
+	/*! Run of new octants with the same kind. */
+	struct Run {
+		uint32_t to;		/**< First new index of the run */
+		uint32_t length;	/**< Number of octants of the run */
+		uint32_t from;		/**< Old index of the first octant of the run */
+		Kind kind;			/**< Kind of the octants of the run */
+		uint32_t family;	/**< Old octants of a coarsened father if they are unchanged and consecutive, 0 otherwise */
+	};
+
+	// ------------------------------------------------------------------------------- //
+	// MEMBERS ----------------------------------------------------------------------- //
+	std::vector<Run>	runs;			/**< Committed runs, sorted by new index */
+	std::vector<Run>	block;			/**< Pending runs, in write order */
+	uint32_t			lo;				/**< First new index of the pending block */
+	uint32_t			hi;				/**< Past the last new index of the pending block */
+	bool				descending;		/**< Is the pending block written backward? */
+	uint32_t			oldSize;		/**< Number of local octants before adapt */
+	uint32_t			size;			/**< Current number of local octants */
+	mutable size_t		cursor;			/**< Last committed run read */
+
+	// ------------------------------------------------------------------------------- //
+	// CONSTRUCTORS ------------------------------------------------------------------ //
+public:
+	Class_Data_Adapt_Recorder(uint32_t nocts) : lo(0), hi(0), descending(false), oldSize(nocts), size(nocts), cursor(0){
+		if (nocts > 0){
+			Run run = {0, nocts, 0, KEPT, 0};
+			runs.push_back(run);
+		}
+	};
+
+	// ------------------------------------------------------------------------------- //
+	// METHODS ----------------------------------------------------------------------- //
+public:
+	void move(const uint32_t from, const uint32_t to){
+		Run value = get(from);
+		set(to, value.from, value.kind, value.family);
+	};
+
+	void refine(const uint32_t father, const uint32_t firstChild, const uint8_t nchildren){
+		Run value = get(father);
+		// A father coarsened in the same adapt and refined again (e.g. by the 2:1 balance)
+		// gives back its old children unchanged
+		bool restore = (value.kind == COARSENED && value.family == nchildren);
+		for (uint8_t i=nchildren; i>0; i--){
+			if (restore){
+				set(firstChild+i-1, value.from+i-1, KEPT);
+			}
+			else{
+				set(firstChild+i-1, value.from, REFINED);
+			}
+		}
+	};
+
+	void coarse(const uint32_t firstChild, const uint8_t nchildren, const uint32_t to){
+		Run first = get(firstChild);
+		Run last = get(firstChild+nchildren-1);
+		bool unchanged = (first.kind == KEPT && last.kind == KEPT && last.from == first.from+nchildren-1);
+		set(to, first.from, COARSENED, unchanged ? nchildren : 0);
+	};
+
+	void resize(uint32_t newSize){
+		commit();
+		if (newSize < size){
+			while (!runs.empty() && runs.back().to >= newSize){
+				runs.pop_back();
+			}
+			if (!runs.empty() && runs.back().to + runs.back().length > newSize){
+				runs.back().length = newSize - runs.back().to;
+			}
+		}
+		else if (newSize > size){
+			Run run = {size, newSize-size, 0, UNSET, 0};
+			runs.push_back(run);
+		}
+		size = newSize;
+		cursor = 0;
+	};
+
+	void shrink(){};
+
+	/*! Fill a change set with the recorded runs: adjacent runs of unchanged octants
+	 * with consecutive old indices and adjacent runs of children of the same father
+	 * are merged in one record.
+	 * \param[out] changes Change set of the local octants.
+	 */
+	void build(Class_Adapt_Changes & changes){
+		commit();
+		changes.clear();
+		changes.oldSize = oldSize;
+		changes.newSize = size;
+		size_t i = 0, j;
+		while (i < runs.size()){
+			Run run = runs[i];
+			j = i+1;
+			while (j < runs.size() && runs[j].kind == run.kind && (run.kind == KEPT || run.kind == REFINED)
+					&& runs[j].from == run.from + (run.kind == KEPT)*run.length){
+				run.length += runs[j].length;
+				j++;
+			}
+			if (run.kind == KEPT){
+				Class_Adapt_Changes::Kept rec = {run.from, run.to, run.length};
+				changes.kept.push_back(rec);
+			}
+			else if (run.kind == REFINED){
+				Class_Adapt_Changes::Refined rec = {run.from, run.to, run.length};
+				changes.refined.push_back(rec);
+			}
+			else if (run.kind == COARSENED){
+				// A coarsened father covers the old octants up to the next recorded one
+				uint32_t next = (j < runs.size()) ? runs[j].from : oldSize;
+				Class_Adapt_Changes::Coarsened rec = {run.from, next-run.from, run.to};
+				changes.coarsened.push_back(rec);
+			}
+			i = j;
+		}
+	};
+
+private:
+	/*! Run of length one with the old index and the kind of a new octant.
+	 */
+	Run get(const uint32_t idx) const{
+		const Run * run;
+		if (idx >= lo && idx < hi){
+			run = &findRun(block, idx, descending);
+		}
+		else if (cursor < runs.size() && contains(runs[cursor], idx)){
+			run = &runs[cursor];
+		}
+		else if (cursor+1 < runs.size() && contains(runs[cursor+1], idx)){
+			run = &runs[++cursor];
+		}
+		else{
+			run = &findRun(runs, idx, false);
+			cursor = run - &runs[0];
+		}
+		Run value = {idx, 1, run->from + (run->kind == KEPT)*(idx - run->to), run->kind, run->family};
+		return value;
+	};
+
+	/*! Is a new index in a run?
+	 */
+	static bool contains(const Run & run, const uint32_t idx){
+		return (idx >= run.to && idx - run.to < run.length);
+	};
+
+	/*! Run containing a new index in a list of runs sorted by new index, backward if reverse.
+	 */
+	static const Run & findRun(const std::vector<Run> & list, const uint32_t idx, bool reverse){
+		size_t first = 0, count = list.size(), step;
+		// Binary search of the first run starting after idx (not after idx if reverse)
+		while (count > 0){
+			step = count/2;
+			if ((list[first+step].to <= idx) != reverse){
+				first += step+1;
+				count -= step+1;
+			}
+			else{
+				count = step;
+			}
+		}
+		return reverse ? list[first] : list[first-1];
+	};
+
+	/*! Write the old index and the kind of a new octant, a write next to the pending block
+	 * extends it (forward or backward), any other write commits it and starts a new one.
+	 */
+	void set(const uint32_t idx, const uint32_t from, const Kind kind, const uint32_t family = 0){
+		bool single = (hi - lo == 1);
+		if (!block.empty() && idx == hi && (single || !descending)){
+			Run & last = block.back();
+			descending = false;
+			hi++;
+			if (last.kind == kind && ((kind == KEPT && from == last.from + last.length) || (kind == REFINED && from == last.from))){
+				last.length++;
+				return;
+			}
+		}
+		else if (!block.empty() && idx + 1 == lo && (single || descending)){
+			Run & last = block.back();
+			descending = true;
+			lo--;
+			if (last.kind == kind && ((kind == KEPT && from + 1 == last.from) || (kind == REFINED && from == last.from))){
+				last.to--;
+				last.from = from;
+				last.length++;
+				return;
+			}
+		}
+		else{
+			commit();
+			lo = idx;
+			hi = idx+1;
+		}
+		Run run = {idx, 1, from, kind, family};
+		block.push_back(run);
+	};
+
+	/*! Replace the committed runs overlapping the pending block with the pending runs.
+	 */
+	void commit(){
+		if (block.empty()){
+			return;
+		}
+		if (descending){
+			std::reverse(block.begin(), block.end());
+		}
+		std::vector<Run> merged;
+		merged.reserve(runs.size() + block.size() + 1);
+		size_t i;
+		// Runs before the block, the one across lo is cut
+		for (i=0; i<runs.size() && runs[i].to < lo; i++){
+			Run head = runs[i];
+			head.length = std::min(head.length, lo - head.to);
+			merged.push_back(head);
+		}
+		merged.insert(merged.end(), block.begin(), block.end());
+		// Runs after the block, the one across hi is cut
+		for (i=(i>0 ? i-1 : 0); i<runs.size(); i++){
+			if (runs[i].to + runs[i].length > hi){
+				Run tail = runs[i];
+				if (tail.to < hi){
+					tail.from += (tail.kind == KEPT)*(hi - tail.to);
+					tail.length -= hi - tail.to;
+					tail.to = hi;
+				}
+				merged.push_back(tail);
+			}
+		}
+		runs.swap(merged);
+		block.clear();
+		lo = hi = 0;
+		descending = false;
+		cursor = 0;
+	};
+};
+
+#endif /* CLASS_DATA_ADAPT_RECORDER_HPP_ */
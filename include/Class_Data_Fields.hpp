@@ -0,0 +1,164 @@
+#ifndef CLASS_DATA_FIELDS_HPP_
+#define CLASS_DATA_FIELDS_HPP_
+
+// =================================================================================== //
+// INCLUDES                                                                            //
+// =================================================================================== //
+#include "Class_Data_Adapt_Interface.hpp"
+#include "Class_Data_LB_Interface.hpp"
+#include "Class_Data_Comm_Interface.hpp"
+#if NOMPI==0
+#include "Class_Comm_Buffer.hpp"
+#endif
+#include <stdint.h>
+#include <vector>
+#include <functional>
+
+// =================================================================================== //
+// NAME SPACES                                                                         //
+// =================================================================================== //
+using namespace std;
+
+// =================================================================================== //
+// TYPES                                                                               //
+// =================================================================================== //
+
+/*! Projection policies of a per-octant field during adapt.
+ */
+enum Adapt_Policy {
+	ADAPT_COPY,		/**< Children take the value of the father, father takes the value of the first child */
+	ADAPT_AVERAGE,	/**< Children take the value of the father, father takes the mean of the children */
+	ADAPT_VOLUME,	/**< Extensive quantity: the father value is split over the children, children values are summed in the father */
+	ADAPT_USER		/**< User functors for prolongation and restriction */
+};
+
+// =================================================================================== //
+// CLASS DEFINITION                                                                    //
+// =================================================================================== //
+
+/*!
+ *	\brief Registry of per-octant user fields projected by adapt, migrated by load balance
+ *	and communicated to the ghost octants
+ *
+ *	Each field is a vector with one entry per local octant (same ordering of the octants).
+ *	A field is registered with a projection policy and it is rebuilt by
+ *	Class_Para_Tree::adapt(Class_Data_Adapt_Interface<Impl>&) in the same pass that rewrites the octants.
+ *	Policies ADAPT_AVERAGE and ADAPT_VOLUME need T + T and T * double operators.
+ *	The fields are kept by reference, they must live until the registry is used.
+ *
+ *	The registry is also a load balance user data: Class_Para_Tree::loadBalance migrates all the
+ *	fields of an octant in the same message. The fields registered with a ghost vector are
+ *	communicated together by Class_Para_Tree::communicate(Class_Data_Fields&), one message per
+ *	neighbor process. Load balance and communication need trivially copyable T.
+ */
+class Class_Data_Fields : public Class_Data_Adapt_Interface<Class_Data_Fields>,
+						  public Class_Data_LB_Interface<Class_Data_Fields> {
+
+	// ------------------------------------------------------------------------------- //
+	// FIELD TYPES ------------------------------------------------------------------- //
+	struct Field_Base {
+		virtual ~Field_Base(){};
+		virtual void move(const uint32_t from, const uint32_t to) = 0;
+		virtual void refine(const uint32_t father, const uint32_t firstChild, const uint8_t nchildren) = 0;
+		virtual void coarse(const uint32_t firstChild, const uint8_t nchildren, const uint32_t to) = 0;
+		virtual void resize(uint32_t newSize) = 0;
+		virtual void shrink() = 0;
+		virtual void assign(uint32_t stride, uint32_t length) = 0;
+		virtual size_t size() const = 0;
+		virtual bool hasGhosts() const = 0;
+		virtual void resizeGhosts(uint32_t nghosts) = 0;
+#if NOMPI==0
+		virtual void gather(Class_Comm_Buffer & buff, const uint32_t e) = 0;
+		virtual void scatter(Class_Comm_Buffer & buff, const uint32_t e) = 0;
+		virtual void scatterGhost(Class_Comm_Buffer & buff, const uint32_t e) = 0;
+#endif
+	};
+
+	template<class T>
+	struct Field_Data;
+
+	template<class T, Adapt_Policy policy>
+	struct Field;
+
+	template<class T>
+	struct Field_User;
+
+public:
+	class Ghosts;
+
+	// ------------------------------------------------------------------------------- //
+	// MEMBERS ----------------------------------------------------------------------- //
+	vector<Field_Base*> fields;
+
+	// ------------------------------------------------------------------------------- //
+	// CONSTRUCTORS ------------------------------------------------------------------ //
+public:
+	Class_Data_Fields();
+	~Class_Data_Fields();
+
+private:
+	Class_Data_Fields(const Class_Data_Fields& other);
+	Class_Data_Fields& operator=(const Class_Data_Fields& rhs);
+
+	// ------------------------------------------------------------------------------- //
+	// METHODS ----------------------------------------------------------------------- //
+public:
+	template<Adapt_Policy policy, class T>
+	void addField(vector<T>& data);
+	template<Adapt_Policy policy, class T>
+	void addField(vector<T>& data, vector<T>& ghostData);
+	template<class T>
+	void addField(vector<T>& data,
+			function<void(const T& father, T* children, uint8_t nchildren)> prolongation,
+			function<T(const T* children, uint8_t nchildren)> restriction);
+	template<class T>
+	void addField(vector<T>& data, vector<T>& ghostData,
+			function<void(const T& father, T* children, uint8_t nchildren)> prolongation,
+			function<T(const T* children, uint8_t nchildren)> restriction);
+	void clear();
+	uint32_t getNumFields() const;
+	void resizeGhosts(uint32_t nghosts);
+
+	//adapt
+	void move(const uint32_t from, const uint32_t to);
+	void refine(const uint32_t father, const uint32_t firstChild, const uint8_t nchildren);
+	void coarse(const uint32_t firstChild, const uint8_t nchildren, const uint32_t to);
+	void resize(uint32_t newSize);
+	void shrink();
+
+	//load balance
+	size_t size(const uint32_t e) const;
+	size_t fixedSize() const;
+	void assign(uint32_t stride, uint32_t length);
+#if NOMPI==0
+	void gather(Class_Comm_Buffer & buff, const uint32_t e);
+	void scatter(Class_Comm_Buffer & buff, const uint32_t e);
+#endif
+};
+
+// =================================================================================== //
+
+/*!
+ *	\brief Ghost communication of the fields of a Class_Data_Fields registry
+ *
+ *	Communication user data packing all the fields registered with a ghost vector in the
+ *	same buffer: the data of an octant are gathered from the fields and scattered to the
+ *	ghost vectors (sized by Class_Data_Fields::resizeGhosts).
+ */
+class Class_Data_Fields::Ghosts : public Class_Data_Comm_Interface<Class_Data_Fields::Ghosts> {
+	Class_Data_Fields & fields;
+
+public:
+	Ghosts(Class_Data_Fields & fields_);
+
+	size_t size(const uint32_t e) const;
+	size_t fixedSize() const;
+#if NOMPI==0
+	void gather(Class_Comm_Buffer & buff, const uint32_t e);
+	void scatter(Class_Comm_Buffer & buff, const uint32_t e);
+#endif
+};
+
+#include "Class_Data_Fields.tpp"
+
+#endif /* CLASS_DATA_FIELDS_HPP_ */
@@ -0,0 +1,315 @@
+// =================================================================================== //
+// FIELD TYPES                                                                         //
+// =================================================================================== //
+
+// Storage of a field and of its ghost vector, common to all the projection policies
+template<class T>
+struct Class_Data_Fields::Field_Data : public Class_Data_Fields::Field_Base {
+	vector<T>& data;
+	vector<T>* ghostData;
+
+	Field_Data(vector<T>& data_, vector<T>* ghostData_) : data(data_), ghostData(ghostData_){};
+
+	void move(const uint32_t from, const uint32_t to){
+		data[to] = data[from];
+	};
+
+	void resize(uint32_t newSize){
+		data.resize(newSize);
+	};
+
+	void shrink(){
+		data.shrink_to_fit();
+	};
+
+	void assign(uint32_t stride, uint32_t length){
+		vector<T>(data.begin()+stride, data.begin()+stride+length).swap(data);
+	};
+
+	size_t size() const{
+		return sizeof(T);
+	};
+
+	bool hasGhosts() const{
+		return (ghostData != NULL);
+	};
+
+	void resizeGhosts(uint32_t nghosts){
+		if (ghostData != NULL){
+			ghostData->resize(nghosts);
+		}
+	};
+
+#if NOMPI==0
+	void gather(Class_Comm_Buffer & buff, const uint32_t e){
+		buff.write(data[e]);
+	};
+
+	void scatter(Class_Comm_Buffer & buff, const uint32_t e){
+		buff.read(data[e]);
+	};
+
+	void scatterGhost(Class_Comm_Buffer & buff, const uint32_t e){
+		buff.read((*ghostData)[e]);
+	};
+#endif
+};
+
+template<class T, Adapt_Policy policy>
+struct Class_Data_Fields::Field : public Class_Data_Fields::Field_Data<T> {
+	using Field_Data<T>::data;
+
+	Field(vector<T>& data_, vector<T>* ghostData_) : Field_Data<T>(data_, ghostData_){};
+
+	void refine(const uint32_t father, const uint32_t firstChild, const uint8_t nchildren){
+		// The father can be stored in the slot of the first child
+		T value = data[father];
+		if (policy == ADAPT_VOLUME){
+			value = value * (1.0/double(nchildren));
+		}
+		for (uint8_t i = 0; i < nchildren; i++){
+			data[firstChild+i] = value;
+		}
+	};
+
+	void coarse(const uint32_t firstChild, const uint8_t nchildren, const uint32_t to){
+		if (policy == ADAPT_COPY){
+			data[to] = data[firstChild];
+			return;
+		}
+		T value = data[firstChild];
+		for (uint8_t i = 1; i < nchildren; i++){
+			value = value + data[firstChild+i];
+		}
+		if (policy == ADAPT_AVERAGE){
+			value = value * (1.0/double(nchildren));
+		}
+		data[to] = value;
+	};
+};
+
+// Copy policy doesn't require arithmetic operators on T
+template<class T>
+struct Class_Data_Fields::Field<T,ADAPT_COPY> : public Class_Data_Fields::Field_Data<T> {
+	using Field_Data<T>::data;
+
+	Field(vector<T>& data_, vector<T>* ghostData_) : Field_Data<T>(data_, ghostData_){};
+
+	void refine(const uint32_t father, const uint32_t firstChild, const uint8_t nchildren){
+		T value = data[father];
+		for (uint8_t i = 0; i < nchildren; i++){
+			data[firstChild+i] = value;
+		}
+	};
+
+	void coarse(const uint32_t firstChild, const uint8_t nchildren, const uint32_t to){
+		data[to] = data[firstChild];
+	};
+};
+
+template<class T>
+struct Class_Data_Fields::Field_User : public Class_Data_Fields::Field_Data<T> {
+	using Field_Data<T>::data;
+	function<void(const T&, T*, uint8_t)> prolongation;
+	function<T(const T*, uint8_t)> restriction;
+
+	Field_User(vector<T>& data_, vector<T>* ghostData_,
+			function<void(const T&, T*, uint8_t)> prolongation_,
+			function<T(const T*, uint8_t)> restriction_) :
+		Field_Data<T>(data_, ghostData_), prolongation(prolongation_), restriction(restriction_){};
+
+	void refine(const uint32_t father, const uint32_t firstChild, const uint8_t nchildren){
+		T value = data[father];
+		prolongation(value, &data[firstChild], nchildren);
+	};
+
+	void coarse(const uint32_t firstChild, const uint8_t nchildren, const uint32_t to){
+		data[to] = restriction(&data[firstChild], nchildren);
+	};
+};
+
+// =================================================================================== //
+// CONSTRUCTORS                                                                        //
+// =================================================================================== //
+
+inline Class_Data_Fields::Class_Data_Fields(){};
+
+inline Class_Data_Fields::~Class_Data_Fields(){
+	clear();
+};
+
+// =================================================================================== //
+// METHODS                                                                             //
+// =================================================================================== //
+
+/*! Register a field with a built-in projection policy.
+ * \param[in] data Vector of per-octant values (size equal to the number of local octants).
+ */
+template<Adapt_Policy policy, class T>
+inline void Class_Data_Fields::addField(vector<T>& data){
+	static_assert(policy != ADAPT_USER, "ADAPT_USER fields need prolongation and restriction functors");
+	fields.push_back(new Field<T,policy>(data, NULL));
+};
+
+/*! Register a field with a built-in projection policy and its ghost vector.
+ * \param[in] data Vector of per-octant values (size equal to the number of local octants).
+ * \param[in] ghostData Vector of per-ghost values, filled by Class_Para_Tree::communicate(Class_Data_Fields&).
+ */
+template<Adapt_Policy policy, class T>
+inline void Class_Data_Fields::addField(vector<T>& data, vector<T>& ghostData){
+	static_assert(policy != ADAPT_USER, "ADAPT_USER fields need prolongation and restriction functors");
+	fields.push_back(new Field<T,policy>(data, &ghostData));
+};
+
+/*! Register a field with user projection functors (policy ADAPT_USER).
+ * \param[in] data Vector of per-octant values (size equal to the number of local octants).
+ * \param[in] prolongation Functor writing the nchildren values of the children from the father value.
+ * \param[in] restriction Functor returning the father value from the values of nchildren children.
+ * nchildren can be less than the number of children of an octant only if the family is split among more than two processes.
+ */
+template<class T>
+inline void Class_Data_Fields::addField(vector<T>& data,
+		function<void(const T& father, T* children, uint8_t nchildren)> prolongation,
+		function<T(const T* children, uint8_t nchildren)> restriction){
+	fields.push_back(new Field_User<T>(data, NULL, prolongation, restriction));
+};
+
+/*! Register a field with user projection functors (policy ADAPT_USER) and its ghost vector.
+ * \param[in] data Vector of per-octant values (size equal to the number of local octants).
+ * \param[in] ghostData Vector of per-ghost values, filled by Class_Para_Tree::communicate(Class_Data_Fields&).
+ * \param[in] prolongation Functor writing the nchildren values of the children from the father value.
+ * \param[in] restriction Functor returning the father value from the values of nchildren children.
+ */
+template<class T>
+inline void Class_Data_Fields::addField(vector<T>& data, vector<T>& ghostData,
+		function<void(const T& father, T* children, uint8_t nchildren)> prolongation,
+		function<T(const T* children, uint8_t nchildren)> restriction){
+	fields.push_back(new Field_User<T>(data, &ghostData, prolongation, restriction));
+};
+
+/*! Unregister all the fields (the user vectors are not modified).
+ */
+inline void Class_Data_Fields::clear(){
+	for (uint32_t i = 0; i < fields.size(); i++){
+		delete fields[i];
+		fields[i] = NULL;
+	}
+	fields.clear();
+};
+
+/*! Resize the ghost vectors of the fields.
+ * \param[in] nghosts Number of ghost octants.
+ */
+inline void Class_Data_Fields::resizeGhosts(uint32_t nghosts){
+	for (uint32_t i = 0; i < fields.size(); i++){
+		fields[i]->resizeGhosts(nghosts);
+	}
+};
+
+inline uint32_t Class_Data_Fields::getNumFields() const{
+	return fields.size();
+};
+
+inline void Class_Data_Fields::move(const uint32_t from, const uint32_t to){
+	for (uint32_t i = 0; i < fields.size(); i++){
+		fields[i]->move(from, to);
+	}
+};
+
+inline void Class_Data_Fields::refine(const uint32_t father, const uint32_t firstChild, const uint8_t nchildren){
+	for (uint32_t i = 0; i < fields.size(); i++){
+		fields[i]->refine(father, firstChild, nchildren);
+	}
+};
+
+inline void Class_Data_Fields::coarse(const uint32_t firstChild, const uint8_t nchildren, const uint32_t to){
+	for (uint32_t i = 0; i < fields.size(); i++){
+		fields[i]->coarse(firstChild, nchildren, to);
+	}
+};
+
+inline void Class_Data_Fields::resize(uint32_t newSize){
+	for (uint32_t i = 0; i < fields.size(); i++){
+		fields[i]->resize(newSize);
+	}
+};
+
+inline void Class_Data_Fields::shrink(){
+	for (uint32_t i = 0; i < fields.size(); i++){
+		fields[i]->shrink();
+	}
+};
+
+/*! Size in bytes of the data of an octant: sum of the sizes of all the fields.
+ */
+inline size_t Class_Data_Fields::size(const uint32_t e) const{
+	return fixedSize();
+};
+
+inline size_t Class_Data_Fields::fixedSize() const{
+	size_t bytes = 0;
+	for (uint32_t i = 0; i < fields.size(); i++){
+		bytes += fields[i]->size();
+	}
+	return bytes;
+};
+
+inline void Class_Data_Fields::assign(uint32_t stride, uint32_t length){
+	for (uint32_t i = 0; i < fields.size(); i++){
+		fields[i]->assign(stride, length);
+	}
+};
+
+#if NOMPI==0
+inline void Class_Data_Fields::gather(Class_Comm_Buffer & buff, const uint32_t e){
+	for (uint32_t i = 0; i < fields.size(); i++){
+		fields[i]->gather(buff, e);
+	}
+};
+
+inline void Class_Data_Fields::scatter(Class_Comm_Buffer & buff, const uint32_t e){
+	for (uint32_t i = 0; i < fields.size(); i++){
+		fields[i]->scatter(buff, e);
+	}
+};
+#endif
+
+// =================================================================================== //
+// GHOST COMMUNICATION                                                                 //
+// =================================================================================== //
+
+inline Class_Data_Fields::Ghosts::Ghosts(Class_Data_Fields & fields_) : fields(fields_){};
+
+inline size_t Class_Data_Fields::Ghosts::size(const uint32_t e) const{
+	return fixedSize();
+};
+
+/*! Size in bytes of the ghost data of an octant: sum of the sizes of the fields with a ghost vector.
+ */
+inline size_t Class_Data_Fields::Ghosts::fixedSize() const{
+	size_t bytes = 0;
+	for (uint32_t i = 0; i < fields.fields.size(); i++){
+		if (fields.fields[i]->hasGhosts()){
+			bytes += fields.fields[i]->size();
+		}
+	}
+	return bytes;
+};
+
+#if NOMPI==0
+inline void Class_Data_Fields::Ghosts::gather(Class_Comm_Buffer & buff, const uint32_t e){
+	for (uint32_t i = 0; i < fields.fields.size(); i++){
+		if (fields.fields[i]->hasGhosts()){
+			fields.fields[i]->gather(buff, e);
+		}
+	}
+};
+
+inline void Class_Data_Fields::Ghosts::scatter(Class_Comm_Buffer & buff, const uint32_t e){
+	for (uint32_t i = 0; i < fields.fields.size(); i++){
+		if (fields.fields[i]->hasGhosts()){
+			fields.fields[i]->scatterGhost(buff, e);
+		}
+	}
+};
+#endif
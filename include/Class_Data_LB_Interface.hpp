@@ -4,6 +4,7 @@
 #define CLASS_DATA_LB_INTERFACE_HPP_
 
 #include <stdint.h>
+#include <type_traits>
 
 template <class Impl>
 class Class_Data_LB_Interface {
@@ -31,6 +32,12 @@ private:
 	const Impl& getImpl() const;
 };
 
+/*! True if Impl is load balance user data (derived from Class_Data_LB_Interface<Impl>),
+ * i.e. the data of its elements can be packed in communication buffers.
+ */
+template <class Impl>
+struct Class_Data_Is_LB : std::is_base_of<Class_Data_LB_Interface<Impl>, Impl> {};
+
 #include "Class_Data_LB_Interface.tpp"
 
 #endif /* CLASS_DATA_LB_INTERFACE_HPP_ */
@@ -0,0 +1,107 @@
+#ifndef CLASS_DATA_PAIR_HPP_
+#define CLASS_DATA_PAIR_HPP_
+
+// =================================================================================== //
+// INCLUDES                                                                            //
+// =================================================================================== //
+#include "Class_Data_Adapt_Interface.hpp"
+#include "Class_Data_LB_Interface.hpp"
+#include <stdint.h>
+#include <type_traits>
+
+// =================================================================================== //
+// CLASS DEFINITION                                                                    //
+// =================================================================================== //
+
+/*!
+ *	\brief Pair of user data projected by the same adapt and migrated by the same load balance
+ *
+ *	Every call is forwarded to the first and then to the second user data, so the data of
+ *	an octant are packed in the same message: first data followed by second data.
+ *	The methods are instantiated only when used, the adapt methods require two adapt user
+ *	data and the load balance methods require two load balance user data.
+ */
+template<class Impl1, class Impl2>
+class Class_Data_Pair : public Class_Data_Adapt_Interface<Class_Data_Pair<Impl1,Impl2> >,
+						public Class_Data_LB_Interface<Class_Data_Pair<Impl1,Impl2> > {
+
+	// ------------------------------------------------------------------------------- //
+	// MEMBERS ----------------------------------------------------------------------- //
+	Impl1 & first;			/**< First user data */
+	Impl2 & second;			/**< Second user data */
+
+	// ------------------------------------------------------------------------------- //
+	// CONSTRUCTORS ------------------------------------------------------------------ //
+public:
+	Class_Data_Pair(Impl1 & first_, Impl2 & second_) : first(first_), second(second_){};
+
+	// ------------------------------------------------------------------------------- //
+	// METHODS ----------------------------------------------------------------------- //
+public:
+	//adapt
+	void move(const uint32_t from, const uint32_t to){
+		first.move(from, to);
+		second.move(from, to);
+	};
+
+	void refine(const uint32_t father, const uint32_t firstChild, const uint8_t nchildren){
+		first.refine(father, firstChild, nchildren);
+		second.refine(father, firstChild, nchildren);
+	};
+
+	void coarse(const uint32_t firstChild, const uint8_t nchildren, const uint32_t to){
+		first.coarse(firstChild, nchildren, to);
+		second.coarse(firstChild, nchildren, to);
+	};
+
+	void resize(uint32_t newSize){
+		first.resize(newSize);
+		second.resize(newSize);
+	};
+
+	void shrink(){
+		first.shrink();
+		second.shrink();
+	};
+
+	//load balance
+	size_t size(const uint32_t e) const{
+		return first.size(e) + second.size(e);
+	};
+
+	/*! Fixed size of the pair, 0 (variable size) if one of the data has variable size.
+	 */
+	size_t fixedSize() const{
+		size_t firstSize = first.fixedSize();
+		size_t secondSize = second.fixedSize();
+		if (firstSize == 0 || secondSize == 0){
+			return 0;
+		}
+		return firstSize + secondSize;
+	};
+
+	void assign(uint32_t stride, uint32_t length){
+		first.assign(stride, length);
+		second.assign(stride, length);
+	};
+
+	template<class Buffer>
+	void gather(Buffer & buff, const uint32_t e){
+		first.gather(buff, e);
+		second.gather(buff, e);
+	};
+
+	template<class Buffer>
+	void scatter(Buffer & buff, const uint32_t e){
+		first.scatter(buff, e);
+		second.scatter(buff, e);
+	};
+};
+
+/*! A pair is load balance user data only if both its user data are.
+ */
+template<class Impl1, class Impl2>
+struct Class_Data_Is_LB<Class_Data_Pair<Impl1,Impl2> >
+	: std::integral_constant<bool, Class_Data_Is_LB<Impl1>::value && Class_Data_Is_LB<Impl2>::value> {};
+
+#endif /* CLASS_DATA_PAIR_HPP_ */
@@ -31,7 +31,7 @@ public:
 		nfaces(4),
 		nnodes(4),
 		nnodesperface(2),
-		octantBytes(uint8_t(sizeof(uint32_t)*2 + sizeof(uint8_t) + sizeof(int8_t) + (12)*sizeof(bool))),
+		octantBytes(uint8_t(sizeof(uint32_t)*2 + sizeof(uint16_t) + sizeof(uint8_t) + sizeof(int8_t))),
 		globalIndexBytes(uint8_t(sizeof(uint64_t))),
 		markerBytes(sizeof(int8_t)),
 		levelBytes(sizeof(uint8_t)),
@@ -80,7 +80,7 @@ public:
 	uint8_t  nfaces;				/**< Number of faces of an octant */
 	uint8_t  nnodes;				/**< Number of nodes of an octant */
 	uint8_t  nnodesperface;			/**< Number of nodes per face of an octant */
-	uint8_t  octantBytes;			/**< Bytes occupation of an octant */
+	uint8_t  octantBytes;			/**< Bytes occupation of an octant in the communications (size of Class_Octant<2>::Wire) */
 	uint8_t  globalIndexBytes;		/**< Bytes occupation of the index of an octant */
 	uint8_t  markerBytes;			/**< Bytes occupation of the refinement marker of an octant */
 	uint8_t  levelBytes;			/**< Bytes occupation of the level of an octant */
@@ -30,7 +30,7 @@ public:
 	nnodes(8),
 	nedges(12),
 	nnodesperface(4),
-	octantBytes(uint8_t(sizeof(uint32_t)*3 + sizeof(uint8_t) + sizeof(int8_t) + (16)*sizeof(bool))),
+	octantBytes(uint8_t(sizeof(uint32_t)*3 + sizeof(uint16_t) + sizeof(uint8_t) + sizeof(int8_t))),
 	globalIndexBytes(uint8_t(sizeof(uint64_t))),
 	markerBytes(sizeof(int8_t)),
 	levelBytes(sizeof(uint8_t)),
@@ -182,7 +182,7 @@ public:
 	uint8_t  nedges;			/**< Number of edges of an octant */
 	uint8_t  nnodes;			/**< Number of nodes of an octant */
 	uint8_t  nnodesperface;		/**< Number of nodes per face of an octant */
-	uint8_t  octantBytes;		/**< Bytes occupation of an octant */
+	uint8_t  octantBytes;		/**< Bytes occupation of an octant in the communications (size of Class_Octant<3>::Wire) */
 	uint8_t  globalIndexBytes;	/**< Bytes occupation of the index of an octant */
 	uint8_t  markerBytes;		/**< Bytes occupation of the refinement marker of an octant */
 	uint8_t  levelBytes;		/**< Bytes occupation of the level of an octant */
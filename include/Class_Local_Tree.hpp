@@ -9,6 +9,9 @@
 #include "Class_Global.hpp"
 #include "Class_Octant.hpp"
 #include "Class_Intersection.hpp"
+#include "Class_Data_Adapt_Interface.hpp"
+#include "Class_Data_Adapt_None.hpp"
+#include "Class_Data_Adapt_Mapper.hpp"
 #include <math.h>
 #include <stdint.h>
 #include <vector>
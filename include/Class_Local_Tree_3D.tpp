@@ -143,10 +143,12 @@ private:
 	};
 
 	void setFirstDesc(){
+		if (octants.empty()) return;
 		OctantsType::const_iterator firstOctant = octants.begin();
 		first_desc = Class_Octant<3>(MAX_LEVEL_3D,firstOctant->x,firstOctant->y,firstOctant->z);
 	};
 	void setLastDesc(){
+		if (octants.empty()) return;
 		OctantsType::const_iterator lastOctant = octants.end() - 1;
 		uint32_t x,y,z,delta;
 		delta = (uint32_t)pow(2.0,(double)((uint8_t)MAX_LEVEL_3D - lastOctant->level)) - 1;
@@ -179,271 +181,38 @@ private:
 	// =================================================================================== //
 
 	bool refine(){									// Refine local tree: refine one time octants with marker >0
-
-		// Local variables
-		vector<uint32_t> last_child_index;
-		vector< Class_Octant<3> > children;
-		uint32_t idx, nocts, ilastch;
-		uint32_t offset = 0, blockidx;
-		uint8_t nchm1 = global3D.nchildren-1, ich;
-		bool dorefine = false;
-
-		nocts = octants.size();
-		for (idx=0; idx<nocts; idx++){
-			if(octants[idx].getMarker() > 0 && octants[idx].getLevel() < MAX_LEVEL_3D){
-				last_child_index.push_back(idx+nchm1+offset);
-				offset += nchm1;
-			}
-			else{
-				//			octants[idx].info[12] = false;
-				if (octants[idx].marker > 0)
-					octants[idx].marker = 0;
-				octants[idx].info[15] = true;
-			}
-		}
-		if (offset > 0){
-			octants.resize(octants.size()+offset);
-			blockidx = last_child_index[0]-nchm1;
-			idx = octants.size();
-			ilastch = last_child_index.size()-1;
-			while (idx>blockidx){
-				idx--;
-				if(idx == last_child_index[ilastch]){
-					//				if(octants[idx-offset].getMarker() > 0 && octants[idx-offset].getLevel() < MAX_LEVEL_3D){
-					children = octants[idx-offset].buildChildren();
-					for (ich=0; ich<global3D.nchildren; ich++){
-						octants[idx-ich] = (children[nchm1-ich]);
-					}
-					offset -= nchm1;
-					idx -= nchm1;
-					//Update local max depth
-					if (children[0].getLevel() > local_max_depth){
-						local_max_depth = children[0].getLevel();
-					}
-					if (children[0].getMarker() > 0){
-						//More Refinement to do
-						dorefine = true;
-					}
-					//delete []children;
-					if (ilastch != 0){
-						ilastch--;
-					}
-				}
-				else {
-					octants[idx] = octants[idx-offset];
-				}
-			}
-		}
-		octants.shrink_to_fit();
-		nocts = octants.size();
-
-		setFirstDesc();
-		setLastDesc();
-
-		return dorefine;
-
+		Class_Data_Adapt_None noData;
+		return refine(noData);
 	};
 
 	// =================================================================================== //
 
 	bool coarse(){												// Coarse local tree: coarse one time family of octants with marker <0
-		// Local variables										// (if at least one octant of family has marker>=0 set marker=0 for the entire family)
-		vector<uint32_t> first_child_index;
-		Class_Octant<3> father;
-		uint32_t nocts;
-		uint32_t idx, idx2;
-		uint32_t offset;
-		uint32_t idx2_gh;
-		uint32_t nidx;
-		int8_t markerfather, marker;
-		uint8_t nbro, nend;
-		uint8_t nchm1 = global3D.nchildren-1;
-		bool docoarse = false;
-		bool wstop = false;
-
-		//------------------------------------------ //
-		// Initialization
-
-		nbro = nend = 0;
-		nidx = offset = 0;
-
-		idx2_gh = 0;
-
-		nocts   = octants.size();
-		size_ghosts = ghosts.size();
-
-		first_child_index.clear();
-
-		// Init first and last desc (even if already calculated)
-		setFirstDesc();
-		setLastDesc();
-
-		//------------------------------------------ //
-
-		// Set index for start and end check for ghosts
-		if (ghosts.size()){
-			while(idx2_gh < size_ghosts && ghosts[idx2_gh].computeMorton() <= last_desc.computeMorton()){
-				idx2_gh++;
-			}
-			idx2_gh = min((size_ghosts-1), idx2_gh);
-		}
-
-		// Check and coarse internal octants
-		for (idx=0; idx<nocts; idx++){
-			if(octants[idx].getMarker() < 0 && octants[idx].getLevel() > 0){
-				nbro = 0;
-				father = octants[idx].buildFather();
-				// Check if family is to be refined
-				for (idx2=idx; idx2<idx+global3D.nchildren; idx2++){
-					if (idx2<nocts){
-						if(octants[idx2].getMarker() < 0 && octants[idx2].buildFather() == father){
-							nbro++;
-						}
-					}
-				}
-				if (nbro == global3D.nchildren){
-					nidx++;
-					first_child_index.push_back(idx);
-					idx = idx2-1;
-				}
-				else{
-					if (idx < (nocts>global3D.nchildren)*(nocts-global3D.nchildren)){
-						octants[idx].setMarker(0);
-						octants[idx].info[15] = true;
-					}
-				}
-			}
-			//			else{
-			//	//			octants[idx].info[13] = false;
-			//			}
-		}
-		uint32_t nblock = nocts;
-		uint32_t nfchild = first_child_index.size();
-		if (nidx!=0){
-			nblock = nocts - nidx*nchm1;
-			nidx = 0;
-			for (idx=0; idx<nblock; idx++){
-				if (nidx < nfchild){
-					if (idx+offset == first_child_index[nidx]){
-						markerfather = -MAX_LEVEL_3D;
-						father = octants[idx+offset].buildFather();
-						for(idx2=0; idx2<global3D.nchildren; idx2++){
-							if (markerfather < octants[idx+offset+idx2].getMarker()+1){
-								markerfather = octants[idx+offset+idx2].getMarker()+1;
-							}
-							for (int iii=0; iii<16; iii++){
-								father.info[iii] = father.info[iii] || octants[idx+offset+idx2].info[iii];
-							}
-						}
-						father.info[13] = true;
-						if (markerfather < 0){
-							docoarse = true;
-						}
-						father.setMarker(markerfather);
-						octants[idx] = father;
-						offset += nchm1;
-						nidx++;
-					}
-					else{
-						octants[idx] = octants[idx+offset];
-					}
-				}
-				else{
-					octants[idx] = octants[idx+offset];
-				}
-			}
-		}
-		//		octants.resize(nocts-offset);
-		octants.resize(nblock);
-		octants.shrink_to_fit();
-		nocts = octants.size();
+		Class_Data_Adapt_None noData;
+		return coarse(noData);
+	};
 
-		// End on ghosts
-		if (ghosts.size() && nocts > 0){
-			if ((ghosts[idx2_gh].getMarker() < 0) && (octants[nocts-1].getMarker() < 0)){
-				father = ghosts[idx2_gh].buildFather();
-				for (uint32_t iii=0; iii<16; iii++){
-					father.info[iii] = false;
-				}
-				markerfather = ghosts[idx2_gh].getMarker()+1;
-				nbro = 0;
-				idx = idx2_gh;
-				marker = ghosts[idx].getMarker();
-				while(marker < 0 && ghosts[idx].buildFather() == father){
-					nbro++;
-					if (markerfather < ghosts[idx].getMarker()+1){
-						markerfather = ghosts[idx].getMarker()+1;
-					}
-					idx++;
-					if(idx == size_ghosts){
-						break;
-					}
-					marker = ghosts[idx].getMarker();
-					for (int iii=0; iii<16; iii++){
-						father.info[iii] = father.info[iii] || ghosts[idx].info[iii];
-					}
-				}
-				nend = 0;
-				idx = nocts-1;
-				marker = octants[idx].getMarker();
-				while(marker < 0 && octants[idx].buildFather() == father && idx >= 0){
-					nbro++;
-					nend++;
-					if (markerfather < octants[idx].getMarker()+1){
-						markerfather = octants[idx].getMarker()+1;
-					}
-					idx--;
-					marker = octants[idx].getMarker();
-					if (wstop){
-						break;
-					}
-					if (idx==0){
-						wstop = true;
-					}
-				}
-				if (nbro == global3D.nchildren){
-					offset = nend;
-				}
-				else{
-					nend = 0;
-					for(uint32_t ii=nocts-global3D.nchildren; ii<nocts; ii++){
-						octants[ii].setMarker(0);
-						octants[ii].info[15] = true;
-					}
-				}
-			}
-			if (nend != 0){
-				for (idx=0; idx < nend; idx++){
-					for (int iii=0; iii<16; iii++){
-						father.info[iii] = father.info[iii] || octants[nocts-idx-1].info[iii];
-					}
-				}
-				father.info[13] = true;
-				if (markerfather < 0){
-					docoarse = true;
-				}
-				father.setMarker(markerfather);
-				octants.resize(nocts-offset);
-				octants.push_back(father);
-				octants.shrink_to_fit();
-				nocts = octants.size();
-			}
+	// =================================================================================== //
 
-		}
+	bool refine(u32vector & mapidx){							// Refine local tree: refine one time octants with marker >0
+		// mapidx[i] = index in old octants vector of the i-th octant (index of father if octant is new after)
+		Class_Data_Adapt_Mapper mapper(mapidx);
+		return refine(mapper);
+	};
 
-		// Set final first and last desc
-		if(nocts>0){
-			setFirstDesc();
-			setLastDesc();
-		}
-		return docoarse;
+	// =================================================================================== //
 
+	bool coarse(u32vector & mapidx){							// Coarse local tree: coarse one time family of octants with marker <0
+		// mapidx[i] = index in old octants vector of the i-th octant (index of father if octant is new after)
+		Class_Data_Adapt_Mapper mapper(mapidx);
+		return coarse(mapper);
 	};
 
 	// =================================================================================== //
 
-	bool refine(u32vector & mapidx){							// Refine local tree: refine one time octants with marker >0
-		// mapidx[i] = index in old octants vector of the i-th octant (index of father if octant is new after)
+	template<class Impl>
+	bool refine(Class_Data_Adapt_Interface<Impl> & userData){							// Refine local tree: refine one time octants with marker >0
+		// userData is moved/prolongated on the new octants in the same pass
 		// Local variables
 		vector<uint32_t> last_child_index;
 		vector< Class_Octant<3> > children;
@@ -462,13 +231,12 @@ private:
 				//			octants[idx].info[12] = false;
 				if (octants[idx].marker > 0){
 					octants[idx].marker = 0;
-					octants[idx].info[15] = false;
+					octants[idx].info[15] = true;
 				}
 			}
 		}
 		if (offset > 0){
-			mapidx.resize(octants.size()+offset);
-			mapidx.shrink_to_fit();
+			userData.resize(octants.size()+offset);
 
 			octants.resize(octants.size()+offset);
 			blockidx = last_child_index[0]-nchm1;
@@ -480,9 +248,9 @@ private:
 				//				if(octants[idx-offset].getMarker() > 0 && octants[idx-offset].getLevel() < MAX_LEVEL_3D){
 				if(idx == last_child_index[ilastch]){
 					children = octants[idx-offset].buildChildren();
+					userData.refine(idx-offset, idx-nchm1, global3D.nchildren);
 					for (ich=0; ich<global3D.nchildren; ich++){
 						octants[idx-ich] = (children[nchm1-ich]);
-						mapidx[idx-ich]  = mapidx[idx-offset];
 					}
 					offset -= nchm1;
 					idx -= nchm1;
@@ -501,7 +269,7 @@ private:
 				}
 				else {
 					octants[idx] = octants[idx-offset];
-					mapidx[idx]  = mapidx[idx-offset];
+					userData.move(idx-offset, idx);
 				}
 			}
 		}
@@ -517,9 +285,11 @@ private:
 
 	// =================================================================================== //
 
-	bool coarse(u32vector & mapidx){							// Coarse local tree: coarse one time family of octants with marker <0
-		// (if at least one octant of family has marker>=0 set marker=0 for the entire family)
-		// mapidx[i] = index in old octants vector of the i-th octant (index of father if octant is new after)
+	template<class Impl>
+	bool coarse(Class_Data_Adapt_Interface<Impl> & userData,		// Coarse local tree: coarse one time family of octants with marker <0
+			uint8_t nremote = 0){								// (if at least one octant of family has marker>=0 set marker=0 for the entire family)
+		// userData is moved/restricted on the new octants in the same pass
+		// nremote = number of children of the last family received from the next process, their data follow the local data
 		// Local variables
 		vector<uint32_t> first_child_index;
 		Class_Octant<3> father;
@@ -617,26 +387,30 @@ private:
 							docoarse = true;
 						}
 						octants[idx] = father;
-						mapidx[idx] = mapidx[idx+offset];
+						userData.coarse(idx+offset, global3D.nchildren, idx);
 						offset += nchm1;
 						nidx++;
 					}
 					else{
 						octants[idx] = octants[idx+offset];
-						mapidx[idx] = mapidx[idx+offset];
+						userData.move(idx+offset, idx);
 					}
 				}
 				else{
 					octants[idx] = octants[idx+offset];
-					mapidx[idx] = mapidx[idx+offset];
+					userData.move(idx+offset, idx);
 				}
 			}
 		}
 		octants.resize(nblock);
 		octants.shrink_to_fit();
 		nocts = octants.size();
-		mapidx.resize(nocts);
-		mapidx.shrink_to_fit();
+		if (nblock != nocts0){
+			for (idx=0; idx<nremote; idx++){
+				userData.move(nocts0+idx, nocts+idx);
+			}
+		}
+		userData.resize(nocts+nremote);
 
 		// End on ghosts
 		if (ghosts.size() && nocts > 0){
@@ -703,15 +477,19 @@ private:
 					docoarse = true;
 				}
 				father.setMarker(markerfather);
+				// The restriction involves the remote children only if they complete the family
+				if (nend+nremote != global3D.nchildren){
+					nremote = 0;
+				}
+				userData.coarse(nocts-offset, nend+nremote, nocts-offset);
 				octants.resize(nocts-offset);
 				octants.push_back(father);
 				octants.shrink_to_fit();
 				nocts = octants.size();
-				mapidx.resize(nocts);
-				mapidx.shrink_to_fit();
 			}
 
 		}
+		userData.resize(nocts);
 
 		// Set final first and last desc
 		if(nocts>0){
@@ -1278,32 +1056,49 @@ private:
 
 	// =================================================================================== //
 
-	void checkCoarse(uint64_t lastDescPre,						// Delete overlapping octants after coarse local tree. Check first and last descendants
-			uint64_t firstDescPost){		// of process before and after the local process
-		uint32_t idx;
-		uint32_t nocts;
-		uint64_t Morton;
-		uint8_t toDelete = 0;
+	// Uniform octree of a given level: octants with Morton index (at that level) in [first, first+nocts).
+	// The octants are marked as new from refinement (as after a global refine) and get the 2:1 balance flag
+	void setUniform(uint8_t level, uint64_t first, uint32_t nocts, bool balance = true){
+		uint32_t idx, i, j, k, x, y, z;
+		uint8_t shift = MAX_LEVEL_3D - level;
+		uint32_t lastc = global3D.max_length - (uint32_t(1) << shift);
 
-		nocts = getNumOctants();
-		idx = 0;
-		Morton = octants[idx].computeMorton();
-		while(Morton <= lastDescPre && idx < nocts && Morton != 0){
-			// To delete, the father is in proc before me
-			toDelete++;
-			idx++;
-			Morton = octants[idx].computeMorton();
+		octants.clear();
+		octants.resize(nocts);
+		octants.shrink_to_fit();
+		for (idx=0; idx<nocts; idx++){
+			mortonDecode_magicbits(first+idx,i,j,k);
+			x = i << shift;
+			y = j << shift;
+			z = k << shift;
+			Class_Octant<3> oct(level, x, y, z);
+			if (x == 0) oct.setBound(0);
+			if (x == lastc) oct.setBound(1);
+			if (y == 0) oct.setBound(2);
+			if (y == lastc) oct.setBound(3);
+			if (z == 0) oct.setBound(4);
+			if (z == lastc) oct.setBound(5);
+			if (level > 0) oct.info[12] = true;
+			if (!balance) oct.setBalance(true);
+			octants[idx] = oct;
 		}
-		for(idx=0; idx<nocts-toDelete; idx++){
-			octants[idx] = octants[idx+toDelete];
+		ghosts.clear();
+		ghosts.shrink_to_fit();
+		globalidx_ghosts.clear();
+		size_ghosts = 0;
+		local_max_depth = level;
+		if (nocts>0){
+			setFirstDesc();
+			setLastDesc();
 		}
-		octants.resize(nocts-toDelete);
-		octants.shrink_to_fit();
-		nocts = getNumOctants();
+	};
 
-		setFirstDesc();
-		setLastDesc();
+	// =================================================================================== //
 
+	void checkCoarse(uint64_t lastDescPre,						// Delete overlapping octants after coarse local tree. Check first and last descendants
+			uint64_t firstDescPost){		// of process before and after the local process
+		Class_Data_Adapt_None noData;
+		checkCoarse(lastDescPre, firstDescPost, noData);
 	};
 
 	// =================================================================================== //
@@ -1311,6 +1106,16 @@ private:
 	void checkCoarse(uint64_t lastDescPre,						// Delete overlapping octants after coarse local tree. Check first and last descendants
 			uint64_t firstDescPost,
 			u32vector & mapidx){					// of process before and after the local process
+		Class_Data_Adapt_Mapper mapper(mapidx);
+		checkCoarse(lastDescPre, firstDescPost, mapper);
+	};
+
+	// =================================================================================== //
+
+	template<class Impl>
+	void checkCoarse(uint64_t lastDescPre,						// Delete overlapping octants after coarse local tree. Check first and last descendants
+			uint64_t firstDescPost,
+			Class_Data_Adapt_Interface<Impl> & userData){					// of process before and after the local process
 		uint32_t idx;
 		uint32_t nocts;
 		uint64_t Morton;
@@ -1327,12 +1132,11 @@ private:
 		}
 		for(idx=0; idx<nocts-toDelete; idx++){
 			octants[idx] = octants[idx+toDelete];
-			mapidx[idx] = mapidx[idx+toDelete];
+			userData.move(idx+toDelete, idx);
 		}
 		octants.resize(nocts-toDelete);
 		octants.shrink_to_fit();
-		mapidx.resize(nocts-toDelete);
-		mapidx.shrink_to_fit();
+		userData.resize(nocts-toDelete);
 		nocts = getNumOctants();
 
 		setFirstDesc();
@@ -1342,6 +1146,40 @@ private:
 
 	// =================================================================================== //
 
+	uint8_t countCoarseFamilyHead(uint64_t firstDescPre){		// Number of first octants completing a family to be coarsened by the process before
+		// firstDescPre = first descendant of the process before, the first child of the family must be there
+		uint32_t idx, nocts = octants.size();
+		uint8_t nhead = 0, nbro = 0;
+
+		if (nocts == 0 || ghosts.size() == 0 || octants[0].getMarker() >= 0 || octants[0].getLevel() == 0){
+			return 0;
+		}
+		Class_Octant<3> father = octants[0].buildFather();
+		uint64_t fatherMorton = father.computeMorton();
+		if (fatherMorton == octants[0].computeMorton() || fatherMorton < firstDescPre
+				|| father.buildLastDesc().computeMorton() > last_desc.computeMorton()){
+			return 0;
+		}
+		while (nhead < nocts && octants[nhead].getMarker() < 0 && octants[nhead].buildFather() == father){
+			nhead++;
+		}
+		// The other children are the ghosts before the first octant
+		idx = 0;
+		while (idx < ghosts.size() && ghosts[idx].computeMorton() < fatherMorton){
+			idx++;
+		}
+		while (idx < ghosts.size() && ghosts[idx].getMarker() < 0 && ghosts[idx].buildFather() == father){
+			nbro++;
+			idx++;
+		}
+		if (nhead+nbro != global3D.nchildren){
+			return 0;
+		}
+		return nhead;
+	};
+
+	// =================================================================================== //
+
 	void updateLocalMaxDepth(){						// Update max depth reached in local tree
 		uint32_t noctants = getNumOctants();
 		uint32_t i;
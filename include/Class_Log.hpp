@@ -33,6 +33,9 @@ public:
 	~Class_Log();
 
 	void writeLog(string msg);
+#if NOMPI==0
+	void setComm(MPI_Comm comm_);
+#endif
 
 };
 
@@ -60,6 +60,18 @@ private:
 								-Info[10]   : true if balancing is not required for this octant \n
 								-Info[11]   : Aux (before : true if octant is a scary ghost) */
 
+public:
+	/*! Communication image of an octant: fixed size and trivially copyable, so that
+	 * the communication buffers are filled by memcpy and sent as raw bytes.
+	 */
+	struct Wire{
+		uint32_t	x;				/**< Coordinate x */
+		uint32_t	y;				/**< Coordinate y */
+		uint16_t	info;			/**< Info bits */
+		uint8_t		level;			/**< Refinement level */
+		int8_t		marker;			/**< Refinement marker */
+	};
+
 	// ------------------------------------------------------------------------------- //
 	// CONSTRUCTORS AND OPERATORS----------------------------------------------------- //
 
@@ -91,6 +103,13 @@ public:
 		marker = octant.marker;
 		info = octant.info;
 	};
+	Class_Octant(const Wire &wire){
+		x = wire.x;
+		y = wire.y;
+		level = wire.level;
+		marker = wire.marker;
+		info = bitset<12>((unsigned long)wire.info);
+	};
 
 	/*! Check if two octants are equal (no check on info)
 	 */
@@ -364,6 +383,21 @@ public:
 		return morton;
 	};
 
+	// ------------------------------------------------------------------------------- //
+
+	/** Build the communication image of the octant.
+	 * \return wire Fixed size image of the octant to be copied in a communication buffer.
+	 */
+	Wire	getWire() const{
+		Wire wire;
+		wire.x = x;
+		wire.y = y;
+		wire.info = uint16_t(info.to_ulong());
+		wire.level = level;
+		wire.marker = marker;
+		return wire;
+	};
+
 	//-------------------------------------------------------------------------------- //
 	// Other methods ----------------------------------------------------------------- //
 
@@ -60,6 +60,19 @@ private:
 								-Info[15]   : Aux (before : true if octant is a scary ghost) */
 
 
+public:
+	/*! Communication image of an octant: fixed size and trivially copyable, so that
+	 * the communication buffers are filled by memcpy and sent as raw bytes.
+	 */
+	struct Wire{
+		uint32_t	x;				/**< Coordinate x */
+		uint32_t	y;				/**< Coordinate y */
+		uint32_t	z;				/**< Coordinate z */
+		uint16_t	info;			/**< Info bits */
+		uint8_t		level;			/**< Refinement level */
+		int8_t		marker;			/**< Refinement marker */
+	};
+
 	// ------------------------------------------------------------------------------- //
 	// CONSTRUCTORS AND OPERATORS----------------------------------------------------- //
 
@@ -94,6 +107,14 @@ public:
 		marker = octant.marker;
 		info = octant.info;
 	};
+	Class_Octant(const Wire &wire){
+		x = wire.x;
+		y = wire.y;
+		z = wire.z;
+		level = wire.level;
+		marker = wire.marker;
+		info = bitset<16>((unsigned long)wire.info);
+	};
 
 	/*! Check if two octants are equal (no check on info)
 	 */
@@ -395,6 +416,22 @@ public:
 		return morton;
 	};
 
+	// ------------------------------------------------------------------------------- //
+
+	/** Build the communication image of the octant.
+	 * \return wire Fixed size image of the octant to be copied in a communication buffer.
+	 */
+	Wire	getWire() const{
+		Wire wire;
+		wire.x = x;
+		wire.y = y;
+		wire.z = z;
+		wire.info = uint16_t(info.to_ulong());
+		wire.level = level;
+		wire.marker = marker;
+		return wire;
+	};
+
 	// =================================================================================== //
 	// Other methods													    			   //
 	// =================================================================================== //
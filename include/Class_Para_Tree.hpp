@@ -11,10 +11,17 @@
 #include "Class_Octant.hpp"
 #include "Class_Local_Tree.hpp"
 #include "Class_Comm_Buffer.hpp"
+#include "Class_Comm_Plan.hpp"
 #include "Class_Map.hpp"
 #include "Class_Array.hpp"
 #include "Class_Data_Comm_Interface.hpp"
 #include "Class_Data_LB_Interface.hpp"
+#include "Class_Data_Adapt_Interface.hpp"
+#include "Class_Data_Fields.hpp"
+#include "Class_Data_Pair.hpp"
+#include "Class_Adapt_Changes.hpp"
+#include "Class_Data_Adapt_Recorder.hpp"
+#include "Class_Partition_Stats.hpp"
 #include "Class_Log.hpp"
 #include <cstdint>
 #include <iterator>
@@ -22,9 +29,12 @@
 #include <algorithm>
 #include <string>
 #include <functional>
+#include <memory>
+#include <type_traits>
 #include <cctype>
 #include <fstream>
 #include <iomanip>
+#include <chrono>
 #include "utils.hpp"
 
 
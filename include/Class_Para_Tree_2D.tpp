@@ -57,6 +57,7 @@ public:
 	//auxiliary members
 	int error_flag;								/**<MPI error flag*/
 	bool serial;								/**<True if the octree is the same on each processor, False if the octree is distributed*/
+	bool keep_serial;							/**<True if the octree has to stay the same on each processor until loadBalance is called (default false)*/
 
 	//map member
 	Class_Map<2> trans;							/**<Transformation map from logical to physical domain*/
@@ -68,6 +69,59 @@ public:
 	MPI_Comm comm;								/**<MPI communicator*/
 #endif
 
+#if NOMPI==0
+private:
+	//incremental ghost layer members
+	map<int,vector<Class_Octant<2> > > savedBorders;	/**<Border octants per process at the last ghost layer update*/
+	map<int,vector<uint32_t> > savedBordersPerProc;		/**<Local indices of border octants per process at the last ghost layer update*/
+	map<int,uint32_t> ghostsPerProc;					/**<Number of ghost octants received from each process*/
+	vector<uint64_t> savedFirstDesc;					/**<Partition first descendants at the last ghost layer update*/
+	vector<uint64_t> savedLastDesc;						/**<Partition last descendants at the last ghost layer update*/
+	uint64_t savedGlobalOffset;							/**<Global index of the first local octant at the last ghost layer update*/
+	uint8_t savedMaxDepth;								/**<Max depth at the last ghost layer update*/
+
+	//neighborhood communication members
+	shared_ptr<MPI_Comm> neighborComm;					/**<Distributed graph communicator of the neighbor processes (keys of bordersPerProc), shared by the copies of the tree*/
+	vector<int> neighborProcs;							/**<Neighbor processes of the graph communicator, sources and destinations in increasing rank order*/
+
+	//communication plan members
+	uint64_t ghostsStamp;								/**<Number of ghost layer updates, identifies the ghost layer of a communication plan*/
+	Class_Comm_Plan commPlan;							/**<Communication plan of communicate(userData)*/
+	Class_Comm_Plan typedCommPlan;						/**<Communication plan of communicate(data,ghostData)*/
+	Class_Comm_Plan fieldsCommPlan;						/**<Communication plan of communicate(fields)*/
+	vector<Class_Comm_Buffer> bufferPool;				/**<Released communication buffers, reused by the next exchanges*/
+	uint64_t bufferPoolBytes;							/**<Capacity in bytes of the buffers in the pool*/
+	uint64_t bufferPoolLimit;							/**<Maximum capacity in bytes of the buffers kept in the pool*/
+
+	//global refinement members
+	bool distributeUniform;								/**<True if the global refinement of a replicated uniform octree generates directly the partition of each process*/
+
+	//load balance members
+	uint64_t migratedOctants;							/**<Number of local octants sent to other processes by the last load balance*/
+	uint64_t migratedBytes;								/**<Number of bytes sent to other processes by the last load balance*/
+
+	//node-aware partition members
+	bool nodeAware;										/**<True if loadBalance splits the octants over the compute nodes and then over the processes of every node*/
+	uint8_t nodeLevel;									/**<Number of levels of the families kept on the same node by the node-aware partition*/
+	vector<int> nodeOfRank;								/**<Compute node of every process, numbered by their first process (empty until the nodes are found)*/
+
+	//active processes members
+	MPI_Comm fullComm;									/**<Communicator given to the constructor, comm holds its first nofActive processes*/
+	shared_ptr<MPI_Comm> activeComm;					/**<Communicator of the active processes if they are not all the processes of fullComm, shared by the copies of the tree*/
+	int fullRank;										/**<Rank of the local process in fullComm (the same in comm if the process is active)*/
+	int fullNproc;										/**<Number of processes of fullComm*/
+	int nofActive;										/**<Number of active processes, the first ones of fullComm*/
+	uint32_t shrinkThreshold;							/**<Minimum mean number of octants per active process (0 if all the processes are always active)*/
+#endif
+
+private:
+	//cost tracking members
+	bool costTracking;									/**<True if the computational cost of the octants is measured and used by loadBalance*/
+	double costSmoothing;								/**<Smoothing factor of the exponential moving average of the octant costs*/
+	dvector octantCost;									/**<Smoothed computational cost of every local octant*/
+	dvector costSample;									/**<Cost measured on every local octant in the current step (negative if not measured)*/
+	chrono::steady_clock::time_point costTimer;			/**<Start time of the octant timer*/
+
 	// ------------------------------------------------------------------------------- //
 	// CONSTRUCTORS ------------------------------------------------------------------ //
 public:
@@ -76,17 +130,23 @@ public:
 	 * and side of length 1
 	 * \param[in] logfile The file name for the log of this object. PABLO.log is the default value*/
 #if NOMPI==0
-	Class_Para_Tree(string logfile="PABLO.log", MPI_Comm comm_ = MPI_COMM_WORLD) : log(logfile,comm_),comm(comm_){
+	Class_Para_Tree(string logfile="PABLO.log", MPI_Comm comm_ = MPI_COMM_WORLD) : log(logfile,comm_),comm(comm_),ghostsStamp(0),bufferPoolBytes(0),bufferPoolLimit(16777216),distributeUniform(false),migratedOctants(0),migratedBytes(0),nodeAware(false),nodeLevel(0),fullComm(comm_),nofActive(0),shrinkThreshold(0){
 #else
 	Class_Para_Tree(string logfile="PABLO.log") : log(logfile){
 #endif
 		serial = true;
+		keep_serial = false;
+		costTracking = false;
+		costSmoothing = 0.5;
 		error_flag = 0;
 		max_depth = 0;
 		global_num_octants = octree.getNumOctants();
 #if NOMPI==0
 		error_flag = MPI_Comm_size(comm,&nproc);
 		error_flag = MPI_Comm_rank(comm,&rank);
+		fullRank = rank;
+		fullNproc = nproc;
+		nofActive = nproc;
 #else
 		rank = 0;
 		nproc = 1;
@@ -134,17 +194,23 @@ public:
 	 * \param[in] logfile The file name for the log of this object. PABLO.log is the default value
 	 */
 #if NOMPI==0
-	Class_Para_Tree(double X, double Y, double Z, double L,string logfile="PABLO.log", MPI_Comm comm_ = MPI_COMM_WORLD):trans(X,Y,Z,L),log(logfile,comm_),comm(comm_){
+	Class_Para_Tree(double X, double Y, double Z, double L,string logfile="PABLO.log", MPI_Comm comm_ = MPI_COMM_WORLD):trans(X,Y,Z,L),log(logfile,comm_),comm(comm_),ghostsStamp(0),bufferPoolBytes(0),bufferPoolLimit(16777216),distributeUniform(false),migratedOctants(0),migratedBytes(0),nodeAware(false),nodeLevel(0),fullComm(comm_),nofActive(0),shrinkThreshold(0){
 #else
 	Class_Para_Tree(double X, double Y, double Z, double L,string logfile="PABLO.log"):trans(X,Y,Z,L),log(logfile){
 #endif
 		serial = true;
+		keep_serial = false;
+		costTracking = false;
+		costSmoothing = 0.5;
 		error_flag = 0;
 		max_depth = 0;
 		global_num_octants = octree.getNumOctants();
 #if NOMPI==0
 		error_flag = MPI_Comm_size(comm,&nproc);
 		error_flag = MPI_Comm_rank(comm,&rank);
+		fullRank = rank;
+		fullNproc = nproc;
+		nofActive = nproc;
 #else
 		rank = 0;
 		nproc = 1;
@@ -198,13 +264,16 @@ public:
 	 * \param[in] logfile The file name for the log of this object. PABLO.log is the default value
 	 */
 #if NOMPI==0
-	Class_Para_Tree(double X, double Y, double Z, double L, ivector2D & XY, ivector & levels,string logfile="PABLO.log", MPI_Comm comm_ = MPI_COMM_WORLD):trans(X,Y,Z,L),log(logfile,comm_),comm(comm_){
+	Class_Para_Tree(double X, double Y, double Z, double L, ivector2D & XY, ivector & levels,string logfile="PABLO.log", MPI_Comm comm_ = MPI_COMM_WORLD):trans(X,Y,Z,L),log(logfile,comm_),comm(comm_),ghostsStamp(0),bufferPoolBytes(0),bufferPoolLimit(16777216),distributeUniform(false),migratedOctants(0),migratedBytes(0),nodeAware(false),nodeLevel(0),fullComm(comm_),nofActive(0),shrinkThreshold(0){
 #else
 	Class_Para_Tree(double X, double Y, double Z, double L, ivector2D & XY, ivector & levels,string logfile="PABLO.log"):trans(X,Y,Z,L),log(logfile){
 #endif
 		uint8_t lev, iface;
 		uint32_t x0, y0;
 		uint32_t NumOctants = XY.size();
+		keep_serial = false;
+		costTracking = false;
+		costSmoothing = 0.5;
 		octree.octants.resize(NumOctants);
 		for (uint32_t i=0; i<NumOctants; i++){
 			lev = uint8_t(levels[i]);
@@ -237,6 +306,9 @@ public:
 #if NOMPI==0
 		error_flag = MPI_Comm_size(comm,&nproc);
 		error_flag = MPI_Comm_rank(comm,&rank);
+		fullRank = rank;
+		fullNproc = nproc;
+		nofActive = nproc;
 		serial = true;
 		if (nproc > 1 ) serial = false;
 #else
@@ -1094,6 +1166,197 @@ public:
 		octree.setBalanceCodim(b21codim);
 	};
 
+	/*! Get if the octree is kept the same on each process until the first loadBalance.
+	 * \return True if the replicated (serial) mode is kept by the global refinements.
+	 */
+	bool getKeepSerial() const{
+		return keep_serial;
+	};
+
+	/*! Set if the octree has to be kept the same on each process until the first loadBalance.
+	 * By default a uniform octree is distributed over the processes already by adaptGlobalRefine.
+	 * \param[in] keep True to keep the replicated (serial) mode until loadBalance is called.
+	 */
+	void setKeepSerial(bool keep){
+		keep_serial = keep;
+	};
+
+#if NOMPI==0
+	/*! Get if loadBalance uses the node-aware partition.
+	 * \return True if the octants are split over the compute nodes and then over the processes of every node.
+	 */
+	bool getNodeAware() const{
+		return nodeAware;
+	};
+
+	/*! Set the node-aware (two-level) partition of loadBalance() and loadBalance(userData).
+	 * The load is split first over the compute nodes (processes sharing memory, found by MPI_Comm_split_type)
+	 * proportionally to their number of processes, and then evenly over the processes of every node,
+	 * so most of the ghost traffic stays inside the nodes. The node boundaries can keep together the
+	 * families of the last levels, independently of the boundaries between the processes of a node.
+	 * The processes of every node have to be consecutive ranks, otherwise the flat partition is used.
+	 * \param[in] aware True to use the node-aware partition.
+	 * \param[in] level Number of levels of the families kept on the same node (default 0, node boundaries not aligned).
+	 */
+	void setNodeAware(bool aware, uint8_t level = 0){
+		nodeAware = aware;
+		nodeLevel = level;
+	};
+
+	/*! Get the minimum mean number of octants per active process (see setShrinkThreshold).
+	 * \return Minimum mean number of octants per active process (0 if all the processes are always active).
+	 */
+	uint32_t getShrinkThreshold() const{
+		return shrinkThreshold;
+	};
+
+	/*! Set the minimum mean number of octants per active process. When the octants per process fall below
+	 * the threshold, loadBalance moves the octree on the first processes of the communicator, which get a
+	 * sub-communicator: the other processes are idle, they hold no octants and take no part in the communications.
+	 * When the octants per active process exceed four times the threshold the idle processes are activated again.
+	 * The active processes are chosen to hold about twice the threshold.
+	 * loadBalance() (and its versions with level, tolerance or user data) has to be called by all the processes
+	 * of the communicator of the tree; the other methods with communications (adapt, communicate, accumulate and write)
+	 * return immediately on the idle processes (see isActive).
+	 * \param[in] minOctants Minimum mean number of octants per active process (0 activates all the processes at the next loadBalance).
+	 */
+	void setShrinkThreshold(uint32_t minOctants){
+		shrinkThreshold = minOctants;
+	};
+
+	/*! Get if the local process is active, i.e. it holds a part of the octree and takes part in the communications.
+	 * \return False if the local process is idle after a shrink of the active processes (see setShrinkThreshold).
+	 */
+	bool isActive() const{
+		return fullRank < nofActive;
+	};
+
+	/*! Get the maximum memory kept by the pool of the communication buffers.
+	 * \return Maximum capacity in bytes of the released buffers kept for the next communications.
+	 */
+	uint64_t getBufferPoolLimit() const{
+		return bufferPoolLimit;
+	};
+
+	/*! Set the maximum memory kept by the pool of the communication buffers (16 MB by default).
+	 * The buffers released by the ghost communications are kept up to this capacity and reused by the
+	 * next communications; the buffers of the load balance are always freed.
+	 * \param[in] bytes Maximum capacity in bytes of the pooled buffers (0 disables the pool).
+	 */
+	void setBufferPoolLimit(uint64_t bytes){
+		bufferPoolLimit = bytes;
+		while(bufferPoolBytes > bufferPoolLimit){
+			bufferPoolBytes -= bufferPool.back().commBufferCapacity;
+			bufferPool.pop_back();
+		}
+	};
+
+	/*! Get if the global refinement of a replicated uniform octree is distributed (see setDistributeUniform).
+	 * \return True if adaptGlobalRefine distributes a replicated uniform octree.
+	 */
+	bool getDistributeUniform() const{
+		return distributeUniform;
+	};
+
+	/*! Set if adaptGlobalRefine distributes a replicated uniform octree (false by default).
+	 * If true, the global refinement of an octree uniform and the same on each process (not kept serial
+	 * by setKeepSerial) builds directly the balanced partition of each process (see buildUniform),
+	 * so the refined octree is distributed without a loadBalance. If false the octree is refined on each process
+	 * and stays serial until the next loadBalance.
+	 * \param[in] distribute True to distribute the global refinement of a replicated uniform octree.
+	 */
+	void setDistributeUniform(bool distribute){
+		distributeUniform = distribute;
+	};
+#endif
+
+	/*! Get the quality metrics of the partition: number of octants, weight, number of ghosts,
+	 * number of neighbor processes, bytes sent by one communicate and bytes sent to other compute nodes of the local process,
+	 * with their minimum, maximum, mean and imbalance (max/mean) over the processes.
+	 * All the metrics are reduced by a single collective call.
+	 * The weight is the measured cost of the octants if the cost tracking is enabled
+	 * (see enableCostTracking), otherwise the number of octants.
+	 * \param[in] bytesPerOctant Size in bytes of the data of one octant exchanged by communicate (default sizeof(double)).
+	 * \return Partition metrics.
+	 */
+	Class_Partition_Stats getPartitionStats(size_t bytesPerOctant = sizeof(double)){
+		double localWeight = double(getNumOctants());
+		if (costTracking){
+			updateOctantCost();
+			localWeight = 0.0;
+			for (uint32_t i = 0; i < octantCost.size(); i++){
+				localWeight += octantCost[i];
+			}
+		}
+		return computePartitionStats(localWeight, bytesPerOctant);
+	};
+
+	/*! Get the quality metrics of the partition with a computational cost for every octant
+	 * (see getPartitionStats()).
+	 * \param[in] weights Non negative weight of every local octant (same ordering of the octants).
+	 * \param[in] bytesPerOctant Size in bytes of the data of one octant exchanged by communicate (default sizeof(double)).
+	 * \return Partition metrics.
+	 */
+	Class_Partition_Stats getPartitionStats(const dvector & weights, size_t bytesPerOctant = sizeof(double)){
+		double localWeight = 0.0;
+		uint32_t nocts = getNumOctants();
+		for (uint32_t i = 0; i < nocts; i++){
+			localWeight += weights[i];
+		}
+		return computePartitionStats(localWeight, bytesPerOctant);
+	};
+
+private:
+	Class_Partition_Stats computePartitionStats(double localWeight, size_t bytesPerOctant){
+		//fill the local values of the metrics and reduce the triples (min, max, sum) in one Allreduce
+		//a serial tree is replicated, the local values are the global ones
+		const int nofMetrics = Class_Partition_Stats::nofMetrics;
+		uint64_t nofBorders = 0;
+		for (map<int,vector<uint32_t> >::iterator it = bordersPerProc.begin(); it != bordersPerProc.end(); ++it){
+			nofBorders += it->second.size();
+		}
+		double nodeBytes = 0.0;
+#if NOMPI==0
+		if (!serial){
+			findNodes();
+			for (map<int,vector<uint32_t> >::iterator it = bordersPerProc.begin(); it != bordersPerProc.end(); ++it){
+				if (nodeOfRank[it->first] != nodeOfRank[rank]){
+					nodeBytes += double(it->second.size()*bytesPerOctant);
+				}
+			}
+		}
+#endif
+		double local[nofMetrics] = {double(getNumOctants()), localWeight, double(getNumGhosts()),
+				double(bordersPerProc.size()), double(nofBorders*bytesPerOctant), nodeBytes};
+		double triples[3*nofMetrics];
+		for (int i = 0; i < nofMetrics; i++){
+			triples[3*i] = triples[3*i+1] = triples[3*i+2] = local[i];
+		}
+		int nofProcs = 1;
+#if NOMPI==0
+		if (!serial){
+			nofProcs = nproc;
+			MPI_Datatype tripleType;
+			MPI_Op tripleOp;
+			error_flag = MPI_Type_contiguous(3, MPI_DOUBLE, &tripleType);
+			error_flag = MPI_Type_commit(&tripleType);
+			error_flag = MPI_Op_create(&Class_Partition_Stats::reduce, 1, &tripleOp);
+			error_flag = MPI_Allreduce(MPI_IN_PLACE, triples, nofMetrics, tripleType, tripleOp, comm);
+			error_flag = MPI_Op_free(&tripleOp);
+			error_flag = MPI_Type_free(&tripleType);
+		}
+#endif
+		Class_Partition_Stats stats;
+		for (int i = 0; i < nofMetrics; i++){
+			Class_Partition_Stats::Metric* metric = stats.getMetric(i);
+			metric->local = local[i];
+			metric->min = triples[3*i];
+			metric->max = triples[3*i+1];
+			metric->mean = triples[3*i+2]/nofProcs;
+		}
+		return stats;
+	};
+
 
 	// --------------------------------
 private:
@@ -2062,22 +2325,464 @@ private:
 
 	// =============================================================================== //
 
+	double computePartition(uint32_t* partition, const dvector & weights) {
+		//COMPUTE A PARTITION GIVING EVERY PROCESS AN EQUAL SHARE OF THE TOTAL WEIGHT
+		//the global prefix sum of the weights along the Morton order is computed by MPI_Exscan: an octant is
+		//assigned to process p if the midpoint of its weight interval falls in [p*W/nproc,(p+1)*W/nproc).
+		//Returns the weighted imbalance (max/mean weight per process) of the new partition
+		uint32_t nofOctants = octree.getNumOctants();
+		double localWeight = 0.0;
+		for(uint32_t i = 0; i < nofOctants; ++i)
+			localWeight += weights[i];
+		double weightOffset = 0.0;
+		double totalWeight = localWeight;
+		if(!serial){
+			error_flag = MPI_Exscan(&localWeight,&weightOffset,1,MPI_DOUBLE,MPI_SUM,comm);
+			if(rank == 0)
+				weightOffset = 0.0;
+			error_flag = MPI_Allreduce(&localWeight,&totalWeight,1,MPI_DOUBLE,MPI_SUM,comm);
+		}
+		if(!(totalWeight > 0.0)){
+			computePartition(partition);
+			return 1.0;
+		}
+		vector<uint32_t> localPartition(nproc,0);
+		vector<double> localPartitionWeight(nproc,0.0);
+		double prefix = weightOffset;
+		for(uint32_t i = 0; i < nofOctants; ++i){
+			double midpoint = prefix + 0.5*weights[i];
+			prefix += weights[i];
+			int p = min(int(midpoint*nproc/totalWeight), nproc-1);
+			++localPartition[p];
+			localPartitionWeight[p] += weights[i];
+		}
+		vector<double> partitionWeight(localPartitionWeight);
+		if(serial){
+			for(int p = 0; p < nproc; ++p)
+				partition[p] = localPartition[p];
+		}
+		else{
+			error_flag = MPI_Allreduce(localPartition.data(),partition,nproc,MPI_UINT32_T,MPI_SUM,comm);
+			error_flag = MPI_Allreduce(localPartitionWeight.data(),partitionWeight.data(),nproc,MPI_DOUBLE,MPI_SUM,comm);
+		}
+		double maxWeight = *max_element(partitionWeight.begin(),partitionWeight.end());
+		return maxWeight*nproc/totalWeight;
+	}
+
+	// =============================================================================== //
+
+	double computeImbalance(const dvector & weights) {
+		//WEIGHTED IMBALANCE (MAX/MEAN WEIGHT PER PROCESS) OF THE CURRENT PARTITION
+		//a serial tree is replicated, every process holds the whole weight
+		uint32_t nofOctants = octree.getNumOctants();
+		double localWeight = 0.0;
+		for(uint32_t i = 0; i < nofOctants; ++i)
+			localWeight += weights[i];
+		double maxWeight = localWeight;
+		double totalWeight = localWeight;
+		if(!serial){
+			error_flag = MPI_Allreduce(&localWeight,&maxWeight,1,MPI_DOUBLE,MPI_MAX,comm);
+			error_flag = MPI_Allreduce(&localWeight,&totalWeight,1,MPI_DOUBLE,MPI_SUM,comm);
+		}
+		if(!(totalWeight > 0.0))
+			return 1.0;
+		return maxWeight*nproc/totalWeight;
+	}
+
+	// =============================================================================== //
+
+	void computeCostPartition(uint32_t* partition) {
+		//PARTITION WEIGHTED BY THE MEASURED OCTANT COSTS IF THE COST TRACKING IS ENABLED
+		//the costs of a serial tree are measured by every process on its own copy, it is partitioned by number of octants.
+		//The node-aware partition splits the same load over the compute nodes first
+		if(nodeAware && computeNodePartition(partition))
+			return;
+		if(costTracking && !serial){
+			updateOctantCost();
+			computePartition(partition, octantCost);
+		}
+		else{
+			computePartition(partition);
+		}
+	}
+
+	// =============================================================================== //
+
+	void computeTolerancePartition(uint32_t* partition, double tolerance) {
+		//INCREMENTAL PARTITION: EVERY BOUNDARY OF THE CURRENT PARTITION IS MOVED ONLY IF IT IS OUT OF A WINDOW AROUND THE EVEN BOUNDARY
+		//the window has half width tolerance*mean/2 in the prefix sum of the load, a moved boundary goes inside the window by half the
+		//largest octant load, so every process gets at most (1+tolerance)*mean also when the boundary is rounded to an octant.
+		//The load is the measured cost of the octants if the cost tracking is enabled, otherwise the number of octants.
+		//A moved boundary is found by the process owning its target load (midpoint rule), the boundaries are summed by one Allreduce
+		if(costTracking)
+			updateOctantCost();
+		dvector loadPrefix;
+		computeLoadPrefix(loadPrefix);
+		double localWeight = loadPrefix.back();
+		double localInfo[2] = {localWeight, 0.0};
+		for(uint32_t i = 0; i < octree.getNumOctants(); ++i)
+			localInfo[1] = max(localInfo[1], loadPrefix[i+1] - loadPrefix[i]);
+		vector<double> rankInfo(2*nproc);
+		error_flag = MPI_Allgather(localInfo,2,MPI_DOUBLE,rankInfo.data(),2,MPI_DOUBLE,comm);
+		vector<double> rankWeight(nproc);
+		double totalWeight = 0.0;
+		double maxLoad = 0.0;
+		int lastLoaded = 0;
+		for(int p = 0; p < nproc; ++p){
+			rankWeight[p] = rankInfo[2*p];
+			totalWeight += rankWeight[p];
+			maxLoad = max(maxLoad, rankInfo[2*p+1]);
+			if(rankWeight[p] > 0.0)
+				lastLoaded = p;
+		}
+		if(!(totalWeight > 0.0)){
+			computePartition(partition);
+			return;
+		}
+		double mean = totalWeight/nproc;
+		double halfWindow = 0.5*max(tolerance,0.0)*mean;
+		double innerWindow = max(halfWindow - 0.5*maxLoad, 0.0);
+		double weightOffset = 0.0;
+		for(int p = 0; p < rank; ++p)
+			weightOffset += rankWeight[p];
+		uint64_t globalOffset = (rank == 0) ? 0 : partition_range_globalidx[rank-1] + 1;
+
+		vector<uint64_t> newEnd(nproc,0);
+		double boundary = 0.0;
+		for(int p = 0; p < nproc - 1; ++p){
+			boundary += rankWeight[p];
+			double ideal = (p+1)*mean;
+			double target = (fabs(boundary - ideal) <= halfWindow) ? boundary : min(max(boundary, ideal - innerWindow), ideal + innerWindow);
+			if(target == boundary){
+				//in tolerance: the boundary is kept
+				if(rank == 0)
+					newEnd[p] = partition_range_globalidx[p] + 1;
+			}
+			else if(weightOffset <= target && (target < weightOffset + localWeight || rank == lastLoaded) && localWeight > 0.0){
+				newEnd[p] = globalOffset + findLoadIndex(loadPrefix, target, weightOffset);
+			}
+		}
+		if(rank == 0)
+			newEnd[nproc-1] = global_num_octants;
+		error_flag = MPI_Allreduce(MPI_IN_PLACE,newEnd.data(),nproc,MPI_UINT64_T,MPI_SUM,comm);
+		uint64_t previousEnd = 0;
+		for(int p = 0; p < nproc; ++p){
+			newEnd[p] = max(newEnd[p], previousEnd);
+			partition[p] = uint32_t(newEnd[p] - previousEnd);
+			previousEnd = newEnd[p];
+		}
+	}
+
+	// =============================================================================== //
+
+	double getOctantLoad(uint32_t idx) const {
+		//LOAD OF AN OCTANT: MEASURED COST IF TRACKED ON A DISTRIBUTED TREE, OTHERWISE ONE
+		return (costTracking && !serial) ? octantCost[idx] : 1.0;
+	}
+
+	// =============================================================================== //
+
+	void computeLoadPrefix(dvector & loadPrefix) {
+		//PREFIX SUMS OF THE LOAD OF THE LOCAL OCTANTS: loadPrefix[i] IS THE LOAD OF THE OCTANTS BEFORE i (NOFOCTANTS+1 VALUES)
+		uint32_t nofOctants = octree.getNumOctants();
+		loadPrefix.resize(nofOctants + 1);
+		loadPrefix[0] = 0.0;
+		for(uint32_t i = 0; i < nofOctants; ++i)
+			loadPrefix[i+1] = loadPrefix[i] + getOctantLoad(i);
+	}
+
+	// =============================================================================== //
+
+	uint32_t findLoadIndex(const dvector & loadPrefix, double target, double weightOffset) {
+		//LOCAL INDEX OF THE FIRST OCTANT WHOSE LOAD MIDPOINT IS NOT BEFORE THE TARGET LOAD (MIDPOINT RULE)
+		//weightOffset is the load of the octants of the previous processes. The load midpoints are non decreasing
+		//along the prefix sums, so the octant is found by binary search
+		uint32_t low = 0;
+		uint32_t high = uint32_t(loadPrefix.size()) - 1;
+		while(low < high){
+			uint32_t mid = low + (high - low)/2;
+			if(weightOffset + 0.5*(loadPrefix[mid] + loadPrefix[mid+1]) >= target)
+				high = mid;
+			else
+				low = mid + 1;
+		}
+		return low;
+	}
+
+	// =============================================================================== //
+
+	void computeMarkerWeights(dvector & weights) {
+		//PREDICTED LOAD OF EVERY OCTANT AFTER THE NEXT ADAPT: 4^MARKER TIMES ITS CURRENT LOAD
+		//the markers are 2:1 balanced first as in adapt, every marker is clamped to the levels allowed to its octant.
+		//The prediction of a coarsening holds if the whole family is marked
+		balance21(true);
+		if(costTracking && !serial)
+			updateOctantCost();
+		uint32_t nofOctants = octree.getNumOctants();
+		weights.resize(nofOctants);
+		for(uint32_t i = 0; i < nofOctants; ++i){
+			int level = int(octree.octants[i].getLevel());
+			int marker = min(max(int(octree.octants[i].getMarker()), -level), int(MAX_LEVEL_2D) - level);
+			weights[i] = getOctantLoad(i)*pow(double(global2D.nchildren),double(marker));
+		}
+	}
+
+	// =============================================================================== //
+
+	uint32_t alignIndex(uint32_t idx, uint32_t Dh) {
+		//NEAREST LOCAL INDEX OF AN OCTANT ALIGNED ON THE GRID OF SIZE DH (FIRST OCTANT OF A FAMILY OF THAT SIZE)
+		//the index is kept if no local octant is aligned
+		uint32_t nofOctants = octree.getNumOctants();
+		if(Dh <= 1 || idx >= nofOctants)
+			return idx;
+		uint32_t forw = idx;
+		while(forw < nofOctants && octree.octants[forw].getX()%Dh + octree.octants[forw].getY()%Dh != 0)
+			++forw;
+		uint32_t backw = idx;
+		while(backw > 0 && octree.octants[backw].getX()%Dh + octree.octants[backw].getY()%Dh != 0)
+			--backw;
+		bool backwAligned = (octree.octants[backw].getX()%Dh + octree.octants[backw].getY()%Dh == 0);
+		if(forw < nofOctants && (!backwAligned || forw - idx < idx - backw))
+			return forw;
+		if(backwAligned)
+			return backw;
+		return idx;
+	}
+
+	// =============================================================================== //
+
+	void findNodes() {
+		//FIND THE COMPUTE NODE OF EVERY PROCESS, THE PROCESSES SHARING MEMORY ARE GROUPED BY MPI_COMM_SPLIT_TYPE
+		//the nodes are numbered in increasing order of their first process, they are found once
+		if(!nodeOfRank.empty())
+			return;
+		MPI_Comm nodeComm;
+		error_flag = MPI_Comm_split_type(comm,MPI_COMM_TYPE_SHARED,rank,MPI_INFO_NULL,&nodeComm);
+		int nodeFirst = rank;
+		error_flag = MPI_Allreduce(MPI_IN_PLACE,&nodeFirst,1,MPI_INT,MPI_MIN,nodeComm);
+		error_flag = MPI_Comm_free(&nodeComm);
+		vector<int> firstOfRank(nproc);
+		error_flag = MPI_Allgather(&nodeFirst,1,MPI_INT,firstOfRank.data(),1,MPI_INT,comm);
+		vector<int> nodeFirsts(firstOfRank);
+		sort(nodeFirsts.begin(),nodeFirsts.end());
+		nodeFirsts.erase(unique(nodeFirsts.begin(),nodeFirsts.end()),nodeFirsts.end());
+		nodeOfRank.resize(nproc);
+		for(int p = 0; p < nproc; ++p)
+			nodeOfRank[p] = int(lower_bound(nodeFirsts.begin(),nodeFirsts.end(),firstOfRank[p]) - nodeFirsts.begin());
+	}
+
+	// =============================================================================== //
+
+	bool computeNodePartition(uint32_t* partition) {
+		//TWO-LEVEL PARTITION: THE LOAD IS SPLIT OVER THE COMPUTE NODES PROPORTIONALLY TO THEIR PROCESSES AND THEN EVENLY OVER THE PROCESSES OF EVERY NODE
+		//a node boundary is moved to the nearest octant starting a family of nodeLevel levels, a process boundary never crosses a node boundary.
+		//Every boundary is found by the process owning its target load (midpoint rule), the node and the process boundaries are summed by Allreduce.
+		//Returns false (no partition) if the processes are on a single node or the processes of a node are not consecutive
+		findNodes();
+		int nofNodes = nodeOfRank[nproc-1] + 1;
+		if(nofNodes == 1 || !is_sorted(nodeOfRank.begin(),nodeOfRank.end()))
+			return false;
+		vector<int> nodeFirstRank(nofNodes+1,nproc);
+		for(int p = nproc - 1; p >= 0; --p)
+			nodeFirstRank[nodeOfRank[p]] = p;
+
+		//a serial tree is replicated, every process owns all the boundaries and nothing is reduced
+		if(costTracking && !serial)
+			updateOctantCost();
+		dvector loadPrefix;
+		computeLoadPrefix(loadPrefix);
+		double localWeight = loadPrefix.back();
+		double weightOffset = 0.0;
+		double totalWeight = localWeight;
+		uint64_t globalOffset = 0;
+		int lastLoaded = rank;
+		if(!serial){
+			vector<double> rankWeight(nproc);
+			error_flag = MPI_Allgather(&localWeight,1,MPI_DOUBLE,rankWeight.data(),1,MPI_DOUBLE,comm);
+			totalWeight = 0.0;
+			lastLoaded = 0;
+			for(int p = 0; p < nproc; ++p){
+				if(p < rank)
+					weightOffset += rankWeight[p];
+				totalWeight += rankWeight[p];
+				if(rankWeight[p] > 0.0)
+					lastLoaded = p;
+			}
+			if(rank > 0)
+				globalOffset = partition_range_globalidx[rank-1] + 1;
+		}
+		if(!(totalWeight > 0.0))
+			return false;
+
+		//node boundaries: global index of the first octant of the next node and load before it
+		uint8_t level = uint8_t(min(int(max(int(max_depth) - int(nodeLevel), int(1))) , MAX_LEVEL_2D));
+		uint32_t Dh = (nodeLevel > 0) ? uint32_t(1) << (MAX_LEVEL_2D - level) : 1;
+		vector<uint64_t> nodeEnd(nofNodes,0);
+		vector<double> nodeEndWeight(nofNodes,0.0);
+		for(int k = 0; k < nofNodes - 1; ++k){
+			double target = totalWeight*nodeFirstRank[k+1]/nproc;
+			if(weightOffset <= target && (target < weightOffset + localWeight || rank == lastLoaded) && localWeight > 0.0){
+				uint32_t idx = alignIndex(findLoadIndex(loadPrefix, target, weightOffset), Dh);
+				nodeEnd[k] = globalOffset + idx;
+				nodeEndWeight[k] = weightOffset + loadPrefix[idx];
+			}
+		}
+		if(!serial){
+			error_flag = MPI_Allreduce(MPI_IN_PLACE,nodeEnd.data(),nofNodes,MPI_UINT64_T,MPI_SUM,comm);
+			error_flag = MPI_Allreduce(MPI_IN_PLACE,nodeEndWeight.data(),nofNodes,MPI_DOUBLE,MPI_SUM,comm);
+		}
+		nodeEnd[nofNodes-1] = global_num_octants;
+		nodeEndWeight[nofNodes-1] = totalWeight;
+		for(int k = 1; k < nofNodes; ++k){
+			nodeEnd[k] = max(nodeEnd[k], nodeEnd[k-1]);
+			nodeEndWeight[k] = max(nodeEndWeight[k], nodeEndWeight[k-1]);
+		}
+
+		//process boundaries inside every node, the last process of a node ends at the node boundary
+		vector<uint64_t> newEnd(nproc,0);
+		for(int p = 0; p < nproc - 1; ++p){
+			int k = nodeOfRank[p];
+			if(p == nodeFirstRank[k+1] - 1)
+				continue;
+			double nodeStartWeight = (k > 0) ? nodeEndWeight[k-1] : 0.0;
+			double target = nodeStartWeight + (nodeEndWeight[k] - nodeStartWeight)*(p + 1 - nodeFirstRank[k])/(nodeFirstRank[k+1] - nodeFirstRank[k]);
+			if(weightOffset <= target && (target < weightOffset + localWeight || rank == lastLoaded) && localWeight > 0.0)
+				newEnd[p] = globalOffset + findLoadIndex(loadPrefix, target, weightOffset);
+		}
+		if(!serial)
+			error_flag = MPI_Allreduce(MPI_IN_PLACE,newEnd.data(),nproc,MPI_UINT64_T,MPI_SUM,comm);
+		uint64_t previousEnd = 0;
+		for(int p = 0; p < nproc; ++p){
+			int k = nodeOfRank[p];
+			uint64_t nodeStart = (k > 0) ? nodeEnd[k-1] : 0;
+			if(p == nodeFirstRank[k+1] - 1)
+				newEnd[p] = nodeEnd[k];
+			else
+				newEnd[p] = min(max(newEnd[p], nodeStart), nodeEnd[k]);
+			newEnd[p] = max(newEnd[p], previousEnd);
+			partition[p] = uint32_t(newEnd[p] - previousEnd);
+			previousEnd = newEnd[p];
+		}
+		return true;
+	}
+
+	// =============================================================================== //
+
+	int computeActiveProcs() {
+		//NUMBER OF ACTIVE PROCESSES OF THE NEXT LOAD BALANCE, DECIDED BY THE FIRST PROCESS AND BROADCAST OVER fullComm
+		//the active processes are shrunk if they hold on average less than shrinkThreshold octants and expanded if they hold
+		//more than four times shrinkThreshold, then they hold about twice shrinkThreshold. No communication if the shrink is not used
+		if(shrinkThreshold == 0 && nofActive == fullNproc)
+			return nofActive;
+		int nofNext = nofActive;
+		if(fullRank == 0){
+			uint64_t mean = global_num_octants/nofActive;
+			if(shrinkThreshold == 0)
+				nofNext = fullNproc;
+			else if((mean < shrinkThreshold && nofActive > 1) || (mean > 4*uint64_t(shrinkThreshold) && nofActive < fullNproc))
+				nofNext = int(max(min(global_num_octants/(2*uint64_t(shrinkThreshold)),uint64_t(fullNproc)),uint64_t(1)));
+		}
+		error_flag = MPI_Bcast(&nofNext,1,MPI_INT,0,fullComm);
+		return nofNext;
+	}
+
+	// =============================================================================== //
+
+	void computeActivePartition(uint32_t* partition, int nofNext) {
+		//EVEN PARTITION OVER THE FIRST nofNext PROCESSES, NO OCTANTS TO THE OTHER PROCESSES
+		uint32_t division_result = uint32_t(global_num_octants/(uint64_t)nofNext);
+		uint32_t remind = uint32_t(global_num_octants%(uint64_t)nofNext);
+		for(int p = 0; p < nproc; ++p){
+			if(p < nofNext)
+				partition[p] = division_result + (uint32_t(p) < remind);
+			else
+				partition[p] = 0;
+		}
+	}
+
+	// =============================================================================== //
+
+	void setActiveProcs(int nofNext) {
+		//BUILD THE COMMUNICATOR OF THE FIRST nofNext PROCESSES OF fullComm (COLLECTIVE OVER fullComm)
+		//the active processes keep their rank and resize the partition info, the activated processes (no octants) receive it
+		//from the first process by one broadcast. The communicator of the idle processes is MPI_COMM_NULL
+		if(nofNext == nofActive)
+			return;
+		int nofPrevious = nofActive;
+		bool activated = !isActive();
+		nofActive = nofNext;
+		MPI_Comm newComm;
+		error_flag = MPI_Comm_split(fullComm,isActive() ? 0 : MPI_UNDEFINED,fullRank,&newComm);
+		neighborComm.reset();
+		neighborProcs.clear();
+		nodeOfRank.clear();
+		if(!isActive()){
+			activeComm.reset();
+			comm = MPI_COMM_NULL;
+			log.setComm(comm);
+			return;
+		}
+		if(nofActive == fullNproc){
+			error_flag = MPI_Comm_free(&newComm);
+			activeComm.reset();
+			comm = fullComm;
+		}
+		else{
+			activeComm.reset(new MPI_Comm(newComm),freeNeighborComm);
+			comm = *activeComm;
+		}
+		log.setComm(comm);
+		nproc = nofActive;
+		rank = fullRank;
+
+		//the partition info of the previous active processes, the last one is extended to the activated processes
+		int nofKept = min(nofPrevious,nproc);
+		vector<uint64_t> info(3*nofKept+2);
+		if(!activated){
+			copy(partition_range_globalidx,partition_range_globalidx+nofKept,info.begin());
+			copy(partition_first_desc,partition_first_desc+nofKept,info.begin()+nofKept);
+			copy(partition_last_desc,partition_last_desc+nofKept,info.begin()+2*nofKept);
+			info[3*nofKept] = global_num_octants;
+			info[3*nofKept+1] = max_depth;
+		}
+		if(nofPrevious < nproc)
+			error_flag = MPI_Bcast(info.data(),info.size(),MPI_UINT64_T,0,comm);
+		delete [] partition_range_globalidx;
+		delete [] partition_first_desc;
+		delete [] partition_last_desc;
+		partition_range_globalidx = new uint64_t[nproc];
+		partition_first_desc = new uint64_t[nproc];
+		partition_last_desc = new uint64_t[nproc];
+		for(int p = 0; p < nproc; ++p){
+			int q = min(p,nofKept-1);
+			partition_range_globalidx[p] = info[q];
+			partition_first_desc[p] = (p == q) ? info[nofKept+q] : info[2*nofKept+q];
+			partition_last_desc[p] = info[2*nofKept+q];
+		}
+		global_num_octants = info[3*nofKept];
+		max_depth = uint8_t(info[3*nofKept+1]);
+		serial = false;
+
+		//the ghost layer is unchanged, the neighbor communicator is rebuilt on the active processes
+		updateNeighborComm();
+		saveGhostsState();
+	}
+
+	// =============================================================================== //
+
 	void computePartition(uint32_t* partition, uint8_t & level_) {
+		//EVEN PARTITION WITH THE BOUNDARIES MOVED TO THE FIRST OCTANT OF THE NEAREST FAMILY OF level_ LEVELS OVER THE LEAVES
+		//every boundary is moved by the process owning its first octant, the shifts of the other boundaries are zero:
+		//the shifts of all the boundaries are summed by a single Allreduce
 		uint8_t level = uint8_t(min(int(max(int(max_depth) - int(level_), int(1))) , MAX_LEVEL_2D));
 		uint32_t* partition_temp = new uint32_t[nproc];
-		uint8_t* boundary_proc = new uint8_t[nproc-1];
-		uint8_t dimcomm, indcomm;
-		uint8_t* glbdimcomm = new uint8_t[nproc];
-		uint8_t* glbindcomm = new uint8_t[nproc];
+		int32_t* deplace = new int32_t[nproc-1];
 
 		uint32_t division_result = 0;
 		uint32_t remind = 0;
 		uint32_t Dh = uint32_t(pow(double(2),double(MAX_LEVEL_2D-level)));
-		uint32_t istart, nocts, rest, forw, backw;
-		uint32_t i = 0, iproc, j;
+		uint32_t istart, iproc, j;
 		uint64_t sum;
-		int32_t* pointercomm;
-		int32_t* deplace = new int32_t[nproc-1];
 		division_result = uint32_t(global_num_octants/(uint64_t)nproc);
 		remind = (uint32_t)(global_num_octants%(uint64_t)nproc);
 		for(uint32_t i = 0; i < (uint32_t)nproc; ++i)
@@ -2089,78 +2794,34 @@ private:
 		j = 0;
 		sum = 0;
 		for (iproc=0; iproc<(uint32_t)(nproc-1); iproc++){
+			deplace[iproc] = 0;
 			sum += partition_temp[iproc];
-			while(sum > partition_range_globalidx[j]){
+			while(j < (uint32_t)(nproc) && sum > partition_range_globalidx[j]){
 				j++;
 			}
-			boundary_proc[iproc] = j;
-		}
-		nocts = octree.octants.size();
-		sum = 0;
-		dimcomm = 0;
-		indcomm = 0;
-		for (iproc=0; iproc<(uint32_t)(nproc-1); iproc++){
-			deplace[iproc] = 1;
-			sum += partition_temp[iproc];
-			if (boundary_proc[iproc] == rank){
-				if (dimcomm == 0){
-					indcomm = iproc;
-				}
-				dimcomm++;
+			if (j == (uint32_t)(rank)){
 				if (rank!=0)
 					istart = sum - partition_range_globalidx[rank-1] - 1;
 				else
 					istart = sum;
-
-				i = istart;
-				rest = octree.octants[i].getX()%Dh + octree.octants[i].getY()%Dh;
-				while(rest!=0){
-					if (i==nocts){
-						i = istart + nocts;
-						break;
-					}
-					i++;
-					rest = octree.octants[i].getX()%Dh + octree.octants[i].getY()%Dh;
-				}
-				forw = i - istart;
-				i = istart;
-				rest = octree.octants[i].getX()%Dh + octree.octants[i].getY()%Dh;
-				while(rest!=0){
-					if (i==0){
-						i = istart - nocts;
-						break;
-					}
-					i--;
-					rest = octree.octants[i].getX()%Dh + octree.octants[i].getY()%Dh;
-				}
-				backw = istart - i;
-				if (forw<backw)
-					deplace[iproc] = forw;
-				else
-					deplace[iproc] = -(int32_t)backw;
+				deplace[iproc] = int32_t(alignIndex(istart, Dh)) - int32_t(istart);
 			}
 		}
+		error_flag = MPI_Allreduce(MPI_IN_PLACE,deplace,nproc-1,MPI_INT32_T,MPI_SUM,comm);
 
-		error_flag = MPI_Allgather(&dimcomm,1,MPI_UINT8_T,glbdimcomm,1,MPI_UINT8_T,comm);
-		error_flag = MPI_Allgather(&indcomm,1,MPI_UINT8_T,glbindcomm,1,MPI_UINT8_T,comm);
-		for (iproc=0; iproc<(uint32_t)(nproc); iproc++){
-			pointercomm = &deplace[glbindcomm[iproc]];
-			error_flag = MPI_Bcast(pointercomm, glbdimcomm[iproc], MPI_INT32_T, iproc, comm);
-		}
-
+		//the shifted boundaries are clamped to be non decreasing, so no partition is negative
+		uint64_t previousEnd = 0;
+		sum = 0;
 		for (iproc=0; iproc<(uint32_t)(nproc); iproc++){
+			sum += partition_temp[iproc];
+			uint64_t end = global_num_octants;
 			if (iproc < (uint32_t)(nproc-1))
-				partition[iproc] = partition_temp[iproc] + deplace[iproc];
-			else
-				partition[iproc] = partition_temp[iproc];
-			if (iproc !=0)
-				partition[iproc] = partition[iproc] - deplace[iproc-1];
+				end = uint64_t(min(max(int64_t(sum) + int64_t(deplace[iproc]), int64_t(previousEnd)), int64_t(global_num_octants)));
+			partition[iproc] = uint32_t(end - previousEnd);
+			previousEnd = end;
 		}
 
 		delete [] partition_temp; partition_temp = NULL;
-		delete [] boundary_proc; boundary_proc = NULL;
-		delete [] glbdimcomm; glbdimcomm = NULL;
-		delete [] glbindcomm; glbindcomm = NULL;
 		delete [] deplace; deplace = NULL;
 	}
 
@@ -2168,25 +2829,46 @@ private:
 
 	void updateLoadBalance() {
 		octree.updateLocalMaxDepth();
-		uint64_t* rbuff = new uint64_t[nproc];
-		uint64_t local_num_octants = octree.getNumOctants();
-		error_flag = MPI_Allgather(&local_num_octants,1,MPI_UINT64_T,rbuff,1,MPI_UINT64_T,comm);
-		for(int p = 0; p < nproc; ++p){
-			partition_range_globalidx[p] = 0;
-			for(int pp = 0; pp <=p; ++pp)
-				partition_range_globalidx[p] += rbuff[pp];
-			--partition_range_globalidx[p];
-		}
 		//update first last descendant
 		octree.setFirstDesc();
 		octree.setLastDesc();
-		//update partition_range_position
-		uint64_t lastDescMorton = octree.getLastDesc().computeMorton();
-		error_flag = MPI_Allgather(&lastDescMorton,1,MPI_UINT64_T,partition_last_desc,1,MPI_UINT64_T,comm);
-		uint64_t firstDescMorton = octree.getFirstDesc().computeMorton();
-		error_flag = MPI_Allgather(&firstDescMorton,1,MPI_UINT64_T,partition_first_desc,1,MPI_UINT64_T,comm);
+		//update partition_range_globalidx and partition_range_position
+		updatePartitionInfo();
 		serial = false;
-		delete [] rbuff; rbuff = NULL;
+	}
+
+	// =============================================================================== //
+
+	void updatePartitionInfo() {
+		//UPDATE THE PARTITION INFO OF ALL THE PROCESSES WITH ONE COLLECTIVE
+		//number of octants, first and last descendant and max depth of every process are gathered by a single
+		//MPI_Allgather, then the ranges of global indices are computed by a linear prefix sum
+		//An Exscan/Allreduce would give only the local offset and the totals, but every process needs the
+		//whole tables: partition_last_desc of all the processes to find the owner of a neighbour (findOwner)
+		//and partition_range_globalidx of all the processes for the global index of the ghosts and for the
+		//senders and receivers of a load balance (computeMigrationPeers), so they are gathered
+		uint64_t localInfo[4];
+		localInfo[0] = octree.getNumOctants();
+		localInfo[1] = octree.getFirstDesc().computeMorton();
+		localInfo[2] = octree.getLastDesc().computeMorton();
+		localInfo[3] = octree.local_max_depth;
+		vector<uint64_t> globalInfo(4*nproc);
+		error_flag = MPI_Allgather(localInfo,4,MPI_UINT64_T,globalInfo.data(),4,MPI_UINT64_T,comm);
+		uint64_t nofOctants = 0;
+		uint8_t maxDepth = 0;
+		for(int p = 0; p < nproc; ++p){
+			nofOctants += globalInfo[4*p];
+			partition_range_globalidx[p] = nofOctants - 1;
+			partition_first_desc[p] = globalInfo[4*p+1];
+			partition_last_desc[p] = globalInfo[4*p+2];
+			if(globalInfo[4*p] == 0 && p > 0){
+				//a process with no octants (idle after a shrink) gets an empty range at the last descendant of the previous one
+				partition_first_desc[p] = partition_last_desc[p] = partition_last_desc[p-1];
+			}
+			maxDepth = max(maxDepth,(uint8_t)globalInfo[4*p+3]);
+		}
+		global_num_octants = nofOctants;
+		max_depth = maxDepth;
 	}
 
 	// =============================================================================== //
@@ -2217,6 +2899,44 @@ private:
 
 	// =============================================================================== //
 
+	void findBorderProcs(Class_Octant<2> & octant, set<int> & procs) {
+		//find the owners of the virtual neighbors of an octant and set its pbound flags
+		//Virtual Face Neighbors
+		for(uint8_t i = 0; i < global2D.nfaces; ++i){
+			if(octant.getBound(i) == false){
+				uint32_t virtualNeighborsSize = 0;
+				vector<uint64_t> virtualNeighbors = octant.computeVirtualMorton(i,max_depth,virtualNeighborsSize);
+				uint32_t maxDelta = virtualNeighborsSize/2;
+				for(uint32_t j = 0; j <= maxDelta; ++j){
+					int pBegin = findOwner(virtualNeighbors[j]);
+					int pEnd = findOwner(virtualNeighbors[virtualNeighborsSize - 1 - j]);
+					procs.insert(pBegin);
+					procs.insert(pEnd);
+					if(pBegin != rank || pEnd != rank){
+						octant.setPbound(i,true);
+					}
+					else{
+						octant.setPbound(i,false);
+					}
+				}
+			}
+		}
+		//Virtual Corner Neighbors
+		for(uint8_t c = 0; c < global2D.nnodes; ++c){
+			if(!octant.getBound(global2D.nodeface[c][0]) && !octant.getBound(global2D.nodeface[c][1])){
+				uint32_t virtualCornerNeighborSize = 0;
+				uint64_t virtualCornerNeighbor = octant.computeNodeVirtualMorton(c,max_depth,virtualCornerNeighborSize);
+				if(virtualCornerNeighborSize){
+					int proc = findOwner(virtualCornerNeighbor);
+					procs.insert(proc);
+				}
+			}
+		}
+
+	}
+
+	// =============================================================================== //
+
 	void setPboundGhosts() {
 		//BUILD BORDER OCTANT INDECES VECTOR (map value) TO BE SENT TO THE RIGHT PROCESS (map key)
 		//find local octants to be sent as ghost to the right processes
@@ -2230,37 +2950,7 @@ private:
 		bordersPerProc.clear();
 		for(Class_Local_Tree<2>::OctantsType::iterator it = begin; it != end; ++it){
 			set<int> procs;
-			//Virtual Face Neighbors
-			for(uint8_t i = 0; i < global2D.nfaces; ++i){
-				if(it->getBound(i) == false){
-					uint32_t virtualNeighborsSize = 0;
-					vector<uint64_t> virtualNeighbors = it->computeVirtualMorton(i,max_depth,virtualNeighborsSize);
-					uint32_t maxDelta = virtualNeighborsSize/2;
-					for(uint32_t j = 0; j <= maxDelta; ++j){
-						int pBegin = findOwner(virtualNeighbors[j]);
-						int pEnd = findOwner(virtualNeighbors[virtualNeighborsSize - 1 - j]);
-						procs.insert(pBegin);
-						procs.insert(pEnd);
-						if(pBegin != rank || pEnd != rank){
-							it->setPbound(i,true);
-						}
-						else{
-							it->setPbound(i,false);
-						}
-					}
-				}
-			}
-			//Virtual Corner Neighbors
-			for(uint8_t c = 0; c < global2D.nnodes; ++c){
-				if(!it->getBound(global2D.nodeface[c][0]) && !it->getBound(global2D.nodeface[c][1])){
-					uint32_t virtualCornerNeighborSize = 0;
-					uint64_t virtualCornerNeighbor = it ->computeNodeVirtualMorton(c,max_depth,virtualCornerNeighborSize);
-					if(virtualCornerNeighborSize){
-						int proc = findOwner(virtualCornerNeighbor);
-						procs.insert(proc);
-					}
-				}
-			}
+			findBorderProcs(*it, procs);
 
 			set<int>::iterator pitend = procs.end();
 			for(set<int>::iterator pit = procs.begin(); pit != pitend; ++pit){
@@ -2276,16 +2966,20 @@ private:
 		}
 		MPI_Barrier(comm);
 
-		//PACK (mpi) BORDER OCTANTS IN CHAR BUFFERS WITH SIZE (map value) TO BE SENT TO THE RIGHT PROCESS (map key)
+		updateNeighborComm();
+		commGhosts();
+	}
+
+	// =============================================================================== //
+
+	void commGhosts() {
+		//PACK BORDER OCTANTS IN CHAR BUFFERS WITH SIZE (map value) TO BE SENT TO THE RIGHT PROCESS (map key)
 		//it visits every element in bordersPerProc (one for every neighbor proc)
 		//for every element it visits the border octants it contains and pack them in a new structure, sendBuffers
 		//this map has an entry Class_Comm_Buffer for every proc containing the size in bytes of the buffer and the octants
 		//to be sent to that proc packed in a char* buffer
+		//(the graph communicator of the neighbor processes must be updated by the caller, see updateNeighborComm)
 		uint64_t global_index;
-		uint32_t x,y;
-		uint8_t l;
-		int8_t m;
-		bool info[12];
 		map<int,Class_Comm_Buffer> sendBuffers;
 		map<int,vector<uint32_t> >::iterator bitend = bordersPerProc.end();
 		uint32_t pbordersOversize = 0;
@@ -2294,71 +2988,24 @@ private:
 			int buffSize = bit->second.size() * (int)ceil((double)(global2D.octantBytes + global2D.globalIndexBytes) / (double)(CHAR_BIT/8));
 			int key = bit->first;
 			const vector<uint32_t> & value = bit->second;
-			sendBuffers[key] = Class_Comm_Buffer(buffSize,'a',comm);
-			int pos = 0;
+			sendBuffers[key] = getPoolBuffer(buffSize);
 			int nofBorders = value.size();
 			for(int i = 0; i < nofBorders; ++i){
-				//the use of auxiliary variable can be avoided passing to MPI_Pack the members of octant but octant in that case cannot be const
-				const Class_Octant<2> & octant = octree.octants[value[i]];
-				x = octant.getX();
-				y = octant.getY();
-				l = octant.getLevel();
-				m = octant.getMarker();
-				global_index = getGlobalIdx(value[i]);
-				for(int i = 0; i < 12; ++i)
-					info[i] = octant.info[i];
-				error_flag = MPI_Pack(&x,1,MPI_UINT32_T,sendBuffers[key].commBuffer,buffSize,&pos,comm);
-				error_flag = MPI_Pack(&y,1,MPI_UINT32_T,sendBuffers[key].commBuffer,buffSize,&pos,comm);
-				error_flag = MPI_Pack(&l,1,MPI_UINT8_T,sendBuffers[key].commBuffer,buffSize,&pos,comm);
-				error_flag = MPI_Pack(&m,1,MPI_INT8_T,sendBuffers[key].commBuffer,buffSize,&pos,comm);
-				for(int j = 0; j < 12; ++j){
-					MPI_Pack(&info[j],1,MPI::BOOL,sendBuffers[key].commBuffer,buffSize,&pos,comm);
-				}
-				error_flag = MPI_Pack(&global_index,1,MPI_UINT64_T,sendBuffers[key].commBuffer,buffSize,&pos,comm);
+				sendBuffers[key].write(octree.octants[value[i]].getWire());
+				sendBuffers[key].write(getGlobalIdx(value[i]));
 			}
 		}
 
-		//COMMUNICATE THE SIZE OF BUFFER TO THE RECEIVERS
-		//the size of every borders buffer is communicated to the right process in order to build the receive buffer
-		//and stored in the recvBufferSizePerProc structure
-		MPI_Request* req = new MPI_Request[sendBuffers.size()*2];
-		MPI_Status* stats = new MPI_Status[sendBuffers.size()*2];
-		int nReq = 0;
-		map<int,int> recvBufferSizePerProc;
-		map<int,Class_Comm_Buffer>::iterator sitend = sendBuffers.end();
-		for(map<int,Class_Comm_Buffer>::iterator sit = sendBuffers.begin(); sit != sitend; ++sit){
-			recvBufferSizePerProc[sit->first] = 0;
-			error_flag = MPI_Irecv(&recvBufferSizePerProc[sit->first],1,MPI_UINT32_T,sit->first,rank,comm,&req[nReq]);
-			++nReq;
-		}
-		map<int,Class_Comm_Buffer>::reverse_iterator rsitend = sendBuffers.rend();
-		for(map<int,Class_Comm_Buffer>::reverse_iterator rsit = sendBuffers.rbegin(); rsit != rsitend; ++rsit){
-			error_flag =  MPI_Isend(&rsit->second.commBufferSize,1,MPI_UINT32_T,rsit->first,rsit->first,comm,&req[nReq]);
-			++nReq;
-		}
-		MPI_Waitall(nReq,req,stats);
-
-		//COMMUNICATE THE BUFFERS TO THE RECEIVERS
-		//recvBuffers structure is declared and each buffer is initialized to the right size
-		//then, sendBuffers are communicated by senders and stored in recvBuffers in the receivers
+		//COMMUNICATE THE BUFFERS TO THE NEIGHBOR PROCESSES
+		//sendBuffers are exchanged with the neighbor processes over the graph communicator and stored in recvBuffers
 		//at the same time every process compute the size in bytes of all the ghost octants
-		uint32_t nofBytesOverProc = 0;
 		map<int,Class_Comm_Buffer> recvBuffers;
-		map<int,int>::iterator ritend = recvBufferSizePerProc.end();
-		for(map<int,int>::iterator rit = recvBufferSizePerProc.begin(); rit != ritend; ++rit){
-			recvBuffers[rit->first] = Class_Comm_Buffer(rit->second,'a',comm);
-		}
-		nReq = 0;
-		for(map<int,Class_Comm_Buffer>::iterator sit = sendBuffers.begin(); sit != sitend; ++sit){
-			nofBytesOverProc += recvBuffers[sit->first].commBufferSize;
-			error_flag = MPI_Irecv(recvBuffers[sit->first].commBuffer,recvBuffers[sit->first].commBufferSize,MPI_PACKED,sit->first,rank,comm,&req[nReq]);
-			++nReq;
-		}
-		for(map<int,Class_Comm_Buffer>::reverse_iterator rsit = sendBuffers.rbegin(); rsit != rsitend; ++rsit){
-			error_flag =  MPI_Isend(rsit->second.commBuffer,rsit->second.commBufferSize,MPI_PACKED,rsit->first,rsit->first,comm,&req[nReq]);
-			++nReq;
+		commNeighbors(sendBuffers,recvBuffers);
+		uint32_t nofBytesOverProc = 0;
+		map<int,Class_Comm_Buffer>::iterator ritend = recvBuffers.end();
+		for(map<int,Class_Comm_Buffer>::iterator rit = recvBuffers.begin(); rit != ritend; ++rit){
+			nofBytesOverProc += rit->second.commBufferSize;
 		}
-		MPI_Waitall(nReq,req,stats);
 
 		//COMPUTE GHOSTS SIZE IN BYTES
 		//number of ghosts in every process is obtained through the size in bytes of the single octant
@@ -2372,408 +3019,569 @@ private:
 		//UNPACK BUFFERS AND BUILD GHOSTS CONTAINER OF CLASS_LOCAL_TREE
 		//every entry in recvBuffers is visited, each buffers from neighbor processes is unpacked octant by octant.
 		//every ghost octant is built and put in the ghost vector
+		ghostsPerProc.clear();
 		uint32_t ghostCounter = 0;
 		map<int,Class_Comm_Buffer>::iterator rritend = recvBuffers.end();
 		for(map<int,Class_Comm_Buffer>::iterator rrit = recvBuffers.begin(); rrit != rritend; ++rrit){
-			int pos = 0;
 			int nofGhostsPerProc = int(rrit->second.commBufferSize / (uint32_t) (global2D.octantBytes + global2D.globalIndexBytes));
+			ghostsPerProc[rrit->first] = nofGhostsPerProc;
 			for(int i = 0; i < nofGhostsPerProc; ++i){
-				error_flag = MPI_Unpack(rrit->second.commBuffer,rrit->second.commBufferSize,&pos,&x,1,MPI_UINT32_T,comm);
-				error_flag = MPI_Unpack(rrit->second.commBuffer,rrit->second.commBufferSize,&pos,&y,1,MPI_UINT32_T,comm);
-				error_flag = MPI_Unpack(rrit->second.commBuffer,rrit->second.commBufferSize,&pos,&l,1,MPI_UINT8_T,comm);
-				octree.ghosts[ghostCounter] = Class_Octant<2>(l,x,y);
-				error_flag = MPI_Unpack(rrit->second.commBuffer,rrit->second.commBufferSize,&pos,&m,1,MPI_INT8_T,comm);
-				octree.ghosts[ghostCounter].setMarker(m);
-				for(int j = 0; j < 12; ++j){
-					error_flag = MPI_Unpack(rrit->second.commBuffer,rrit->second.commBufferSize,&pos,&info[j],1,MPI::BOOL,comm);
-					octree.ghosts[ghostCounter].info[j] = info[j];
-				}
-				error_flag = MPI_Unpack(rrit->second.commBuffer,rrit->second.commBufferSize,&pos,&global_index,1,MPI_UINT64_T,comm);
+				Class_Octant<2>::Wire wire;
+				rrit->second.read(wire);
+				octree.ghosts[ghostCounter] = Class_Octant<2>(wire);
+				rrit->second.read(global_index);
 				octree.globalidx_ghosts[ghostCounter] = global_index;
 				++ghostCounter;
 			}
 		}
-		recvBuffers.clear();
-		sendBuffers.clear();
-		recvBufferSizePerProc.clear();
+		releasePoolBuffers(recvBuffers);
+		releasePoolBuffers(sendBuffers);
 
-		delete [] req; req = NULL;
-		delete [] stats; stats = NULL;
+		saveGhostsState();
 
 	}
 
 	// =============================================================================== //
 
-public:
-	/** Distribute Load-Balancing the octants of the whole tree over
-	 * the processes of the job following the Morton order.
-	 * Until loadBalance is not called for the first time the mesh is serial.
-	 */
-	void loadBalance(){
+	static void freeNeighborComm(MPI_Comm* graphComm) {
+		//the graph communicator (or the communicator of the active processes) is freed by the last copy of the tree using it (if MPI is not finalized yet)
+		int finalized = 0;
+		MPI_Finalized(&finalized);
+		if(!finalized)
+			MPI_Comm_free(graphComm);
+		delete graphComm;
+	}
 
-		//Write info on log
-		log.writeLog("---------------------------------------------");
-		log.writeLog(" LOAD BALANCE ");
+	// =============================================================================== //
 
-		uint32_t* partition = new uint32_t [nproc];
-		computePartition(partition);
-		if(serial)
-		{
-			log.writeLog(" ");
-			log.writeLog(" Initial Serial distribution : ");
-			for(int ii=0; ii<nproc; ii++){
-				log.writeLog(" Octants for proc	"+ to_string(ii)+"	:	" + to_string(partition_range_globalidx[ii]+1));
-			}
+	bool updateNeighborComm() {
+		//BUILD THE GRAPH COMMUNICATOR OF THE NEIGHBOR PROCESSES
+		//the ghost relation is symmetric, so the keys of bordersPerProc are both sources and destinations.
+		//The communicator is rebuilt (collectively) only if the neighbors of some process are changed,
+		//the returned flag (the same on every process) is true if it is rebuilt
+		vector<int> procs;
+		procs.reserve(bordersPerProc.size());
+		map<int,vector<uint32_t> >::iterator bitend = bordersPerProc.end();
+		for(map<int,vector<uint32_t> >::iterator bit = bordersPerProc.begin(); bit != bitend; ++bit){
+			procs.push_back(bit->first);
+		}
+		bool changed = (!neighborComm || procs != neighborProcs), globalChanged = false;
+		error_flag = MPI_Allreduce(&changed,&globalChanged,1,MPI::BOOL,MPI_LOR,comm);
+		if(!globalChanged)
+			return false;
+		neighborProcs.swap(procs);
+		int nofNeighbors = neighborProcs.size();
+		MPI_Comm graphComm;
+		error_flag = MPI_Dist_graph_create_adjacent(comm,nofNeighbors,neighborProcs.data(),MPI_UNWEIGHTED,
+				nofNeighbors,neighborProcs.data(),MPI_UNWEIGHTED,MPI_INFO_NULL,0,&graphComm);
+		neighborComm.reset(new MPI_Comm(graphComm),freeNeighborComm);
+		return true;
+	}
 
-			uint32_t stride = 0;
-			for(int i = 0; i < rank; ++i)
-				stride += partition[i];
-			Class_Local_Tree<2>::OctantsType octantsCopy = octree.octants;
-			Class_Local_Tree<2>::OctantsType::const_iterator first = octantsCopy.begin() + stride;
-			Class_Local_Tree<2>::OctantsType::const_iterator last = first + partition[rank];
-			octree.octants.assign(first, last);
-			octree.octants.shrink_to_fit();
-			first = octantsCopy.end();
-			last = octantsCopy.end();
+	// =============================================================================== //
 
-			//Update and ghosts here
-			updateLoadBalance();
-			setPboundGhosts();
+	void commNeighbors(map<int,Class_Comm_Buffer> & sendBuffers, map<int,Class_Comm_Buffer> & recvBuffers) {
+		//EXCHANGE BUFFERS WITH THE NEIGHBOR PROCESSES
+		//the size of every buffer in sendBuffers (one for every neighbor process) is exchanged by MPI_Neighbor_alltoall,
+		//then recvBuffers are built and the buffers are exchanged by MPI_Neighbor_alltoallw addressing each
+		//Class_Comm_Buffer directly (absolute addresses from MPI_BOTTOM), so no contiguous copy is needed
+		releasePoolBuffers(recvBuffers);
+		if(!neighborComm)
+			return;
+		int nofNeighbors = neighborProcs.size();
+		vector<uint32_t> sendSizes(nofNeighbors,0), recvSizes(nofNeighbors,0);
+		vector<Class_Comm_Buffer*> sendPtrs(nofNeighbors,NULL);
+		for(int i = 0; i < nofNeighbors; ++i){
+			map<int,Class_Comm_Buffer>::iterator sit = sendBuffers.find(neighborProcs[i]);
+			if(sit != sendBuffers.end()){
+				sendPtrs[i] = &sit->second;
+				sendSizes[i] = sit->second.commBufferSize;
+			}
+		}
+		error_flag = MPI_Neighbor_alltoall(sendSizes.data(),1,MPI_UINT32_T,recvSizes.data(),1,MPI_UINT32_T,*neighborComm);
+
+		vector<int> sendCounts(nofNeighbors,0), recvCounts(nofNeighbors,0);
+		vector<MPI_Aint> sendDispls(nofNeighbors,0), recvDispls(nofNeighbors,0);
+		vector<MPI_Datatype> types(nofNeighbors,MPI_BYTE);
+		for(int i = 0; i < nofNeighbors; ++i){
+			Class_Comm_Buffer & recvBuffer = recvBuffers[neighborProcs[i]];
+			recvBuffer = getPoolBuffer(recvSizes[i]);
+			recvCounts[i] = recvSizes[i];
+			MPI_Get_address(recvBuffer.commBuffer,&recvDispls[i]);
+			if(sendPtrs[i] != NULL){
+				sendCounts[i] = sendSizes[i];
+				MPI_Get_address(sendPtrs[i]->commBuffer,&sendDispls[i]);
+			}
+		}
+		error_flag = MPI_Neighbor_alltoallw(MPI_BOTTOM,sendCounts.data(),sendDispls.data(),types.data(),
+				MPI_BOTTOM,recvCounts.data(),recvDispls.data(),types.data(),*neighborComm);
+	}
 
+	// =============================================================================== //
+
+	void computeMigrationPeers(const uint64_t* newPartitionRangeGlobalidx, set<int> & senders, set<int> & receivers) {
+		//FIND THE PROCESSES EXCHANGING OCTANTS IN A LOAD BALANCE
+		//the old (partition_range_globalidx) and the new partition ranges are known by every process:
+		//the senders are the processes whose old range overlaps the new range of this process, the receivers
+		//are the processes whose new range overlaps the old range of this process.
+		//The first overlapping process is found by binary search, so the cost depends on the number of peers only.
+		//Ranges are taken with exclusive end (last + 1), empty partitions have begin == end
+		senders.clear();
+		receivers.clear();
+		uint64_t oldBegin = (rank == 0) ? 0 : partition_range_globalidx[rank-1] + 1;
+		uint64_t oldEnd = partition_range_globalidx[rank] + 1;
+		uint64_t newBegin = (rank == 0) ? 0 : newPartitionRangeGlobalidx[rank-1] + 1;
+		uint64_t newEnd = newPartitionRangeGlobalidx[rank] + 1;
+		findOverlappingProcs(partition_range_globalidx,newBegin,newEnd,senders);
+		findOverlappingProcs(newPartitionRangeGlobalidx,oldBegin,oldEnd,receivers);
+	}
+
+	// =============================================================================== //
+
+	uint32_t countMigrationOctants(const uint64_t* newPartitionRangeGlobalidx, int sender) {
+		//NUMBER OF OCTANTS RECEIVED FROM A SENDER IN A LOAD BALANCE
+		//the octants in the old range of the sender that fall in the new range of this process
+		uint64_t begin = max((sender == 0) ? 0 : partition_range_globalidx[sender-1] + 1, (rank == 0) ? 0 : newPartitionRangeGlobalidx[rank-1] + 1);
+		uint64_t end = min(partition_range_globalidx[sender] + 1, newPartitionRangeGlobalidx[rank] + 1);
+		return (end > begin) ? (uint32_t)(end - begin) : 0;
+	}
+
+	// =============================================================================== //
+
+	void findOverlappingProcs(const uint64_t* rangeGlobalidx, uint64_t begin, uint64_t end, set<int> & procs) {
+		//FIND THE PROCESSES (BUT THIS ONE) WITH A NON EMPTY RANGE OVERLAPPING [begin,end)
+		if(begin >= end)
+			return;
+		int low = 0, high = nproc;
+		while(low < high){
+			int mid = (low + high) / 2;
+			if(rangeGlobalidx[mid] + 1 > begin)
+				high = mid;
+			else
+				low = mid + 1;
 		}
-		else
-		{
-			log.writeLog(" ");
-			log.writeLog(" Initial Parallel partition : ");
-			log.writeLog(" Octants for proc	"+ to_string(0)+"	:	" + to_string(partition_range_globalidx[0]+1));
-			for(int ii=1; ii<nproc; ii++){
-				log.writeLog(" Octants for proc	"+ to_string(ii)+"	:	" + to_string(partition_range_globalidx[ii]-partition_range_globalidx[ii-1]));
-			}
+		for(int p = low; p < nproc; ++p){
+			uint64_t pBegin = (p == 0) ? 0 : rangeGlobalidx[p-1] + 1;
+			uint64_t pEnd = rangeGlobalidx[p] + 1;
+			if(pBegin >= end)
+				break;
+			if(pBegin < pEnd && p != rank)
+				procs.insert(p);
+		}
+	}
 
-			//empty ghosts
-			octree.ghosts.clear();
-			octree.size_ghosts = 0;
-			//compute new partition range globalidx
-			uint64_t* newPartitionRangeGlobalidx = new uint64_t[nproc];
-			for(int p = 0; p < nproc; ++p){
-				newPartitionRangeGlobalidx[p] = 0;
-				for(int pp = 0; pp <= p; ++pp)
-					newPartitionRangeGlobalidx[p] += (uint64_t)partition[pp];
-				--newPartitionRangeGlobalidx[p];
-			}
+	// =============================================================================== //
 
-			//find resident octants local offset lastHead(lh) and firstTail(ft)
-			int32_t lh,ft;
-			if(rank == 0)
-				lh = -1;
-			else{
-				lh = (int32_t)(newPartitionRangeGlobalidx[rank-1] + 1 - partition_range_globalidx[rank-1] - 1 - 1);
+	Class_Comm_Buffer getPoolBuffer(uint32_t size) {
+		//GET A COMMUNICATION BUFFER OF A GIVEN SIZE FROM THE BUFFER POOL
+		//the pooled buffer with the smallest capacity not smaller than size is moved out of the pool (best fit),
+		//a new buffer is allocated if no pooled buffer is large enough; the content of the buffer is not initialized
+		int best = -1;
+		int nofPooled = bufferPool.size();
+		for(int i = 0; i < nofPooled; ++i){
+			uint32_t capacity = bufferPool[i].commBufferCapacity;
+			if(capacity >= size && (best < 0 || capacity < bufferPool[best].commBufferCapacity))
+				best = i;
+		}
+		if(best < 0)
+			return Class_Comm_Buffer(size,comm);
+		if(best != nofPooled - 1)
+			swap(bufferPool[best],bufferPool.back());
+		Class_Comm_Buffer buffer(std::move(bufferPool.back()));
+		bufferPool.pop_back();
+		bufferPoolBytes -= buffer.commBufferCapacity;
+		buffer.comm = comm;
+		buffer.resize(size);
+		return buffer;
+	}
+
+	// =============================================================================== //
+
+	void releasePoolBuffers(map<int,Class_Comm_Buffer> & buffers) {
+		//RELEASE THE BUFFERS OF AN EXCHANGE TO THE BUFFER POOL
+		//the pool holds at most the buffers used at the same time by one exchange and at most bufferPoolLimit bytes
+		map<int,Class_Comm_Buffer>::iterator bitend = buffers.end();
+		for(map<int,Class_Comm_Buffer>::iterator bit = buffers.begin(); bit != bitend; ++bit){
+			releasePoolBuffer(bit->second);
+		}
+		buffers.clear();
+	}
+
+	// =============================================================================== //
+
+	void releasePoolBuffer(Class_Comm_Buffer & buffer) {
+		//RELEASE A BUFFER TO THE BUFFER POOL
+		//the buffer is freed instead if the pool would exceed bufferPoolLimit bytes
+		if(buffer.commBufferCapacity != 0 && bufferPoolBytes + buffer.commBufferCapacity <= bufferPoolLimit){
+			bufferPoolBytes += buffer.commBufferCapacity;
+			bufferPool.push_back(std::move(buffer));
+		}
+	}
+
+	// =============================================================================== //
+
+	void buildCommPlan(Class_Comm_Plan & plan, size_t fixedDataSize) {
+		//BUILD THE COMMUNICATION PLAN OF THE CURRENT GHOST LAYER
+		//one send and one receive buffer for every neighbor process (graph communicator order) and the offset of
+		//its ghosts. For fixed size data the buffers have their final size and the persistent requests are initialized
+		plan.clear();
+		plan.procs = neighborProcs;
+		int nofNeighbors = plan.procs.size();
+		plan.ghostOffsets.resize(nofNeighbors);
+		plan.nofGhosts.resize(nofNeighbors);
+		plan.sendSizes.assign(nofNeighbors,0);
+		plan.recvSizes.assign(nofNeighbors,0);
+		plan.sendBuffers.resize(nofNeighbors);
+		plan.recvBuffers.resize(nofNeighbors);
+		uint32_t ghostOffset = 0;
+		for(int i = 0; i < nofNeighbors; ++i){
+			plan.ghostOffsets[i] = ghostOffset;
+			plan.nofGhosts[i] = ghostsPerProc[plan.procs[i]];
+			ghostOffset += plan.nofGhosts[i];
+			if(fixedDataSize != 0){
+				plan.sendSizes[i] = fixedDataSize*bordersPerProc[plan.procs[i]].size();
+				plan.recvSizes[i] = fixedDataSize*plan.nofGhosts[i];
+				plan.sendBuffers[i].resize(plan.sendSizes[i]);
+				plan.recvBuffers[i].resize(plan.recvSizes[i]);
 			}
-			if(lh < 0)
-				lh = - 1;
-			else if(lh > (int32_t)(octree.octants.size() - 1))
-				lh = octree.octants.size() - 1;
-
-			if(rank == nproc - 1)
-				ft = octree.octants.size();
-			else if(rank == 0)
-				ft = (int32_t)(newPartitionRangeGlobalidx[rank] + 1);
-			else{
-				ft = (int32_t)(newPartitionRangeGlobalidx[rank] - partition_range_globalidx[rank -1]);
+		}
+		if(fixedDataSize != 0){
+			plan.requests.resize(2*nofNeighbors);
+			for(int i = 0; i < nofNeighbors; ++i){
+				error_flag = MPI_Recv_init(plan.recvBuffers[i].commBuffer,plan.recvSizes[i],MPI_BYTE,plan.procs[i],0,*neighborComm,&plan.requests[i]);
+				error_flag = MPI_Send_init(plan.sendBuffers[i].commBuffer,plan.sendSizes[i],MPI_BYTE,plan.procs[i],0,*neighborComm,&plan.requests[nofNeighbors+i]);
 			}
-			if(ft > (int32_t)(octree.octants.size() - 1))
-				ft = octree.octants.size();
-			else if(ft < 0)
-				ft = 0;
-
-			//compute size Head and size Tail
-			uint32_t headSize = (uint32_t)(lh + 1);
-			uint32_t tailSize = (uint32_t)(octree.octants.size() - ft);
-			uint32_t headOffset = headSize;
-			uint32_t tailOffset = tailSize;
-
-			//build send buffers
-			map<int,Class_Comm_Buffer> sendBuffers;
+		}
+		plan.fixedSize = fixedDataSize;
+		plan.stamp = ghostsStamp;
+		plan.built = true;
+	}
+
+	// =============================================================================== //
 
-			//Compute first predecessor and first successor to send buffers to
-			int64_t firstOctantGlobalIdx = 0;// offset to compute global index of each octant in every process
-			int64_t globalLastHead = (int64_t) lh;
-			int64_t globalFirstTail = (int64_t) ft; //lastHead and firstTail in global ordering
-			int firstPredecessor = -1;
-			int firstSuccessor = nproc;
-			if(rank != 0){
-				firstOctantGlobalIdx = (int64_t)(partition_range_globalidx[rank-1] + 1);
-				globalLastHead = firstOctantGlobalIdx + (int64_t)lh;
-				globalFirstTail = firstOctantGlobalIdx + (int64_t)ft;
-				for(int pre = rank - 1; pre >=0; --pre){
-					if((uint64_t)globalLastHead <= newPartitionRangeGlobalidx[pre])
-						firstPredecessor = pre;
+	void buildTypedCommPlan(Class_Comm_Plan & plan, size_t typeSize) {
+		//BUILD THE TYPED COMMUNICATION PLAN OF THE CURRENT GHOST LAYER
+		//the border octants of every neighbor are described by an indexed datatype on the data vector,
+		//the ghosts of every neighbor are received in place at their offset in the ghost data vector
+		buildCommPlan(plan,0);
+		int nofNeighbors = plan.procs.size();
+		plan.sendBuffers.clear();
+		plan.recvBuffers.clear();
+		plan.sendTypes.resize(nofNeighbors);
+		plan.types.assign(nofNeighbors,MPI_BYTE);
+		plan.sendDispls.assign(nofNeighbors,0);
+		plan.recvDispls.resize(nofNeighbors);
+		MPI_Datatype octantType;
+		error_flag = MPI_Type_contiguous(typeSize,MPI_BYTE,&octantType);
+		for(int i = 0; i < nofNeighbors; ++i){
+			const vector<uint32_t> & borders = bordersPerProc[plan.procs[i]];
+			vector<int> displs(borders.begin(),borders.end());
+			error_flag = MPI_Type_create_indexed_block(displs.size(),1,displs.data(),octantType,&plan.sendTypes[i]);
+			error_flag = MPI_Type_commit(&plan.sendTypes[i]);
+			plan.sendSizes[i] = 1;
+			plan.recvSizes[i] = typeSize*plan.nofGhosts[i];
+			plan.recvDispls[i] = typeSize*plan.ghostOffsets[i];
+		}
+		error_flag = MPI_Type_free(&octantType);
+		plan.fixedSize = typeSize;
+		plan.typed = true;
+	}
+
+	// =============================================================================== //
+
+	void startCommPlan(Class_Comm_Plan & plan) {
+		//START THE EXCHANGE OF THE BUFFERS OF A COMMUNICATION PLAN
+		//fixed size data: the persistent requests are started, no size handshake is needed.
+		//variable size data: the sizes are exchanged by MPI_Neighbor_alltoall, the receive buffers are reallocated
+		//only if their size is changed and the buffers are exchanged by MPI_Ineighbor_alltoallw
+		int nofNeighbors = plan.procs.size();
+		plan.pending = true;
+		if(plan.fixedSize != 0){
+			if(nofNeighbors){
+				error_flag = MPI_Startall(plan.requests.size(),plan.requests.data());
+			}
+			return;
+		}
+		if(!neighborComm)
+			return;
+		error_flag = MPI_Neighbor_alltoall(plan.sendSizes.data(),1,MPI_INT,plan.recvSizes.data(),1,MPI_INT,*neighborComm);
+
+		plan.sendDispls.resize(nofNeighbors);
+		plan.recvDispls.resize(nofNeighbors);
+		plan.types.assign(nofNeighbors,MPI_BYTE);
+		for(int i = 0; i < nofNeighbors; ++i){
+			plan.recvBuffers[i].resize(plan.recvSizes[i]);
+			MPI_Get_address(plan.sendBuffers[i].commBuffer,&plan.sendDispls[i]);
+			MPI_Get_address(plan.recvBuffers[i].commBuffer,&plan.recvDispls[i]);
+		}
+		error_flag = MPI_Ineighbor_alltoallw(MPI_BOTTOM,plan.sendSizes.data(),plan.sendDispls.data(),plan.types.data(),
+				MPI_BOTTOM,plan.recvSizes.data(),plan.recvDispls.data(),plan.types.data(),*neighborComm,&plan.neighborRequest);
+	}
+
+	// =============================================================================== //
+
+	void waitCommPlan(Class_Comm_Plan & plan) {
+		//COMPLETE THE EXCHANGE OF THE BUFFERS OF A COMMUNICATION PLAN
+		if(!plan.pending)
+			return;
+		if(!plan.requests.empty()){
+			error_flag = MPI_Waitall(plan.requests.size(),plan.requests.data(),MPI_STATUSES_IGNORE);
+		}
+		if(plan.neighborRequest != MPI_REQUEST_NULL){
+			error_flag = MPI_Wait(&plan.neighborRequest,MPI_STATUS_IGNORE);
+		}
+		plan.pending = false;
+	}
+
+	// =============================================================================== //
+
+	void saveGhostsState() {
+		//SAVE THE BORDER OCTANTS AND THE PARTITION OF THE LAST GHOST LAYER UPDATE
+		//used by updatePboundGhosts to find which border octants are changed by the next adapt
+		savedBorders.clear();
+		map<int,vector<uint32_t> >::iterator bitend = bordersPerProc.end();
+		for(map<int,vector<uint32_t> >::iterator bit = bordersPerProc.begin(); bit != bitend; ++bit){
+			vector<Class_Octant<2> > & saved = savedBorders[bit->first];
+			saved.resize(bit->second.size());
+			for(uint32_t i = 0; i < bit->second.size(); ++i){
+				saved[i] = octree.octants[bit->second[i]];
+			}
+		}
+		savedBordersPerProc = bordersPerProc;
+		savedFirstDesc.assign(partition_first_desc, partition_first_desc + nproc);
+		savedLastDesc.assign(partition_last_desc, partition_last_desc + nproc);
+		savedMaxDepth = max_depth;
+		savedGlobalOffset = (rank != 0) * (partition_range_globalidx[max(rank-1,0)] + 1);
+		++ghostsStamp;
+	}
+
+	// =============================================================================== //
+
+	void updatePboundGhosts() {
+		//UPDATE THE GHOST LAYER AFTER A LOCAL ADAPT EXCHANGING ONLY THE CHANGED BORDER OCTANTS
+		//if the partition and the max depth are the same of the last ghost layer update, the border processes
+		//of an octant not changed by adapt are the same: the saved border octants still existing are kept and
+		//the virtual neighbors are computed only for the octants new after refinement or coarsening.
+		//Otherwise (or if the neighbor processes are changed) the ghost layer is completely rebuilt.
+		bool unchanged = (savedFirstDesc.size() == (size_t)nproc && savedMaxDepth == max_depth);
+		for(int p = 0; unchanged && p < nproc; ++p){
+			unchanged = (savedFirstDesc[p] == partition_first_desc[p] && savedLastDesc[p] == partition_last_desc[p]);
+		}
+		if(!unchanged){
+			setPboundGhosts();
+			return;
+		}
+
+		//FIND THE SAVED BORDER OCTANTS STILL EXISTING (SAME MORTON AND LEVEL)
+		//saved borders are sorted following the Z-curve as the local octants, so the search goes on forward
+		uint32_t nocts = octree.getNumOctants();
+		vector<bool> kept(nocts,false);
+		map<int,vector<uint32_t> > keptIdx;
+		map<int,vector<uint32_t> > keptPos;
+		map<int,vector<Class_Octant<2> > >::iterator sbitend = savedBorders.end();
+		for(map<int,vector<Class_Octant<2> > >::iterator sbit = savedBorders.begin(); sbit != sbitend; ++sbit){
+			const vector<Class_Octant<2> > & saved = sbit->second;
+			uint32_t beg = 0;
+			for(uint32_t k = 0; k < saved.size(); ++k){
+				uint64_t morton = saved[k].computeMorton();
+				uint32_t end = nocts;
+				while(beg < end){
+					uint32_t mid = beg + (end - beg)/2;
+					if(octree.octants[mid].computeMorton() < morton)
+						beg = mid + 1;
+					else
+						end = mid;
 				}
-				for(int post = rank + 1; post < nproc; ++post){
-					if((uint64_t)globalFirstTail <= newPartitionRangeGlobalidx[post] && (uint64_t)globalFirstTail > newPartitionRangeGlobalidx[post-1])
-						firstSuccessor = post;
+				if(beg < nocts && octree.octants[beg].computeMorton() == morton && octree.octants[beg].getLevel() == saved[k].getLevel()){
+					kept[beg] = true;
+					keptIdx[sbit->first].push_back(beg);
+					keptPos[sbit->first].push_back(k);
 				}
 			}
-			else if(rank == 0){
-				firstSuccessor = 1;
-			}
-			MPI_Barrier(comm); //da spostare prima della prima comunicazione
-
-			uint32_t x,y;
-			uint8_t l;
-			int8_t m;
-			bool info[12];
-			//build send buffers from Head
-			if(headSize != 0){
-				for(int p = firstPredecessor; p >= 0; --p){
-					if(headSize <=partition[p]){
-						int buffSize = headSize * (int)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8));
-						sendBuffers[p] = Class_Comm_Buffer(buffSize,'a',comm);
-						int pos = 0;
-						for(uint32_t i = 0; i <= (uint32_t)lh; ++i){
-							//PACK octants from 0 to lh in sendBuffer[p]
-							const Class_Octant<2> & octant = octree.octants[i];
-							x = octant.getX();
-							y = octant.getY();
-							l = octant.getLevel();
-							m = octant.getMarker();
-							for(int i = 0; i < 12; ++i)
-								info[i] = octant.info[i];
-							error_flag = MPI_Pack(&x,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&y,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&l,1,MPI_UINT8_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&m,1,MPI_INT8_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							for(int j = 0; j < 12; ++j){
-								MPI_Pack(&info[j],1,MPI::BOOL,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							}
-						}
-						break;
-					}
-					else{
-						int buffSize = partition[p] * (int)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8));
-						sendBuffers[p] = Class_Comm_Buffer(buffSize,'a',comm);
-						int pos = 0;
-						for(uint32_t i = (uint32_t)(lh - partition[p] + 1); i <= (uint32_t)lh; ++i){
-							//pack octants from lh - partition[p] to lh
-							const Class_Octant<2> & octant = octree.octants[i];
-							x = octant.getX();
-							y = octant.getY();
-							l = octant.getLevel();
-							m = octant.getMarker();
-							for(int i = 0; i < 12; ++i)
-								info[i] = octant.info[i];
-							error_flag = MPI_Pack(&x,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&y,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&l,1,MPI_UINT8_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&m,1,MPI_INT8_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							for(int j = 0; j < 12; ++j){
-								MPI_Pack(&info[j],1,MPI::BOOL,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							}
+		}
+
+		//VIRTUAL NEIGHBORS OF THE NEW OCTANTS
+		//the pbound flags of the new octants are recomputed, the new border octants are collected per process
+		map<int,vector<uint32_t> > newIdx;
+		for(uint32_t idx = 0; idx < nocts; ++idx){
+			Class_Octant<2> & octant = octree.octants[idx];
+			if(octant.getIsNewR() || octant.getIsNewC()){
+				set<int> procs;
+				findBorderProcs(octant, procs);
+				if(!kept[idx]){
+					set<int>::iterator pitend = procs.end();
+					for(set<int>::iterator pit = procs.begin(); pit != pitend; ++pit){
+						if(*pit != rank){
+							newIdx[*pit].push_back(idx);
 						}
-						lh -= partition[p];
-						headSize = lh + 1;
 					}
 				}
-
 			}
-			//build send buffers from Tail
-			if(tailSize != 0){
-				for(int p = firstSuccessor; p < nproc; ++p){
-					if(tailSize <= partition[p]){
-						int buffSize = tailSize * (int)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8));
-						sendBuffers[p] = Class_Comm_Buffer(buffSize,'a',comm);
-						int pos = 0;
-						uint32_t octantsSize = (uint32_t)octree.octants.size();
-						for(uint32_t i = ft; i < octantsSize; ++i){
-							//PACK octants from ft to octantsSize-1
-							const Class_Octant<2> & octant = octree.octants[i];
-							x = octant.getX();
-							y = octant.getY();
-							l = octant.getLevel();
-							m = octant.getMarker();
-							for(int i = 0; i < 12; ++i)
-								info[i] = octant.info[i];
-							error_flag = MPI_Pack(&x,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&y,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&l,1,MPI_UINT8_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&m,1,MPI_INT8_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							for(int j = 0; j < 12; ++j){
-								MPI_Pack(&info[j],1,MPI::BOOL,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							}
+		}
+
+		//MERGE KEPT AND NEW BORDER OCTANTS
+		//the patch to be sent to each neighbor is made of runs of kept ghosts (position in the old and new list,
+		//length and shift of global index) and of border octants to be sent in full (new or with modified marker/info)
+		bordersPerProc.clear();
+		map<int,vector<uint32_t> > runs;
+		map<int,vector<int64_t> > runsDelta;
+		map<int,vector<uint32_t> > fulls;
+		uint64_t globalOffset = (rank != 0) * (partition_range_globalidx[max(rank-1,0)] + 1);
+		set<int> neighbors;
+		for(map<int,vector<uint32_t> >::iterator kit = keptIdx.begin(); kit != keptIdx.end(); ++kit)
+			neighbors.insert(kit->first);
+		for(map<int,vector<uint32_t> >::iterator nit = newIdx.begin(); nit != newIdx.end(); ++nit)
+			neighbors.insert(nit->first);
+		for(set<int>::iterator pit = neighbors.begin(); pit != neighbors.end(); ++pit){
+			int p = *pit;
+			const vector<uint32_t> & kidx = keptIdx[p];
+			const vector<uint32_t> & kpos = keptPos[p];
+			const vector<uint32_t> & nidx = newIdx[p];
+			const vector<Class_Octant<2> > & saved = savedBorders[p];
+			const vector<uint32_t> & savedIdx = savedBordersPerProc[p];
+			vector<uint32_t> & borders = bordersPerProc[p];
+			vector<uint32_t> & prun = runs[p];
+			vector<int64_t> & pdelta = runsDelta[p];
+			vector<uint32_t> & pfull = fulls[p];
+			borders.reserve(kidx.size() + nidx.size());
+			uint32_t ik = 0, in = 0;
+			while(ik < kidx.size() || in < nidx.size()){
+				uint32_t newPos = borders.size();
+				if(in == nidx.size() || (ik < kidx.size() && kidx[ik] < nidx[in])){
+					const Class_Octant<2> & octant = octree.octants[kidx[ik]];
+					const Class_Octant<2> & old = saved[kpos[ik]];
+					borders.push_back(kidx[ik]);
+					if(octant.getMarker() == old.getMarker() && octant.info == old.info){
+						int64_t delta = (int64_t)(globalOffset + kidx[ik]) - (int64_t)(savedGlobalOffset + savedIdx[kpos[ik]]);
+						uint32_t nruns = prun.size()/3;
+						if(nruns && pdelta[nruns-1] == delta
+								&& prun[3*nruns-3] + prun[3*nruns-1] == kpos[ik]
+								&& prun[3*nruns-2] + prun[3*nruns-1] == newPos){
+							++prun[3*nruns-1];
+						}
+						else{
+							prun.push_back(kpos[ik]);
+							prun.push_back(newPos);
+							prun.push_back(1);
+							pdelta.push_back(delta);
 						}
-						break;
 					}
 					else{
-						int buffSize = partition[p] * (int)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8));
-						sendBuffers[p] = Class_Comm_Buffer(buffSize,'a',comm);
-						uint32_t endOctants = ft + partition[p] - 1;
-						int pos = 0;
-						for(uint32_t i = ft; i <= endOctants; ++i ){
-							//PACK octants from ft to ft + partition[p] -1
-							const Class_Octant<2> & octant = octree.octants[i];
-							x = octant.getX();
-							y = octant.getY();
-							l = octant.getLevel();
-							m = octant.getMarker();
-							for(int i = 0; i < 12; ++i)
-								info[i] = octant.info[i];
-							error_flag = MPI_Pack(&x,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&y,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&l,1,MPI_UINT8_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&m,1,MPI_INT8_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							for(int j = 0; j < 12; ++j){
-								MPI_Pack(&info[j],1,MPI::BOOL,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							}
-						}
-						ft += partition[p];
-						tailSize -= partition[p];
+						pfull.push_back(newPos);
 					}
+					++ik;
 				}
-			}
-
-			//Build receiver sources
-			vector<Class_Array> recvs(nproc);
-			recvs[rank] = Class_Array((uint32_t)sendBuffers.size()+1,-1);
-			recvs[rank].array[0] = rank;
-			int counter = 1;
-			map<int,Class_Comm_Buffer>::iterator sitend = sendBuffers.end();
-			for(map<int,Class_Comm_Buffer>::iterator sit = sendBuffers.begin(); sit != sitend; ++sit){
-				recvs[rank].array[counter] = sit->first;
-				++counter;
-			}
-			int* nofRecvsPerProc = new int[nproc];
-			error_flag = MPI_Allgather(&recvs[rank].arraySize,1,MPI_INT,nofRecvsPerProc,1,MPI_INT,comm);
-			int globalRecvsBuffSize = 0;
-			int* displays = new int[nproc];
-			for(int pp = 0; pp < nproc; ++pp){
-				displays[pp] = 0;
-				globalRecvsBuffSize += nofRecvsPerProc[pp];
-				for(int ppp = 0; ppp < pp; ++ppp){
-					displays[pp] += nofRecvsPerProc[ppp];
-				}
-			}
-			int* globalRecvsBuff = new int[globalRecvsBuffSize];
-			error_flag = MPI_Allgatherv(recvs[rank].array,recvs[rank].arraySize,MPI_INT,globalRecvsBuff,nofRecvsPerProc,displays,MPI_INT,comm);
-
-			vector<set<int> > sendersPerProc(nproc);
-			for(int pin = 0; pin < nproc; ++pin){
-				for(int k = displays[pin]+1; k < displays[pin] + nofRecvsPerProc[pin]; ++k){
-					sendersPerProc[globalRecvsBuff[k]].insert(globalRecvsBuff[displays[pin]]);
+				else{
+					borders.push_back(nidx[in]);
+					pfull.push_back(newPos);
+					++in;
 				}
 			}
+		}
 
-			//Communicate Octants (size)
-			MPI_Request* req = new MPI_Request[sendBuffers.size()+sendersPerProc[rank].size()];
-			MPI_Status* stats = new MPI_Status[sendBuffers.size()+sendersPerProc[rank].size()];
-			int nReq = 0;
-			map<int,int> recvBufferSizePerProc;
-			set<int>::iterator senditend = sendersPerProc[rank].end();
-			for(set<int>::iterator sendit = sendersPerProc[rank].begin(); sendit != senditend; ++sendit){
-				recvBufferSizePerProc[*sendit] = 0;
-				error_flag = MPI_Irecv(&recvBufferSizePerProc[*sendit],1,MPI_UINT32_T,*sendit,rank,comm,&req[nReq]);
-				++nReq;
-			}
-			map<int,Class_Comm_Buffer>::reverse_iterator rsitend = sendBuffers.rend();
-			for(map<int,Class_Comm_Buffer>::reverse_iterator rsit = sendBuffers.rbegin(); rsit != rsitend; ++rsit){
-				error_flag =  MPI_Isend(&rsit->second.commBufferSize,1,MPI_UINT32_T,rsit->first,rsit->first,comm,&req[nReq]);
-				++nReq;
-			}
-			MPI_Waitall(nReq,req,stats);
-
-			//COMMUNICATE THE BUFFERS TO THE RECEIVERS
-			//recvBuffers structure is declared and each buffer is initialized to the right size
-			//then, sendBuffers are communicated by senders and stored in recvBuffers in the receivers
-			uint32_t nofNewHead = 0;
-			uint32_t nofNewTail = 0;
-			map<int,Class_Comm_Buffer> recvBuffers;
-			map<int,int>::iterator ritend = recvBufferSizePerProc.end();
-			for(map<int,int>::iterator rit = recvBufferSizePerProc.begin(); rit != ritend; ++rit){
-				recvBuffers[rit->first] = Class_Comm_Buffer(rit->second,'a',comm);
-				uint32_t nofNewPerProc = (uint32_t)(rit->second / (uint32_t)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8)));
-				if(rit->first < rank)
-					nofNewHead += nofNewPerProc;
-				else if(rit->first > rank)
-					nofNewTail += nofNewPerProc;
-			}
-			nReq = 0;
-			for(set<int>::iterator sendit = sendersPerProc[rank].begin(); sendit != senditend; ++sendit){
-				//nofBytesOverProc += recvBuffers[sit->first].commBufferSize;
-				error_flag = MPI_Irecv(recvBuffers[*sendit].commBuffer,recvBuffers[*sendit].commBufferSize,MPI_PACKED,*sendit,rank,comm,&req[nReq]);
-				++nReq;
-			}
-			for(map<int,Class_Comm_Buffer>::reverse_iterator rsit = sendBuffers.rbegin(); rsit != rsitend; ++rsit){
-				error_flag =  MPI_Isend(rsit->second.commBuffer,rsit->second.commBufferSize,MPI_PACKED,rsit->first,rsit->first,comm,&req[nReq]);
-				++nReq;
-			}
-			MPI_Waitall(nReq,req,stats);
+		//CHECK THE NEIGHBOR PROCESSES
+		//the single reduction of updateNeighborComm checks the neighbors of all the processes:
+		//if any of them are changed the graph communicator is rebuilt and the complete ghost layer is communicated
+		if(updateNeighborComm()){
+			commGhosts();
+			return;
+		}
+		map<int,vector<uint32_t> >::iterator bitend = bordersPerProc.end();
 
-			//MOVE RESIDENT TO BEGIN IN OCTANTS
-			uint32_t resEnd = octree.getNumOctants() - tailOffset;
-			uint32_t nofResidents = resEnd - headOffset;
-			int octCounter = 0;
-			for(uint32_t i = headOffset; i < resEnd; ++i){
-				octree.octants[octCounter] = octree.octants[i];
-				++octCounter;
-			}
-			uint32_t newCounter = nofNewHead + nofNewTail + nofResidents;
-			octree.octants.resize(newCounter);
-			//MOVE RESIDENTS IN RIGHT POSITION
-			uint32_t resCounter = nofNewHead + nofResidents - 1;
-			for(uint32_t k = 0; k < nofResidents ; ++k){
-				octree.octants[resCounter - k] = octree.octants[nofResidents - k - 1];
-			}
+		//PACK THE PATCHES OF THE GHOST LAYER
+		uint64_t global_index;
+		map<int,Class_Comm_Buffer> sendBuffers;
+		for(map<int,vector<uint32_t> >::iterator bit = bordersPerProc.begin(); bit != bitend; ++bit){
+			int key = bit->first;
+			uint32_t nofRuns = runs[key].size()/3;
+			uint32_t nofFulls = fulls[key].size();
+			int buffSize = 2*sizeof(uint32_t) + nofRuns*(3*sizeof(uint32_t) + sizeof(int64_t))
+					+ nofFulls*(sizeof(uint32_t) + global2D.octantBytes + global2D.globalIndexBytes);
+			sendBuffers[key] = getPoolBuffer(buffSize);
+			sendBuffers[key].write(nofRuns);
+			sendBuffers[key].write(nofFulls);
+			if(nofRuns){
+				sendBuffers[key].write(&runs[key][0],3*nofRuns);
+				sendBuffers[key].write(&runsDelta[key][0],nofRuns);
+			}
+			for(uint32_t i = 0; i < nofFulls; ++i){
+				uint32_t newPos = fulls[key][i];
+				sendBuffers[key].write(newPos);
+				sendBuffers[key].write(octree.octants[bit->second[newPos]].getWire());
+				sendBuffers[key].write(getGlobalIdx(bit->second[newPos]));
+			}
+		}
+
+		//COMMUNICATE THE PATCHES TO THE NEIGHBOR PROCESSES
+		//the neighbors are unchanged, so the graph communicator of the last ghost layer update is still valid
+		map<int,Class_Comm_Buffer> recvBuffers;
+		commNeighbors(sendBuffers,recvBuffers);
 
-			//UNPACK BUFFERS AND BUILD NEW OCTANTS
-			newCounter = 0;
-			bool jumpResident = false;
-			map<int,Class_Comm_Buffer>::iterator rbitend = recvBuffers.end();
-			for(map<int,Class_Comm_Buffer>::iterator rbit = recvBuffers.begin(); rbit != rbitend; ++rbit){
-				uint32_t nofNewPerProc = (uint32_t)(rbit->second.commBufferSize / (uint32_t)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8)));
-				int pos = 0;
-				if(rbit->first > rank && !jumpResident){
-					newCounter += nofResidents ;
-					jumpResident = true;
-				}
-				for(int i = nofNewPerProc - 1; i >= 0; --i){
-					error_flag = MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&pos,&x,1,MPI_UINT32_T,comm);
-					error_flag = MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&pos,&y,1,MPI_UINT32_T,comm);
-					error_flag = MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&pos,&l,1,MPI_UINT8_T,comm);
-					octree.octants[newCounter] = Class_Octant<2>(l,x,y);
-					error_flag = MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&pos,&m,1,MPI_INT8_T,comm);
-					octree.octants[newCounter].setMarker(m);
-					for(int j = 0; j < 12; ++j){
-						error_flag = MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&pos,&info[j],1,MPI::BOOL,comm);
-						octree.octants[newCounter].info[j] = info[j];
-					}
-					++newCounter;
+		//APPLY THE PATCHES AND BUILD THE NEW GHOSTS CONTAINER OF CLASS_LOCAL_TREE
+		//the ghosts of every neighbor process are contiguous and ordered as the border octants of the sender
+		Class_Local_Tree<2>::OctantsType ghosts;
+		vector<uint64_t> globalidx_ghosts;
+		uint32_t oldOffset = 0;
+		map<int,Class_Comm_Buffer>::iterator rritend = recvBuffers.end();
+		for(map<int,Class_Comm_Buffer>::iterator rrit = recvBuffers.begin(); rrit != rritend; ++rrit){
+			uint32_t nofRuns, nofFulls, nofGhostsPerProc;
+			rrit->second.read(nofRuns);
+			rrit->second.read(nofFulls);
+			vector<uint32_t> prun(3*nofRuns);
+			vector<int64_t> pdelta(nofRuns);
+			if(nofRuns){
+				rrit->second.read(&prun[0],3*nofRuns);
+				rrit->second.read(&pdelta[0],nofRuns);
+			}
+			nofGhostsPerProc = nofFulls;
+			for(uint32_t r = 0; r < nofRuns; ++r)
+				nofGhostsPerProc += prun[3*r+2];
+			uint32_t newOffset = ghosts.size();
+			ghosts.resize(newOffset + nofGhostsPerProc);
+			globalidx_ghosts.resize(newOffset + nofGhostsPerProc);
+			for(uint32_t r = 0; r < nofRuns; ++r){
+				for(uint32_t i = 0; i < prun[3*r+2]; ++i){
+					ghosts[newOffset + prun[3*r+1] + i] = octree.ghosts[oldOffset + prun[3*r] + i];
+					globalidx_ghosts[newOffset + prun[3*r+1] + i] = octree.globalidx_ghosts[oldOffset + prun[3*r] + i] + pdelta[r];
 				}
 			}
-			octree.octants.shrink_to_fit();
+			for(uint32_t i = 0; i < nofFulls; ++i){
+				uint32_t newPos;
+				rrit->second.read(newPos);
+				Class_Octant<2>::Wire wire;
+				rrit->second.read(wire);
+				ghosts[newOffset + newPos] = Class_Octant<2>(wire);
+				rrit->second.read(global_index);
+				globalidx_ghosts[newOffset + newPos] = global_index;
+			}
+			oldOffset += ghostsPerProc[rrit->first];
+			ghostsPerProc[rrit->first] = nofGhostsPerProc;
+		}
+		octree.ghosts.swap(ghosts);
+		octree.globalidx_ghosts.swap(globalidx_ghosts);
+		octree.size_ghosts = octree.ghosts.size();
+		releasePoolBuffers(recvBuffers);
+		releasePoolBuffers(sendBuffers);
+
+		saveGhostsState();
+	}
 
-			delete [] newPartitionRangeGlobalidx; newPartitionRangeGlobalidx = NULL;
-			delete [] nofRecvsPerProc; nofRecvsPerProc = NULL;
-			delete [] displays; displays = NULL;
-			delete [] req; req = NULL;
-			delete [] stats; stats = NULL;
-			delete [] globalRecvsBuff; globalRecvsBuff = NULL;
-			//Update and ghosts here
-			updateLoadBalance();
-			setPboundGhosts();
+	// =============================================================================== //
 
-		}
+public:
+	/** Distribute Load-Balancing the octants of the whole tree over
+	 * the processes of the job following the Morton order.
+	 * Until loadBalance is not called for the first time the mesh is serial.
+	 * If the cost tracking is enabled (see enableCostTracking) the partition is weighted by the measured octant costs.
+	 */
+	void loadBalance(){
+		if(!updateActiveProcs())
+			return;
+		uint32_t* partition = new uint32_t [nproc];
+		computeCostPartition(partition);
+		migrateOctants(partition);
 		delete [] partition;
 		partition = NULL;
-
-		//Write info of final partition on log
-		log.writeLog(" ");
-		log.writeLog(" Final Parallel partition : ");
-		log.writeLog(" Octants for proc	"+ to_string(0)+"	:	" + to_string(partition_range_globalidx[0]+1));
-		for(int ii=1; ii<nproc; ii++){
-			log.writeLog(" Octants for proc	"+ to_string(ii)+"	:	" + to_string(partition_range_globalidx[ii]-partition_range_globalidx[ii-1]));
-		}
-		log.writeLog(" ");
-		log.writeLog("---------------------------------------------");
-
 	}
 
 	// =============================================================================== //
@@ -2784,386 +3592,310 @@ public:
 	 * \param[in] level Number of level over the max depth reached in the tree at which families of octants are fixed compact on the same process (level=0 is classic LoadBalance).
 	 */
 	void loadBalance(uint8_t & level){
+		if(!updateActiveProcs())
+			return;
+		uint32_t* partition = new uint32_t [nproc];
+		computePartition(partition, level);
+		migrateOctants(partition);
+		delete [] partition;
+		partition = NULL;
+	}
 
-		//Write info on log
-		log.writeLog("---------------------------------------------");
-		log.writeLog(" LOAD BALANCE ");
+	// =============================================================================== //
 
+	/** Distribute Load-Balancing the octants of the whole tree and data provided by the user
+	 * over the processes of the job following the Morton order.
+	 * Until loadBalance is not called for the first time the mesh is serial.
+	 * If the cost tracking is enabled (see enableCostTracking) the partition is weighted by the measured octant costs.
+	 */
+	template<class Impl>
+	void loadBalance(Class_Data_LB_Interface<Impl> & userData){
+		if(!updateActiveProcs(userData))
+			return;
+		uint32_t* partition = new uint32_t [nproc];
+		computeCostPartition(partition);
+		migrateOctants(partition, userData);
+		delete [] partition;
+		partition = NULL;
+	}
+
+	// =============================================================================== //
+
+	/** Distribute Load-Balanced the octants of the whole tree and data provided by the user
+	 * over the processes of the job. Until loadBalance is not called for the first time the mesh is serial.
+	 * The families of octants of a desired level are retained compact on the same process.
+	 * \param[in] level Number of level over the max depth reached in the tree at which families of octants are fixed compact on the same process (level=0 is classic LoadBalance).
+	 */
+	template<class Impl>
+	void loadBalance(Class_Data_LB_Interface<Impl> & userData, uint8_t & level){
+		if(!updateActiveProcs(userData))
+			return;
 		uint32_t* partition = new uint32_t [nproc];
 		computePartition(partition, level);
-		if(serial)
-		{
-			log.writeLog(" ");
-			log.writeLog(" Initial Serial distribution : ");
-			for(int ii=0; ii<nproc; ii++){
-				log.writeLog(" Octants for proc	"+ to_string(ii)+"	:	" + to_string(partition_range_globalidx[ii]+1));
-			}
+		migrateOctants(partition, userData);
+		delete [] partition;
+		partition = NULL;
+	}
 
-			uint32_t stride = 0;
-			for(int i = 0; i < rank; ++i)
-				stride += partition[i];
-			Class_Local_Tree<2>::OctantsType octantsCopy = octree.octants;
-			Class_Local_Tree<2>::OctantsType::const_iterator first = octantsCopy.begin() + stride;
-			Class_Local_Tree<2>::OctantsType::const_iterator last = first + partition[rank];
-			octree.octants.assign(first, last);
-			octree.octants.shrink_to_fit();
-			first = octantsCopy.end();
-			last = octantsCopy.end();
+	// =============================================================================== //
 
-			//Update and ghosts here
-			updateLoadBalance();
-			setPboundGhosts();
+	/** Distribute Load-Balancing the octants of the whole tree over the processes of the job
+	 * following the Morton order, with a computational cost for every octant: the partition
+	 * gives every process an equal share of the total weight.
+	 * Until loadBalance is not called for the first time the mesh is serial.
+	 * If the active processes are shrunk (see setShrinkThreshold) the weights move with the octants.
+	 * \param[in] weights Non negative weight of every local octant (same ordering of the octants).
+	 */
+	void loadBalance(const dvector & weights){
+		dvector localWeights(weights);
+		Class_Data_Fields weightData;
+		weightData.addField<ADAPT_COPY>(localWeights);
+		if(!updateActiveProcs(weightData))
+			return;
+		uint32_t* partition = new uint32_t [nproc];
+		double imbalanceBefore = computeImbalance(localWeights);
+		double imbalanceAfter = computePartition(partition, localWeights);
+		migrateOctants(partition);
+		delete [] partition;
+		partition = NULL;
 
-		}
+		//Write weighted imbalance on log
+		log.writeLog(" Weighted imbalance (max/mean weight per process) before load balance : " + to_string(imbalanceBefore));
+		log.writeLog(" Weighted imbalance (max/mean weight per process) after load balance  : " + to_string(imbalanceAfter));
+		log.writeLog("---------------------------------------------");
+	}
+
+	// =============================================================================== //
+
+	/** Distribute Load-Balancing the octants of the whole tree and data provided by the user
+	 * over the processes of the job following the Morton order, with a computational cost for
+	 * every octant: the partition gives every process an equal share of the total weight.
+	 * Until loadBalance is not called for the first time the mesh is serial.
+	 * If the active processes are shrunk (see setShrinkThreshold) the weights move with the octants and the user data.
+	 * \param[in] weights Non negative weight of every local octant (same ordering of the octants).
+	 */
+	template<class Impl>
+	void loadBalance(Class_Data_LB_Interface<Impl> & userData, const dvector & weights){
+		dvector localWeights(weights);
+		Class_Data_Fields weightData;
+		weightData.addField<ADAPT_COPY>(localWeights);
+		Class_Data_Pair<Impl,Class_Data_Fields> pairData(static_cast<Impl&>(userData), weightData);
+		if(!updateActiveProcs(pairData))
+			return;
+		uint32_t* partition = new uint32_t [nproc];
+		double imbalanceBefore = computeImbalance(localWeights);
+		double imbalanceAfter = computePartition(partition, localWeights);
+		migrateOctants(partition, userData);
+		delete [] partition;
+		partition = NULL;
+
+		//Write weighted imbalance on log
+		log.writeLog(" Weighted imbalance (max/mean weight per process) before load balance : " + to_string(imbalanceBefore));
+		log.writeLog(" Weighted imbalance (max/mean weight per process) after load balance  : " + to_string(imbalanceAfter));
+		log.writeLog("---------------------------------------------");
+	}
+
+	// =============================================================================== //
+
+	/** Distribute Load-Balancing the octants of the whole tree over the processes of the job
+	 * following the Morton order, moving the partition boundaries only as much as needed to keep
+	 * the load of every process under a tolerance over the mean load (incremental load balance):
+	 * after a small adapt only the processes out of tolerance exchange octants.
+	 * The load is the measured cost of the octants if the cost tracking is enabled
+	 * (see enableCostTracking), otherwise the number of octants.
+	 * The global number of migrated octants and bytes is written on the log.
+	 * Until loadBalance is not called for the first time the mesh is serial, a serial mesh
+	 * is distributed by the even partition.
+	 * \param[in] tolerance Accepted imbalance over the mean load (e.g. 0.05 accepts up to 1.05 times the mean load on a process).
+	 */
+	void loadBalance(double tolerance){
+		if(!updateActiveProcs())
+			return;
+		uint32_t* partition = new uint32_t [nproc];
+		if(serial)
+			computeCostPartition(partition);
 		else
-		{
-			log.writeLog(" ");
-			log.writeLog(" Initial Parallel partition : ");
-			log.writeLog(" Octants for proc	"+ to_string(0)+"	:	" + to_string(partition_range_globalidx[0]+1));
-			for(int ii=1; ii<nproc; ii++){
-				log.writeLog(" Octants for proc	"+ to_string(ii)+"	:	" + to_string(partition_range_globalidx[ii]-partition_range_globalidx[ii-1]));
-			}
+			computeTolerancePartition(partition, tolerance);
+		migrateOctants(partition);
+		delete [] partition;
+		partition = NULL;
+		writeMigration();
+	}
 
-			//empty ghosts
-			octree.ghosts.clear();
-			octree.size_ghosts = 0;
-			//compute new partition range globalidx
-			uint64_t* newPartitionRangeGlobalidx = new uint64_t[nproc];
-			for(int p = 0; p < nproc; ++p){
-				newPartitionRangeGlobalidx[p] = 0;
-				for(int pp = 0; pp <= p; ++pp)
-					newPartitionRangeGlobalidx[p] += (uint64_t)partition[pp];
-				--newPartitionRangeGlobalidx[p];
-			}
+	// =============================================================================== //
 
-			//find resident octants local offset lastHead(lh) and firstTail(ft)
-			int32_t lh,ft;
-			if(rank == 0)
-				lh = -1;
-			else{
-				lh = (int32_t)(newPartitionRangeGlobalidx[rank-1] + 1 - partition_range_globalidx[rank-1] - 1 - 1);
-			}
-			if(lh < 0)
-				lh = - 1;
-			else if(lh > (int32_t)(octree.octants.size() - 1))
-				lh = octree.octants.size() - 1;
-
-			if(rank == nproc - 1)
-				ft = octree.octants.size();
-			else if(rank == 0)
-				ft = (int32_t)(newPartitionRangeGlobalidx[rank] + 1);
-			else{
-				ft = (int32_t)(newPartitionRangeGlobalidx[rank] - partition_range_globalidx[rank -1]);
-			}
-			if(ft > (int32_t)(octree.octants.size() - 1))
-				ft = octree.octants.size();
-			else if(ft < 0)
-				ft = 0;
-
-			//compute size Head and size Tail
-			uint32_t headSize = (uint32_t)(lh + 1);
-			uint32_t tailSize = (uint32_t)(octree.octants.size() - ft);
-			uint32_t headOffset = headSize;
-			uint32_t tailOffset = tailSize;
-
-			//build send buffers
-			map<int,Class_Comm_Buffer> sendBuffers;
+	/** Distribute Load-Balancing the octants of the whole tree and data provided by the user
+	 * over the processes of the job following the Morton order, moving the partition boundaries
+	 * only as much as needed to keep the load of every process under a tolerance over the mean
+	 * load (see loadBalance(double)).
+	 * \param[in] tolerance Accepted imbalance over the mean load (e.g. 0.05 accepts up to 1.05 times the mean load on a process).
+	 */
+	template<class Impl>
+	void loadBalance(Class_Data_LB_Interface<Impl> & userData, double tolerance){
+		if(!updateActiveProcs(userData))
+			return;
+		uint32_t* partition = new uint32_t [nproc];
+		if(serial)
+			computeCostPartition(partition);
+		else
+			computeTolerancePartition(partition, tolerance);
+		migrateOctants(partition, userData);
+		delete [] partition;
+		partition = NULL;
+		writeMigration();
+	}
 
-			//Compute first predecessor and first successor to send buffers to
-			int64_t firstOctantGlobalIdx = 0;// offset to compute global index of each octant in every process
-			int64_t globalLastHead = (int64_t) lh;
-			int64_t globalFirstTail = (int64_t) ft; //lastHead and firstTail in global ordering
-			int firstPredecessor = -1;
-			int firstSuccessor = nproc;
-			if(rank != 0){
-				firstOctantGlobalIdx = (int64_t)(partition_range_globalidx[rank-1] + 1);
-				globalLastHead = firstOctantGlobalIdx + (int64_t)lh;
-				globalFirstTail = firstOctantGlobalIdx + (int64_t)ft;
-				for(int pre = rank - 1; pre >=0; --pre){
-					if((uint64_t)globalLastHead <= newPartitionRangeGlobalidx[pre])
-						firstPredecessor = pre;
-				}
-				for(int post = rank + 1; post < nproc; ++post){
-					if((uint64_t)globalFirstTail <= newPartitionRangeGlobalidx[post] && (uint64_t)globalFirstTail > newPartitionRangeGlobalidx[post-1])
-						firstSuccessor = post;
-				}
-			}
-			else if(rank == 0){
-				firstSuccessor = 1;
-			}
-			MPI_Barrier(comm); //da spostare prima della prima comunicazione
-
-			uint32_t x,y;
-			uint8_t l;
-			int8_t m;
-			bool info[12];
-			//build send buffers from Head
-			if(headSize != 0){
-				for(int p = firstPredecessor; p >= 0; --p){
-					if(headSize <=partition[p]){
-						int buffSize = headSize * (int)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8));
-						sendBuffers[p] = Class_Comm_Buffer(buffSize,'a',comm);
-						int pos = 0;
-						for(uint32_t i = 0; i <= (uint32_t)lh; ++i){
-							//PACK octants from 0 to lh in sendBuffer[p]
-							const Class_Octant<2> & octant = octree.octants[i];
-							x = octant.getX();
-							y = octant.getY();
-							l = octant.getLevel();
-							m = octant.getMarker();
-							for(int i = 0; i < 12; ++i)
-								info[i] = octant.info[i];
-							error_flag = MPI_Pack(&x,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&y,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&l,1,MPI_UINT8_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&m,1,MPI_INT8_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							for(int j = 0; j < 12; ++j){
-								MPI_Pack(&info[j],1,MPI::BOOL,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							}
-						}
-						break;
-					}
-					else{
-						int buffSize = partition[p] * (int)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8));
-						sendBuffers[p] = Class_Comm_Buffer(buffSize,'a',comm);
-						int pos = 0;
-						for(uint32_t i = (uint32_t)(lh - partition[p] + 1); i <= (uint32_t)lh; ++i){
-							//pack octants from lh - partition[p] to lh
-							const Class_Octant<2> & octant = octree.octants[i];
-							x = octant.getX();
-							y = octant.getY();
-							l = octant.getLevel();
-							m = octant.getMarker();
-							for(int i = 0; i < 12; ++i)
-								info[i] = octant.info[i];
-							error_flag = MPI_Pack(&x,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&y,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&l,1,MPI_UINT8_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&m,1,MPI_INT8_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							for(int j = 0; j < 12; ++j){
-								MPI_Pack(&info[j],1,MPI::BOOL,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							}
-						}
-						lh -= partition[p];
-						headSize = lh + 1;
-					}
-				}
+	// =============================================================================== //
 
-			}
-			//build send buffers from Tail
-			if(tailSize != 0){
-				for(int p = firstSuccessor; p < nproc; ++p){
-					if(tailSize <= partition[p]){
-						int buffSize = tailSize * (int)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8));
-						sendBuffers[p] = Class_Comm_Buffer(buffSize,'a',comm);
-						int pos = 0;
-						uint32_t octantsSize = (uint32_t)octree.octants.size();
-						for(uint32_t i = ft; i < octantsSize; ++i){
-							//PACK octants from ft to octantsSize-1
-							const Class_Octant<2> & octant = octree.octants[i];
-							x = octant.getX();
-							y = octant.getY();
-							l = octant.getLevel();
-							m = octant.getMarker();
-							for(int i = 0; i < 12; ++i)
-								info[i] = octant.info[i];
-							error_flag = MPI_Pack(&x,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&y,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&l,1,MPI_UINT8_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&m,1,MPI_INT8_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							for(int j = 0; j < 12; ++j){
-								MPI_Pack(&info[j],1,MPI::BOOL,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							}
-						}
-						break;
-					}
-					else{
-						int buffSize = partition[p] * (int)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8));
-						sendBuffers[p] = Class_Comm_Buffer(buffSize,'a',comm);
-						uint32_t endOctants = ft + partition[p] - 1;
-						int pos = 0;
-						for(uint32_t i = ft; i <= endOctants; ++i ){
-							//PACK octants from ft to ft + partition[p] -1
-							const Class_Octant<2> & octant = octree.octants[i];
-							x = octant.getX();
-							y = octant.getY();
-							l = octant.getLevel();
-							m = octant.getMarker();
-							for(int i = 0; i < 12; ++i)
-								info[i] = octant.info[i];
-							error_flag = MPI_Pack(&x,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&y,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&l,1,MPI_UINT8_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							error_flag = MPI_Pack(&m,1,MPI_INT8_T,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							for(int j = 0; j < 12; ++j){
-								MPI_Pack(&info[j],1,MPI::BOOL,sendBuffers[p].commBuffer,buffSize,&pos,comm);
-							}
-						}
-						ft += partition[p];
-						tailSize -= partition[p];
-					}
-				}
-			}
+	/** Distribute Load-Balancing the octants of the whole tree over the processes of the job
+	 * following the Morton order, before the adapt set by the markers (predictive load balance):
+	 * every octant is weighted by its predicted load after adapt, 4^marker times its load
+	 * (measured cost if the cost tracking is enabled, otherwise one). The fathers are distributed
+	 * before their children are created, so the migrated octants are fewer and no process holds
+	 * the children of a region that it would send away.
+	 * The markers are 2:1 balanced and migrated with the octants: adapt has to be called after it.
+	 * Until loadBalance is not called for the first time the mesh is serial.
+	 */
+	void loadBalanceMarkers(){
+		if(!updateActiveProcs())
+			return;
+		dvector weights;
+		computeMarkerWeights(weights);
+		loadBalance(weights);
+	}
 
-			//Build receiver sources
-			vector<Class_Array> recvs(nproc);
-			recvs[rank] = Class_Array((uint32_t)sendBuffers.size()+1,-1);
-			recvs[rank].array[0] = rank;
-			int counter = 1;
-			map<int,Class_Comm_Buffer>::iterator sitend = sendBuffers.end();
-			for(map<int,Class_Comm_Buffer>::iterator sit = sendBuffers.begin(); sit != sitend; ++sit){
-				recvs[rank].array[counter] = sit->first;
-				++counter;
-			}
-			int* nofRecvsPerProc = new int[nproc];
-			error_flag = MPI_Allgather(&recvs[rank].arraySize,1,MPI_INT,nofRecvsPerProc,1,MPI_INT,comm);
-			int globalRecvsBuffSize = 0;
-			int* displays = new int[nproc];
-			for(int pp = 0; pp < nproc; ++pp){
-				displays[pp] = 0;
-				globalRecvsBuffSize += nofRecvsPerProc[pp];
-				for(int ppp = 0; ppp < pp; ++ppp){
-					displays[pp] += nofRecvsPerProc[ppp];
-				}
-			}
-			int* globalRecvsBuff = new int[globalRecvsBuffSize];
-			error_flag = MPI_Allgatherv(recvs[rank].array,recvs[rank].arraySize,MPI_INT,globalRecvsBuff,nofRecvsPerProc,displays,MPI_INT,comm);
+	// =============================================================================== //
 
-			vector<set<int> > sendersPerProc(nproc);
-			for(int pin = 0; pin < nproc; ++pin){
-				for(int k = displays[pin]+1; k < displays[pin] + nofRecvsPerProc[pin]; ++k){
-					sendersPerProc[globalRecvsBuff[k]].insert(globalRecvsBuff[displays[pin]]);
-				}
-			}
+	/** Distribute Load-Balancing the octants of the whole tree and data provided by the user
+	 * over the processes of the job following the Morton order, before the adapt set by the
+	 * markers (see loadBalanceMarkers()).
+	 */
+	template<class Impl>
+	void loadBalanceMarkers(Class_Data_LB_Interface<Impl> & userData){
+		if(!updateActiveProcs(userData))
+			return;
+		dvector weights;
+		computeMarkerWeights(weights);
+		loadBalance(userData, weights);
+	}
+
+	// =============================================================================== //
+
+	/** Get the number of local octants sent to other processes by the last load balance.
+	 * \return Number of migrated octants of the local process.
+	 */
+	uint64_t getMigratedOctants() const{
+		return migratedOctants;
+	}
+
+	// =============================================================================== //
 
-			//Communicate Octants (size)
-			MPI_Request* req = new MPI_Request[sendBuffers.size()+sendersPerProc[rank].size()];
-			MPI_Status* stats = new MPI_Status[sendBuffers.size()+sendersPerProc[rank].size()];
-			int nReq = 0;
-			map<int,int> recvBufferSizePerProc;
-			set<int>::iterator senditend = sendersPerProc[rank].end();
-			for(set<int>::iterator sendit = sendersPerProc[rank].begin(); sendit != senditend; ++sendit){
-				recvBufferSizePerProc[*sendit] = 0;
-				error_flag = MPI_Irecv(&recvBufferSizePerProc[*sendit],1,MPI_UINT32_T,*sendit,rank,comm,&req[nReq]);
-				++nReq;
-			}
-			map<int,Class_Comm_Buffer>::reverse_iterator rsitend = sendBuffers.rend();
-			for(map<int,Class_Comm_Buffer>::reverse_iterator rsit = sendBuffers.rbegin(); rsit != rsitend; ++rsit){
-				error_flag =  MPI_Isend(&rsit->second.commBufferSize,1,MPI_UINT32_T,rsit->first,rsit->first,comm,&req[nReq]);
-				++nReq;
-			}
-			MPI_Waitall(nReq,req,stats);
+	/** Get the number of bytes (octants and user data) sent to other processes by the last load balance.
+	 * \return Number of migrated bytes of the local process.
+	 */
+	uint64_t getMigratedBytes() const{
+		return migratedBytes;
+	}
 
-			//COMMUNICATE THE BUFFERS TO THE RECEIVERS
-			//recvBuffers structure is declared and each buffer is initialized to the right size
-			//then, sendBuffers are communicated by senders and stored in recvBuffers in the receivers
-			uint32_t nofNewHead = 0;
-			uint32_t nofNewTail = 0;
-			map<int,Class_Comm_Buffer> recvBuffers;
-			map<int,int>::iterator ritend = recvBufferSizePerProc.end();
-			for(map<int,int>::iterator rit = recvBufferSizePerProc.begin(); rit != ritend; ++rit){
-				recvBuffers[rit->first] = Class_Comm_Buffer(rit->second,'a',comm);
-				uint32_t nofNewPerProc = (uint32_t)(rit->second / (uint32_t)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8)));
-				if(rit->first < rank)
-					nofNewHead += nofNewPerProc;
-				else if(rit->first > rank)
-					nofNewTail += nofNewPerProc;
-			}
-			nReq = 0;
-			for(set<int>::iterator sendit = sendersPerProc[rank].begin(); sendit != senditend; ++sendit){
-				//nofBytesOverProc += recvBuffers[sit->first].commBufferSize;
-				error_flag = MPI_Irecv(recvBuffers[*sendit].commBuffer,recvBuffers[*sendit].commBufferSize,MPI_PACKED,*sendit,rank,comm,&req[nReq]);
-				++nReq;
-			}
-			for(map<int,Class_Comm_Buffer>::reverse_iterator rsit = sendBuffers.rbegin(); rsit != rsitend; ++rsit){
-				error_flag =  MPI_Isend(rsit->second.commBuffer,rsit->second.commBufferSize,MPI_PACKED,rsit->first,rsit->first,comm,&req[nReq]);
-				++nReq;
-			}
-			MPI_Waitall(nReq,req,stats);
+	// =============================================================================== //
 
-			//MOVE RESIDENT TO BEGIN IN OCTANTS
-			uint32_t resEnd = octree.getNumOctants() - tailOffset;
-			uint32_t nofResidents = resEnd - headOffset;
-			int octCounter = 0;
-			for(uint32_t i = headOffset; i < resEnd; ++i){
-				octree.octants[octCounter] = octree.octants[i];
-				++octCounter;
-			}
-			uint32_t newCounter = nofNewHead + nofNewTail + nofResidents;
-			octree.octants.resize(newCounter);
-			//MOVE RESIDENTS IN RIGHT POSITION
-			uint32_t resCounter = nofNewHead + nofResidents - 1;
-			for(uint32_t k = 0; k < nofResidents ; ++k){
-				octree.octants[resCounter - k] = octree.octants[nofResidents - k - 1];
-			}
+private:
+	bool updateActiveProcs() {
+		//SHRINK OR EXPAND THE ACTIVE PROCESSES BEFORE A LOAD BALANCE, FALSE IF THE LOCAL PROCESS IS IDLE
+		//a shrink first moves the octants evenly on the processes staying active
+		int nofNext = computeActiveProcs();
+		if(nofNext < nofActive && isActive()){
+			uint32_t* partition = new uint32_t [nproc];
+			computeActivePartition(partition, nofNext);
+			migrateOctants(partition);
+			delete [] partition;
+			partition = NULL;
+		}
+		setActiveProcs(nofNext);
+		return isActive();
+	}
 
-			//UNPACK BUFFERS AND BUILD NEW OCTANTS
-			newCounter = 0;
-			bool jumpResident = false;
-			map<int,Class_Comm_Buffer>::iterator rbitend = recvBuffers.end();
-			for(map<int,Class_Comm_Buffer>::iterator rbit = recvBuffers.begin(); rbit != rbitend; ++rbit){
-				uint32_t nofNewPerProc = (uint32_t)(rbit->second.commBufferSize / (uint32_t)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8)));
-				int pos = 0;
-				if(rbit->first > rank && !jumpResident){
-					newCounter += nofResidents ;
-					jumpResident = true;
-				}
-				for(int i = nofNewPerProc - 1; i >= 0; --i){
-					error_flag = MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&pos,&x,1,MPI_UINT32_T,comm);
-					error_flag = MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&pos,&y,1,MPI_UINT32_T,comm);
-					error_flag = MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&pos,&l,1,MPI_UINT8_T,comm);
-					octree.octants[newCounter] = Class_Octant<2>(l,x,y);
-					error_flag = MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&pos,&m,1,MPI_INT8_T,comm);
-					octree.octants[newCounter].setMarker(m);
-					for(int j = 0; j < 12; ++j){
-						error_flag = MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&pos,&info[j],1,MPI::BOOL,comm);
-						octree.octants[newCounter].info[j] = info[j];
-					}
-					++newCounter;
-				}
-			}
-			octree.octants.shrink_to_fit();
+	// =============================================================================== //
 
-			delete [] newPartitionRangeGlobalidx; newPartitionRangeGlobalidx = NULL;
-			delete [] nofRecvsPerProc; nofRecvsPerProc = NULL;
-			delete [] displays; displays = NULL;
-			delete [] req; req = NULL;
-			delete [] stats; stats = NULL;
-			delete [] globalRecvsBuff; globalRecvsBuff = NULL;
-			//Update and ghosts here
-			updateLoadBalance();
-			setPboundGhosts();
+	template<class Impl>
+	bool updateActiveProcs(Class_Data_LB_Interface<Impl> & userData) {
+		//SHRINK OR EXPAND THE ACTIVE PROCESSES BEFORE A LOAD BALANCE WITH USER DATA, FALSE IF THE LOCAL PROCESS IS IDLE
+		int nofNext = computeActiveProcs();
+		if(nofNext < nofActive && isActive()){
+			uint32_t* partition = new uint32_t [nproc];
+			computeActivePartition(partition, nofNext);
+			migrateOctants(partition, userData);
+			delete [] partition;
+			partition = NULL;
+		}
+		setActiveProcs(nofNext);
+		return isActive();
+	}
 
-		}
-		delete [] partition;
-		partition = NULL;
+	// =============================================================================== //
 
-		//Write info of final partition on log
-		log.writeLog(" ");
-		log.writeLog(" Final Parallel partition : ");
-		log.writeLog(" Octants for proc	"+ to_string(0)+"	:	" + to_string(partition_range_globalidx[0]+1));
-		for(int ii=1; ii<nproc; ii++){
-			log.writeLog(" Octants for proc	"+ to_string(ii)+"	:	" + to_string(partition_range_globalidx[ii]-partition_range_globalidx[ii-1]));
-		}
-		log.writeLog(" ");
+	void writeMigration() {
+		//WRITE THE GLOBAL NUMBER OF OCTANTS AND BYTES MIGRATED BY THE LAST LOAD BALANCE ON LOG
+		uint64_t migrated[2] = {migratedOctants, migratedBytes};
+		error_flag = MPI_Allreduce(MPI_IN_PLACE,migrated,2,MPI_UINT64_T,MPI_SUM,comm);
+		log.writeLog(" Migrated octants		:	" + to_string(migrated[0]));
+		log.writeLog(" Migrated bytes			:	" + to_string(migrated[1]));
 		log.writeLog("---------------------------------------------");
+	}
+
+	// =============================================================================== //
 
+	void moveResidents(uint32_t from, uint32_t nofResidents, uint32_t to, uint32_t newSize) {
+		//MOVE THE RESIDENT OCTANTS FROM [from,from+nofResidents) TO [to,to+nofResidents) OF newSize LOCAL OCTANTS
+		//the residents are shifted by one block move, the octants are reallocated at most once when they grow
+		Class_Local_Tree<2>::OctantsType & octants = octree.octants;
+		if(newSize > octants.size()){
+			octants.reserve(newSize);
+			octants.resize(newSize);
+		}
+		if(to < from)
+			copy(octants.begin() + from, octants.begin() + from + nofResidents, octants.begin() + to);
+		else if(to > from)
+			copy_backward(octants.begin() + from, octants.begin() + from + nofResidents, octants.begin() + to + nofResidents);
+		octants.resize(newSize);
+		trimOctants();
+	}
+
+	// =============================================================================== //
+
+	void trimOctants() {
+		//RELEASE THE UNUSED MEMORY OF THE OCTANTS ONLY IF THE CAPACITY EXCEEDS TWICE THEIR NUMBER
+		//after a load balance the next adapt usually grows the octants again, so a small excess of capacity is kept
+		if(octree.octants.capacity() > 2*octree.octants.size())
+			octree.octants.shrink_to_fit();
 	}
 
 	// =============================================================================== //
 
-	/** Distribute Load-Balancing the octants of the whole tree and data provided by the user
-	 * over the processes of the job following the Morton order.
-	 * Until loadBalance is not called for the first time the mesh is serial.
-	 */
 	template<class Impl>
-	void loadBalance(Class_Data_LB_Interface<Impl> & userData){
+	void migrateOctantCost(uint32_t* partition, Impl & userData) {
+		//MIGRATE THE OCTANT COSTS IN THE SAME MESSAGES OF THE USER DATA
+		updateOctantCost();
+		migrateUserData(partition, userData);
+		costSample.assign(octree.getNumOctants(), -1.0);
+	}
+
+	// =============================================================================== //
+
+	void migrateOctants(uint32_t* partition) {
+		if(costTracking){
+			Class_Data_Fields costData;
+			costData.addField<ADAPT_VOLUME>(octantCost);
+			migrateOctantCost(partition, costData);
+			return;
+		}
+		//MOVE THE OCTANTS TO THE PROCESSES OF A PARTITION (NUMBER OF OCTANTS PER PROCESS)
 		//Write info on log
 		log.writeLog("---------------------------------------------");
 		log.writeLog(" LOAD BALANCE ");
+		migratedOctants = 0;
+		migratedBytes = 0;
 
-		uint32_t* partition = new uint32_t [nproc];
-		computePartition(partition);
 		if(serial)
 		{
 			log.writeLog(" ");
@@ -3175,19 +3907,15 @@ public:
 			uint32_t stride = 0;
 			for(int i = 0; i < rank; ++i)
 				stride += partition[i];
-			Class_Local_Tree<2>::OctantsType octantsCopy = octree.octants;
-			Class_Local_Tree<2>::OctantsType::const_iterator first = octantsCopy.begin() + stride;
-			Class_Local_Tree<2>::OctantsType::const_iterator last = first + partition[rank];
-			octree.octants.assign(first, last);
-			octree.octants.shrink_to_fit();
-			first = octantsCopy.end();
-			last = octantsCopy.end();
-
-			userData.assign(stride,partition[rank]);
+			//keep the local partition in place, the octants of the other processes are erased
+			octree.octants.erase(octree.octants.begin() + stride + partition[rank], octree.octants.end());
+			octree.octants.erase(octree.octants.begin(), octree.octants.begin() + stride);
+			trimOctants();
 
-			//Update and build ghosts here
+			//Update and ghosts here
 			updateLoadBalance();
 			setPboundGhosts();
+
 		}
 		else
 		{
@@ -3203,397 +3931,110 @@ public:
 			octree.size_ghosts = 0;
 			//compute new partition range globalidx
 			uint64_t* newPartitionRangeGlobalidx = new uint64_t[nproc];
+			uint64_t newPartitionEnd = 0;
 			for(int p = 0; p < nproc; ++p){
-				newPartitionRangeGlobalidx[p] = 0;
-				for(int pp = 0; pp <= p; ++pp)
-					newPartitionRangeGlobalidx[p] += (uint64_t)partition[pp];
-				--newPartitionRangeGlobalidx[p];
-			}
-
-			//find resident octants local offset lastHead(lh) and firstTail(ft)
-			int32_t lh,ft;
-			if(rank == 0)
-				lh = -1;
-			else{
-				lh = (int32_t)(newPartitionRangeGlobalidx[rank-1] + 1 - partition_range_globalidx[rank-1] - 1 - 1);
-			}
-			if(lh < 0)
-				lh = - 1;
-			else if(lh > octree.octants.size() - 1)
-				lh = octree.octants.size() - 1;
-
-			if(rank == nproc - 1)
-				ft = octree.octants.size();
-			else if(rank == 0)
-				ft = (int32_t)(newPartitionRangeGlobalidx[rank] + 1);
-			else{
-				ft = (int32_t)(newPartitionRangeGlobalidx[rank] - partition_range_globalidx[rank -1]);
+				newPartitionEnd += (uint64_t)partition[p];
+				newPartitionRangeGlobalidx[p] = newPartitionEnd - 1;
 			}
-			if(ft > (int32_t)(octree.octants.size() - 1))
-				ft = octree.octants.size();
-			else if(ft < 0)
-				ft = 0;
-
-			//compute size Head and size Tail
-			uint32_t headSize = (uint32_t)(lh + 1);
-			uint32_t tailSize = (uint32_t)(octree.octants.size() - ft);
-			uint32_t headOffset = headSize;
-			uint32_t tailOffset = tailSize;
-
-			//build send buffers
-			map<int,Class_Comm_Buffer> sendBuffers;
 
-			//Compute first predecessor and first successor to send buffers to
-			int64_t firstOctantGlobalIdx = 0;// offset to compute global index of each octant in every process
-			int64_t globalLastHead = (int64_t) lh;
-			int64_t globalFirstTail = (int64_t) ft; //lastHead and firstTail in global ordering
-			int firstPredecessor = -1;
-			int firstSuccessor = nproc;
-			if(rank != 0){
-				firstOctantGlobalIdx = (int64_t)(partition_range_globalidx[rank-1] + 1);
-				globalLastHead = firstOctantGlobalIdx + (int64_t)lh;
-				globalFirstTail = firstOctantGlobalIdx + (int64_t)ft;
-				for(int pre = rank - 1; pre >=0; --pre){
-					if((uint64_t)globalLastHead <= newPartitionRangeGlobalidx[pre])
-						firstPredecessor = pre;
-				}
-				for(int post = rank + 1; post < nproc; ++post){
-					if((uint64_t)globalFirstTail <= newPartitionRangeGlobalidx[post] && (uint64_t)globalFirstTail > newPartitionRangeGlobalidx[post-1])
-						firstSuccessor = post;
-				}
-			}
-			else if(rank == 0){
-				firstSuccessor = 1;
-			}
-			MPI_Barrier(comm); //da spostare prima della prima comunicazione
-
-			uint32_t x,y;
-			uint8_t l;
-			int8_t m;
-			bool info[12];
-			//build send buffers from Head
-			if(headSize != 0){
-				for(int p = firstPredecessor; p >= 0; --p){
-					if(headSize <=partition[p]){
-						int buffSize = headSize * (int)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8));
-						//TODO loop over head octants and add data size to buffer size - DONE
-						//compute size of data in buffers
-						if(userData.fixedSize()){
-							buffSize +=  userData.fixedSize() * headSize;
-						}
-						else{
-							for(uint32_t i = 0; i <= lh; ++i){
-								buffSize += userData.size(i);
-							}
-						}
-						//add room for int, number of octants in this buffer
-						buffSize += sizeof(int);
-						sendBuffers[p] = Class_Comm_Buffer(buffSize,'a',comm);
-						//store the number of octants at the beginning of the buffer
-						MPI_Pack(&headSize,1,MPI_UINT32_T,sendBuffers[p].commBuffer,sendBuffers[p].commBufferSize,&sendBuffers[p].pos,comm);
-						//USE BUFFER POS
-						for(uint32_t i = 0; i <= lh; ++i){
-							//PACK octants from 0 to lh in sendBuffer[p]
-							const Class_Octant<2> & octant = octree.octants[i];
-							x = octant.getX();
-							y = octant.getY();
-							l = octant.getLevel();
-							m = octant.getMarker();
-							for(int i = 0; i < 12; ++i)
-								info[i] = octant.info[i];
-							error_flag = MPI_Pack(&x,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&y,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&l,1,MPI_UINT8_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&m,1,MPI_INT8_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							for(int j = 0; j < 12; ++j){
-								MPI_Pack(&info[j],1,MPI::BOOL,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-
-							}
-							//TODO call gather to pack user data - DONE
-							userData.gather(sendBuffers[p],i);
-						}
-						break;
-					}
-					else{
-						int buffSize = partition[p] * (int)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8));
-						//TODO loop over head octants and add data size to buffer size - DONE
-						//compute size of data in buffers
-						if(userData.fixedSize()){
-							buffSize +=  userData.fixedSize() * partition[p];
-						}
-						else{
-							for(uint32_t i = lh - partition[p] + 1; i <= lh; ++i){
-								buffSize += userData.size(i);
-							}
-						}
-						//add room for int, number of octants in this buffer
-						buffSize += sizeof(int);
-						sendBuffers[p] = Class_Comm_Buffer(buffSize,'a',comm);
-						//store the number of octants at the beginning of the buffer
-						MPI_Pack(&partition[p],1,MPI_UINT32_T,sendBuffers[p].commBuffer,sendBuffers[p].commBufferSize,&sendBuffers[p].pos,comm);
-						//USE BUFFER POS
-						for(uint32_t i = lh - partition[p] + 1; i <= lh; ++i){
-							//pack octants from lh - partition[p] to lh
-							const Class_Octant<2> & octant = octree.octants[i];
-							x = octant.getX();
-							y = octant.getY();
-							l = octant.getLevel();
-							m = octant.getMarker();
-							for(int i = 0; i < 12; ++i)
-								info[i] = octant.info[i];
-							error_flag = MPI_Pack(&x,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&y,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&l,1,MPI_UINT8_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&m,1,MPI_INT8_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							for(int j = 0; j < 12; ++j){
-								MPI_Pack(&info[j],1,MPI::BOOL,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							}
-							//TODO call gather to pack user data - DONE
-							userData.gather(sendBuffers[p],i);
-						}
-						lh -= partition[p];
-						headSize = lh + 1;
-					}
-				}
+			//Find the senders and the receivers from the old and new partition ranges (no collective communication)
+			set<int> senders, receivers;
+			computeMigrationPeers(newPartitionRangeGlobalidx,senders,receivers);
 
-			}
-			//build send buffers from Tail
-			if(tailSize != 0){
-				for(int p = firstSuccessor; p < nproc; ++p){
-					if(tailSize <= partition[p]){
-						uint32_t octantsSize = (uint32_t)octree.octants.size();
-						int buffSize = tailSize * (int)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8));
-						//TODO loop over head octants and add data size to buffer size - DONE
-						//compute size of data in buffers
-						if(userData.fixedSize()){
-							buffSize +=  userData.fixedSize() * tailSize;
-						}
-						else{
-							for(uint32_t i = ft; i <= octantsSize; ++i){
-								buffSize += userData.size(i);
-							}
-						}
-						//add room for int, number of octants in this buffer
-						buffSize += sizeof(int);
-						sendBuffers[p] = Class_Comm_Buffer(buffSize,'a',comm);
-						//store the number of octants at the beginning of the buffer
-						MPI_Pack(&tailSize,1,MPI_UINT32_T,sendBuffers[p].commBuffer,sendBuffers[p].commBufferSize,&sendBuffers[p].pos,comm);
-						//USE BUFFER POS
-						for(uint32_t i = ft; i < octantsSize; ++i){
-							//PACK octants from ft to octantsSize-1
-							const Class_Octant<2> & octant = octree.octants[i];
-							x = octant.getX();
-							y = octant.getY();
-							l = octant.getLevel();
-							m = octant.getMarker();
-							for(int i = 0; i < 12; ++i)
-								info[i] = octant.info[i];
-							error_flag = MPI_Pack(&x,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&y,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&l,1,MPI_UINT8_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&m,1,MPI_INT8_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							for(int j = 0; j < 12; ++j){
-								MPI_Pack(&info[j],1,MPI::BOOL,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							}
-							//TODO call gather to pack user data - DONE
-							userData.gather(sendBuffers[p],i);
-						}
-						break;
-					}
-					else{
-						uint32_t endOctants = ft + partition[p] - 1;
-						int buffSize = partition[p] * (int)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8));
-						//TODO loop over head octants and add data size to buffer size - DONE
-						//compute size of data in buffers
-						if(userData.fixedSize()){
-							buffSize +=  userData.fixedSize() * partition[p];
-						}
-						else{
-							for(uint32_t i = ft; i <= endOctants; ++i){
-								buffSize += userData.size(i);
-							}
-						}
-						//add room for int, number of octants in this buffer
-						buffSize += sizeof(int);
-						sendBuffers[p] = Class_Comm_Buffer(buffSize,'a',comm);
-						//store the number of octants at the beginning of the buffer
-						MPI_Pack(&partition[p],1,MPI_UINT32_T,sendBuffers[p].commBuffer,sendBuffers[p].commBufferSize,&sendBuffers[p].pos,comm);
-						for(uint32_t i = ft; i <= endOctants; ++i ){
-							//PACK octants from ft to ft + partition[p] -1
-							const Class_Octant<2> & octant = octree.octants[i];
-							x = octant.getX();
-							y = octant.getY();
-							l = octant.getLevel();
-							m = octant.getMarker();
-							for(int i = 0; i < 12; ++i)
-								info[i] = octant.info[i];
-							error_flag = MPI_Pack(&x,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&y,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&l,1,MPI_UINT8_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&m,1,MPI_INT8_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							for(int j = 0; j < 12; ++j){
-								MPI_Pack(&info[j],1,MPI::BOOL,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							}
-							//TODO call gather to pack user data - DONE
-							userData.gather(sendBuffers[p],i);
-						}
-						ft += partition[p];
-						tailSize -= partition[p];
-					}
-				}
-			}
+			//local octants sent to the processes before (head) and after (tail) this one in the new partition,
+			//the residents are the local octants in the new range of this process (ranges with exclusive end)
+			uint64_t oldBegin = (rank == 0) ? 0 : partition_range_globalidx[rank-1] + 1;
+			uint64_t newBegin = (rank == 0) ? 0 : newPartitionRangeGlobalidx[rank-1] + 1;
+			uint64_t newEnd = newPartitionRangeGlobalidx[rank] + 1;
+			uint32_t nofOctants = octree.getNumOctants();
+			uint32_t headOffset = (uint32_t)min((uint64_t)nofOctants, (newBegin > oldBegin) ? newBegin - oldBegin : 0);
+			uint32_t tailOffset = (uint32_t)min((uint64_t)(nofOctants - headOffset), (oldBegin + nofOctants > newEnd) ? oldBegin + nofOctants - newEnd : 0);
 
-			//Build receiver sources
-			vector<Class_Array> recvs(nproc);
-			recvs[rank] = Class_Array((uint32_t)sendBuffers.size()+1,-1);
-			recvs[rank].array[0] = rank;
-			int counter = 1;
-			map<int,Class_Comm_Buffer>::iterator sitend = sendBuffers.end();
-			for(map<int,Class_Comm_Buffer>::iterator sit = sendBuffers.begin(); sit != sitend; ++sit){
-				recvs[rank].array[counter] = sit->first;
-				++counter;
-			}
-			int* nofRecvsPerProc = new int[nproc];
-			error_flag = MPI_Allgather(&recvs[rank].arraySize,1,MPI_INT,nofRecvsPerProc,1,MPI_INT,comm);
-			int globalRecvsBuffSize = 0;
-			int* displays = new int[nproc];
-			for(int pp = 0; pp < nproc; ++pp){
-				displays[pp] = 0;
-				globalRecvsBuffSize += nofRecvsPerProc[pp];
-				for(int ppp = 0; ppp < pp; ++ppp){
-					displays[pp] += nofRecvsPerProc[ppp];
-				}
-			}
-			//int globalRecvsBuff[globalRecvsBuffSize];
-			int* globalRecvsBuff = new int[globalRecvsBuffSize];
-			error_flag = MPI_Allgatherv(recvs[rank].array,recvs[rank].arraySize,MPI_INT,globalRecvsBuff,nofRecvsPerProc,displays,MPI_INT,comm);
-
-			vector<set<int> > sendersPerProc(nproc);
-			for(int pin = 0; pin < nproc; ++pin){
-				for(int k = displays[pin]+1; k < displays[pin] + nofRecvsPerProc[pin]; ++k){
-					sendersPerProc[globalRecvsBuff[k]].insert(globalRecvsBuff[displays[pin]]);
+			//build send buffers: every receiver gets the local octants in its new range
+			map<int,Class_Comm_Buffer> sendBuffers;
+			for(set<int>::iterator rit = receivers.begin(); rit != receivers.end(); ++rit){
+				int p = *rit;
+				uint64_t pBegin = (p == 0) ? 0 : newPartitionRangeGlobalidx[p-1] + 1;
+				uint64_t pEnd = newPartitionRangeGlobalidx[p] + 1;
+				uint32_t first = (uint32_t)(max(pBegin, oldBegin) - oldBegin);
+				uint32_t last = (uint32_t)(min(pEnd, oldBegin + nofOctants) - oldBegin);
+				int buffSize = (last - first) * (int)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8));
+				sendBuffers[p] = getPoolBuffer(buffSize);
+				for(uint32_t i = first; i < last; ++i){
+					//PACK octants from first to last-1 in sendBuffer[p]
+					sendBuffers[p].write(octree.octants[i].getWire());
 				}
 			}
 
-			//Communicate Octants (size)
-			MPI_Request* req = new MPI_Request[sendBuffers.size()+sendersPerProc[rank].size()];
-			MPI_Status* stats = new MPI_Status[sendBuffers.size()+sendersPerProc[rank].size()];
-			int nReq = 0;
-			map<int,int> recvBufferSizePerProc;
-			set<int>::iterator senditend = sendersPerProc[rank].end();
-			for(set<int>::iterator sendit = sendersPerProc[rank].begin(); sendit != senditend; ++sendit){
-				recvBufferSizePerProc[*sendit] = 0;
-				error_flag = MPI_Irecv(&recvBufferSizePerProc[*sendit],1,MPI_UINT32_T,*sendit,rank,comm,&req[nReq]);
-				++nReq;
-			}
-			map<int,Class_Comm_Buffer>::reverse_iterator rsitend = sendBuffers.rend();
-			for(map<int,Class_Comm_Buffer>::reverse_iterator rsit = sendBuffers.rbegin(); rsit != rsitend; ++rsit){
-				error_flag =  MPI_Isend(&rsit->second.commBufferSize,1,MPI_UINT32_T,rsit->first,rsit->first,comm,&req[nReq]);
-				++nReq;
-			}
-			MPI_Waitall(nReq,req,stats);
+			//Count the octants and the bytes sent by this process
+			migratedOctants = headOffset + tailOffset;
+			migratedBytes = 0;
+			for(map<int,Class_Comm_Buffer>::iterator sit = sendBuffers.begin(); sit != sendBuffers.end(); ++sit)
+				migratedBytes += sit->second.commBufferSize;
 
 			//COMMUNICATE THE BUFFERS TO THE RECEIVERS
-			//recvBuffers structure is declared and each buffer is initialized to the right size
-			//then, sendBuffers are communicated by senders and stored in recvBuffers in the receivers
+			//the number of octants received from each sender is known from the old and new partition ranges,
+			//so recvBuffers are initialized to the right size without exchanging the buffer sizes
+			MPI_Request* req = new MPI_Request[sendBuffers.size()+senders.size()];
+			MPI_Status* stats = new MPI_Status[sendBuffers.size()+senders.size()];
+			int nReq = 0;
 			uint32_t nofNewHead = 0;
 			uint32_t nofNewTail = 0;
 			map<int,Class_Comm_Buffer> recvBuffers;
-
-			map<int,int>::iterator ritend = recvBufferSizePerProc.end();
-			for(map<int,int>::iterator rit = recvBufferSizePerProc.begin(); rit != ritend; ++rit){
-				recvBuffers[rit->first] = Class_Comm_Buffer(rit->second,'a',comm);
-			}
-
-			nReq = 0;
-			for(set<int>::iterator sendit = sendersPerProc[rank].begin(); sendit != senditend; ++sendit){
-				error_flag = MPI_Irecv(recvBuffers[*sendit].commBuffer,recvBuffers[*sendit].commBufferSize,MPI_PACKED,*sendit,rank,comm,&req[nReq]);
+			set<int>::iterator senditend = senders.end();
+			for(set<int>::iterator sendit = senders.begin(); sendit != senditend; ++sendit){
+				uint32_t nofNewPerProc = countMigrationOctants(newPartitionRangeGlobalidx,*sendit);
+				recvBuffers[*sendit] = getPoolBuffer(nofNewPerProc * (int)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8)));
+				if(*sendit < rank)
+					nofNewHead += nofNewPerProc;
+				else if(*sendit > rank)
+					nofNewTail += nofNewPerProc;
+				error_flag = MPI_Irecv(recvBuffers[*sendit].commBuffer,recvBuffers[*sendit].commBufferSize,MPI_BYTE,*sendit,rank,comm,&req[nReq]);
 				++nReq;
 			}
+			map<int,Class_Comm_Buffer>::reverse_iterator rsitend = sendBuffers.rend();
 			for(map<int,Class_Comm_Buffer>::reverse_iterator rsit = sendBuffers.rbegin(); rsit != rsitend; ++rsit){
-				error_flag =  MPI_Isend(rsit->second.commBuffer,rsit->second.commBufferSize,MPI_PACKED,rsit->first,rsit->first,comm,&req[nReq]);
+				error_flag =  MPI_Isend(rsit->second.commBuffer,rsit->second.commBufferSize,MPI_BYTE,rsit->first,rsit->first,comm,&req[nReq]);
 				++nReq;
 			}
 			MPI_Waitall(nReq,req,stats);
 
-			//Unpack number of octants per sender
-			map<int,uint32_t> nofNewOverProcs;
-			map<int,Class_Comm_Buffer>::iterator rbitend = recvBuffers.end();
-			for(map<int,Class_Comm_Buffer>::iterator rbit = recvBuffers.begin(); rbit != rbitend; ++rbit){
-				uint32_t nofNewPerProc;
-				MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&rbit->second.pos,&nofNewPerProc,1,MPI_UINT32_T,comm);
-				nofNewOverProcs[rbit->first] = nofNewPerProc;
-				if(rbit->first < rank)
-					nofNewHead += nofNewPerProc;
-				else if(rbit->first > rank)
-					nofNewTail += nofNewPerProc;
-			}
+			//send buffers are freed before the octants grow, the migration buffers are not kept in the pool
+			sendBuffers.clear();
 
-			//MOVE RESIDENT TO BEGIN IN OCTANTS
+			//MOVE RESIDENTS IN RIGHT POSITION
 			uint32_t resEnd = octree.getNumOctants() - tailOffset;
 			uint32_t nofResidents = resEnd - headOffset;
-			uint32_t octCounter = 0;
-			for(uint32_t i = headOffset; i < resEnd; ++i){
-				octree.octants[octCounter] = octree.octants[i];
-				//TODO move data - DONE
-				userData.move(i,octCounter);
-				++octCounter;
-			}
 			uint32_t newCounter = nofNewHead + nofNewTail + nofResidents;
-			octree.octants.resize(newCounter);
-			userData.resize(newCounter);
-			//MOVE RESIDENTS IN RIGHT POSITION
-			uint32_t resCounter = nofNewHead + nofResidents - 1;
-			for(uint32_t k = 0; k < nofResidents ; ++k){
-				octree.octants[resCounter - k] = octree.octants[nofResidents - k - 1];
-				//TODO move data - DON
-				userData.move(nofResidents - k - 1,resCounter - k);
-			}
+			moveResidents(headOffset, nofResidents, nofNewHead, newCounter);
 
 			//UNPACK BUFFERS AND BUILD NEW OCTANTS
 			newCounter = 0;
 			bool jumpResident = false;
-
+			map<int,Class_Comm_Buffer>::iterator rbitend = recvBuffers.end();
 			for(map<int,Class_Comm_Buffer>::iterator rbit = recvBuffers.begin(); rbit != rbitend; ++rbit){
-				//TODO change new octants counting, probably you have to communicate the number of news per proc
-				uint32_t nofNewPerProc = nofNewOverProcs[rbit->first];
+				uint32_t nofNewPerProc = (uint32_t)(rbit->second.commBufferSize / (uint32_t)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8)));
 				if(rbit->first > rank && !jumpResident){
 					newCounter += nofResidents ;
 					jumpResident = true;
 				}
 				for(int i = nofNewPerProc - 1; i >= 0; --i){
-					error_flag = MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&rbit->second.pos,&x,1,MPI_UINT32_T,comm);
-					error_flag = MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&rbit->second.pos,&y,1,MPI_UINT32_T,comm);
-					error_flag = MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&rbit->second.pos,&l,1,MPI_UINT8_T,comm);
-					octree.octants[newCounter] = Class_Octant<2>(l,x,y);
-					error_flag = MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&rbit->second.pos,&m,1,MPI_INT8_T,comm);
-					octree.octants[newCounter].setMarker(m);
-					for(int j = 0; j < 12; ++j){
-						error_flag = MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&rbit->second.pos,&info[j],1,MPI::BOOL,comm);
-						octree.octants[newCounter].info[j] = info[j];
-					}
-					//TODO Unpack data
-					userData.scatter(rbit->second,newCounter);
+					Class_Octant<2>::Wire wire;
+					rbit->second.read(wire);
+					octree.octants[newCounter] = Class_Octant<2>(wire);
 					++newCounter;
 				}
 			}
-			octree.octants.shrink_to_fit();
-			userData.shrink();
 
+			recvBuffers.clear();
 			delete [] newPartitionRangeGlobalidx; newPartitionRangeGlobalidx = NULL;
-			delete [] nofRecvsPerProc; nofRecvsPerProc = NULL;
-			delete [] displays; displays = NULL;
 			delete [] req; req = NULL;
 			delete [] stats; stats = NULL;
-			delete [] globalRecvsBuff; globalRecvsBuff = NULL;
-
 			//Update and ghosts here
 			updateLoadBalance();
 			setPboundGhosts();
 
 		}
-		delete [] partition;
-		partition = NULL;
 
 		//Write info of final partition on log
 		log.writeLog(" ");
@@ -3604,26 +4045,35 @@ public:
 		}
 		log.writeLog(" ");
 		log.writeLog("---------------------------------------------");
+	}
 
+	// =============================================================================== //
 
+	template<class Impl>
+	void migrateOctants(uint32_t* partition, Class_Data_LB_Interface<Impl> & userData) {
+		//MOVE THE OCTANTS AND THE USER DATA (AND THE OCTANT COSTS IF TRACKED) TO THE PROCESSES OF A PARTITION
+		if(costTracking){
+			Class_Data_Fields costData;
+			costData.addField<ADAPT_VOLUME>(octantCost);
+			Class_Data_Pair<Impl,Class_Data_Fields> pairData(static_cast<Impl&>(userData), costData);
+			migrateOctantCost(partition, pairData);
+		}
+		else{
+			migrateUserData(partition, userData);
+		}
 	}
 
 	// =============================================================================== //
 
-	/** Distribute Load-Balanced the octants of the whole tree and data provided by the user
-	 * over the processes of the job. Until loadBalance is not called for the first time the mesh is serial.
-	 * The families of octants of a desired level are retained compact on the same process.
-	 * \param[in] level Number of level over the max depth reached in the tree at which families of octants are fixed compact on the same process (level=0 is classic LoadBalance).
-	 */
 	template<class Impl>
-	void loadBalance(Class_Data_LB_Interface<Impl> & userData, uint8_t & level){
-
+	void migrateUserData(uint32_t* partition, Class_Data_LB_Interface<Impl> & userData) {
+		//MOVE THE OCTANTS AND THE USER DATA TO THE PROCESSES OF A PARTITION
 		//Write info on log
 		log.writeLog("---------------------------------------------");
 		log.writeLog(" LOAD BALANCE ");
+		migratedOctants = 0;
+		migratedBytes = 0;
 
-		uint32_t* partition = new uint32_t [nproc];
-		computePartition(partition, level);
 		if(serial)
 		{
 			log.writeLog(" ");
@@ -3635,20 +4085,16 @@ public:
 			uint32_t stride = 0;
 			for(int i = 0; i < rank; ++i)
 				stride += partition[i];
-			Class_Local_Tree<2>::OctantsType octantsCopy = octree.octants;
-			Class_Local_Tree<2>::OctantsType::const_iterator first = octantsCopy.begin() + stride;
-			Class_Local_Tree<2>::OctantsType::const_iterator last = first + partition[rank];
-			octree.octants.assign(first, last);
-			octree.octants.shrink_to_fit();
-			first = octantsCopy.end();
-			last = octantsCopy.end();
+			//keep the local partition in place, the octants of the other processes are erased
+			octree.octants.erase(octree.octants.begin() + stride + partition[rank], octree.octants.end());
+			octree.octants.erase(octree.octants.begin(), octree.octants.begin() + stride);
+			trimOctants();
 
 			userData.assign(stride,partition[rank]);
 
 			//Update and build ghosts here
 			updateLoadBalance();
 			setPboundGhosts();
-
 		}
 		else
 		{
@@ -3664,314 +4110,90 @@ public:
 			octree.size_ghosts = 0;
 			//compute new partition range globalidx
 			uint64_t* newPartitionRangeGlobalidx = new uint64_t[nproc];
+			uint64_t newPartitionEnd = 0;
 			for(int p = 0; p < nproc; ++p){
-				newPartitionRangeGlobalidx[p] = 0;
-				for(int pp = 0; pp <= p; ++pp)
-					newPartitionRangeGlobalidx[p] += (uint64_t)partition[pp];
-				--newPartitionRangeGlobalidx[p];
+				newPartitionEnd += (uint64_t)partition[p];
+				newPartitionRangeGlobalidx[p] = newPartitionEnd - 1;
 			}
 
-			//find resident octants local offset lastHead(lh) and firstTail(ft)
-			int32_t lh,ft;
-			if(rank == 0)
-				lh = -1;
-			else{
-				lh = (int32_t)(newPartitionRangeGlobalidx[rank-1] + 1 - partition_range_globalidx[rank-1] - 1 - 1);
-			}
-			if(lh < 0)
-				lh = - 1;
-			else if(lh > octree.octants.size() - 1)
-				lh = octree.octants.size() - 1;
-
-			if(rank == nproc - 1)
-				ft = octree.octants.size();
-			else if(rank == 0)
-				ft = (int32_t)(newPartitionRangeGlobalidx[rank] + 1);
-			else{
-				ft = (int32_t)(newPartitionRangeGlobalidx[rank] - partition_range_globalidx[rank -1]);
-			}
-			if(ft > (int32_t)(octree.octants.size() - 1))
-				ft = octree.octants.size();
-			else if(ft < 0)
-				ft = 0;
-
-			//compute size Head and size Tail
-			uint32_t headSize = (uint32_t)(lh + 1);
-			uint32_t tailSize = (uint32_t)(octree.octants.size() - ft);
-			uint32_t headOffset = headSize;
-			uint32_t tailOffset = tailSize;
-
-			//build send buffers
-			map<int,Class_Comm_Buffer> sendBuffers;
+			//Find the senders and the receivers from the old and new partition ranges (no collective communication)
+			set<int> senders, receivers;
+			computeMigrationPeers(newPartitionRangeGlobalidx,senders,receivers);
 
-			//Compute first predecessor and first successor to send buffers to
-			int64_t firstOctantGlobalIdx = 0;// offset to compute global index of each octant in every process
-			int64_t globalLastHead = (int64_t) lh;
-			int64_t globalFirstTail = (int64_t) ft; //lastHead and firstTail in global ordering
-			int firstPredecessor = -1;
-			int firstSuccessor = nproc;
-			if(rank != 0){
-				firstOctantGlobalIdx = (int64_t)(partition_range_globalidx[rank-1] + 1);
-				globalLastHead = firstOctantGlobalIdx + (int64_t)lh;
-				globalFirstTail = firstOctantGlobalIdx + (int64_t)ft;
-				for(int pre = rank - 1; pre >=0; --pre){
-					if((uint64_t)globalLastHead <= newPartitionRangeGlobalidx[pre])
-						firstPredecessor = pre;
-				}
-				for(int post = rank + 1; post < nproc; ++post){
-					if((uint64_t)globalFirstTail <= newPartitionRangeGlobalidx[post] && (uint64_t)globalFirstTail > newPartitionRangeGlobalidx[post-1])
-						firstSuccessor = post;
-				}
-			}
-			else if(rank == 0){
-				firstSuccessor = 1;
-			}
-			MPI_Barrier(comm); //da spostare prima della prima comunicazione
-
-			uint32_t x,y;
-			uint8_t l;
-			int8_t m;
-			bool info[12];
-			//build send buffers from Head
-			if(headSize != 0){
-				for(int p = firstPredecessor; p >= 0; --p){
-					if(headSize <=partition[p]){
-						int buffSize = headSize * (int)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8));
-						//TODO loop over head octants and add data size to buffer size - DONE
-						//compute size of data in buffers
-						if(userData.fixedSize()){
-							buffSize +=  userData.fixedSize() * headSize;
-						}
-						else{
-							for(uint32_t i = 0; i <= lh; ++i){
-								buffSize += userData.size(i);
-							}
-						}
-						//add room for int, number of octants in this buffer
-						buffSize += sizeof(int);
-						sendBuffers[p] = Class_Comm_Buffer(buffSize,'a',comm);
-						//store the number of octants at the beginning of the buffer
-						MPI_Pack(&headSize,1,MPI_UINT32_T,sendBuffers[p].commBuffer,sendBuffers[p].commBufferSize,&sendBuffers[p].pos,comm);
-						//USE BUFFER POS
-						for(uint32_t i = 0; i <= lh; ++i){
-							//PACK octants from 0 to lh in sendBuffer[p]
-							const Class_Octant<2> & octant = octree.octants[i];
-							x = octant.getX();
-							y = octant.getY();
-							l = octant.getLevel();
-							m = octant.getMarker();
-							for(int i = 0; i < 12; ++i)
-								info[i] = octant.info[i];
-							error_flag = MPI_Pack(&x,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&y,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&l,1,MPI_UINT8_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&m,1,MPI_INT8_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							for(int j = 0; j < 12; ++j){
-								MPI_Pack(&info[j],1,MPI::BOOL,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-
-							}
-							//TODO call gather to pack user data - DONE
-							userData.gather(sendBuffers[p],i);
-						}
-						break;
-					}
-					else{
-						int buffSize = partition[p] * (int)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8));
-						//TODO loop over head octants and add data size to buffer size - DONE
-						//compute size of data in buffers
-						if(userData.fixedSize()){
-							buffSize +=  userData.fixedSize() * partition[p];
-						}
-						else{
-							for(uint32_t i = lh - partition[p] + 1; i <= lh; ++i){
-								buffSize += userData.size(i);
-							}
-						}
-						//add room for int, number of octants in this buffer
-						buffSize += sizeof(int);
-						sendBuffers[p] = Class_Comm_Buffer(buffSize,'a',comm);
-						//store the number of octants at the beginning of the buffer
-						MPI_Pack(&partition[p],1,MPI_UINT32_T,sendBuffers[p].commBuffer,sendBuffers[p].commBufferSize,&sendBuffers[p].pos,comm);
-						//USE BUFFER POS
-						for(uint32_t i = lh - partition[p] + 1; i <= lh; ++i){
-							//pack octants from lh - partition[p] to lh
-							const Class_Octant<2> & octant = octree.octants[i];
-							x = octant.getX();
-							y = octant.getY();
-							l = octant.getLevel();
-							m = octant.getMarker();
-							for(int i = 0; i < 12; ++i)
-								info[i] = octant.info[i];
-							error_flag = MPI_Pack(&x,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&y,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&l,1,MPI_UINT8_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&m,1,MPI_INT8_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							for(int j = 0; j < 12; ++j){
-								MPI_Pack(&info[j],1,MPI::BOOL,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							}
-							//TODO call gather to pack user data - DONE
-							userData.gather(sendBuffers[p],i);
-						}
-						lh -= partition[p];
-						headSize = lh + 1;
-					}
-				}
+			//local octants sent to the processes before (head) and after (tail) this one in the new partition,
+			//the residents are the local octants in the new range of this process (ranges with exclusive end)
+			uint64_t oldBegin = (rank == 0) ? 0 : partition_range_globalidx[rank-1] + 1;
+			uint64_t newBegin = (rank == 0) ? 0 : newPartitionRangeGlobalidx[rank-1] + 1;
+			uint64_t newEnd = newPartitionRangeGlobalidx[rank] + 1;
+			uint32_t nofOctants = octree.getNumOctants();
+			uint32_t headOffset = (uint32_t)min((uint64_t)nofOctants, (newBegin > oldBegin) ? newBegin - oldBegin : 0);
+			uint32_t tailOffset = (uint32_t)min((uint64_t)(nofOctants - headOffset), (oldBegin + nofOctants > newEnd) ? oldBegin + nofOctants - newEnd : 0);
 
-			}
-			//build send buffers from Tail
-			if(tailSize != 0){
-				for(int p = firstSuccessor; p < nproc; ++p){
-					if(tailSize <= partition[p]){
-						uint32_t octantsSize = (uint32_t)octree.octants.size();
-						int buffSize = tailSize * (int)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8));
-						//TODO loop over head octants and add data size to buffer size - DONE
-						//compute size of data in buffers
-						if(userData.fixedSize()){
-							buffSize +=  userData.fixedSize() * tailSize;
-						}
-						else{
-							for(uint32_t i = ft; i <= octantsSize; ++i){
-								buffSize += userData.size(i);
-							}
-						}
-						//add room for int, number of octants in this buffer
-						buffSize += sizeof(int);
-						sendBuffers[p] = Class_Comm_Buffer(buffSize,'a',comm);
-						//store the number of octants at the beginning of the buffer
-						MPI_Pack(&tailSize,1,MPI_UINT32_T,sendBuffers[p].commBuffer,sendBuffers[p].commBufferSize,&sendBuffers[p].pos,comm);
-						//USE BUFFER POS
-						for(uint32_t i = ft; i < octantsSize; ++i){
-							//PACK octants from ft to octantsSize-1
-							const Class_Octant<2> & octant = octree.octants[i];
-							x = octant.getX();
-							y = octant.getY();
-							l = octant.getLevel();
-							m = octant.getMarker();
-							for(int i = 0; i < 12; ++i)
-								info[i] = octant.info[i];
-							error_flag = MPI_Pack(&x,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&y,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&l,1,MPI_UINT8_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&m,1,MPI_INT8_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							for(int j = 0; j < 12; ++j){
-								MPI_Pack(&info[j],1,MPI::BOOL,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							}
-							//TODO call gather to pack user data - DONE
-							userData.gather(sendBuffers[p],i);
-						}
-						break;
-					}
-					else{
-						uint32_t endOctants = ft + partition[p] - 1;
-						int buffSize = partition[p] * (int)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8));
-						//TODO loop over head octants and add data size to buffer size - DONE
-						//compute size of data in buffers
-						if(userData.fixedSize()){
-							buffSize +=  userData.fixedSize() * partition[p];
-						}
-						else{
-							for(uint32_t i = ft; i <= endOctants; ++i){
-								buffSize += userData.size(i);
-							}
-						}
-						//add room for int, number of octants in this buffer
-						buffSize += sizeof(int);
-						sendBuffers[p] = Class_Comm_Buffer(buffSize,'a',comm);
-						//store the number of octants at the beginning of the buffer
-						MPI_Pack(&partition[p],1,MPI_UINT32_T,sendBuffers[p].commBuffer,sendBuffers[p].commBufferSize,&sendBuffers[p].pos,comm);
-						for(uint32_t i = ft; i <= endOctants; ++i ){
-							//PACK octants from ft to ft + partition[p] -1
-							const Class_Octant<2> & octant = octree.octants[i];
-							x = octant.getX();
-							y = octant.getY();
-							l = octant.getLevel();
-							m = octant.getMarker();
-							for(int i = 0; i < 12; ++i)
-								info[i] = octant.info[i];
-							error_flag = MPI_Pack(&x,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&y,1,MPI_UINT32_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&l,1,MPI_UINT8_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							error_flag = MPI_Pack(&m,1,MPI_INT8_T,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							for(int j = 0; j < 12; ++j){
-								MPI_Pack(&info[j],1,MPI::BOOL,sendBuffers[p].commBuffer,buffSize,&sendBuffers[p].pos,comm);
-							}
-							//TODO call gather to pack user data - DONE
-							userData.gather(sendBuffers[p],i);
-						}
-						ft += partition[p];
-						tailSize -= partition[p];
+			//build send buffers: every receiver gets the local octants in its new range
+			map<int,Class_Comm_Buffer> sendBuffers;
+			for(set<int>::iterator rit = receivers.begin(); rit != receivers.end(); ++rit){
+				int p = *rit;
+				uint64_t pBegin = (p == 0) ? 0 : newPartitionRangeGlobalidx[p-1] + 1;
+				uint64_t pEnd = newPartitionRangeGlobalidx[p] + 1;
+				uint32_t first = (uint32_t)(max(pBegin, oldBegin) - oldBegin);
+				uint32_t last = (uint32_t)(min(pEnd, oldBegin + nofOctants) - oldBegin);
+				uint32_t nofSend = last - first;
+				int buffSize = nofSend * (int)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8));
+				//compute size of data in buffers
+				if(userData.fixedSize()){
+					buffSize +=  userData.fixedSize() * nofSend;
+				}
+				else{
+					for(uint32_t i = first; i < last; ++i){
+						buffSize += userData.size(i);
 					}
 				}
-			}
-
-			//Build receiver sources
-			vector<Class_Array> recvs(nproc);
-			recvs[rank] = Class_Array((uint32_t)sendBuffers.size()+1,-1);
-			recvs[rank].array[0] = rank;
-			int counter = 1;
-			map<int,Class_Comm_Buffer>::iterator sitend = sendBuffers.end();
-			for(map<int,Class_Comm_Buffer>::iterator sit = sendBuffers.begin(); sit != sitend; ++sit){
-				recvs[rank].array[counter] = sit->first;
-				++counter;
-			}
-			int* nofRecvsPerProc = new int[nproc];
-			error_flag = MPI_Allgather(&recvs[rank].arraySize,1,MPI_INT,nofRecvsPerProc,1,MPI_INT,comm);
-			int globalRecvsBuffSize = 0;
-			int* displays = new int[nproc];
-			for(int pp = 0; pp < nproc; ++pp){
-				displays[pp] = 0;
-				globalRecvsBuffSize += nofRecvsPerProc[pp];
-				for(int ppp = 0; ppp < pp; ++ppp){
-					displays[pp] += nofRecvsPerProc[ppp];
+				//add room for int, number of octants in this buffer
+				buffSize += sizeof(int);
+				sendBuffers[p] = getPoolBuffer(buffSize);
+				//store the number of octants at the beginning of the buffer
+				sendBuffers[p].write(nofSend);
+				for(uint32_t i = first; i < last; ++i){
+					//PACK octants from first to last-1 in sendBuffer[p]
+					sendBuffers[p].write(octree.octants[i].getWire());
+					userData.gather(sendBuffers[p],i);
 				}
 			}
-			int* globalRecvsBuff = new int[globalRecvsBuffSize];
-			error_flag = MPI_Allgatherv(recvs[rank].array,recvs[rank].arraySize,MPI_INT,globalRecvsBuff,nofRecvsPerProc,displays,MPI_INT,comm);
 
-			vector<set<int> > sendersPerProc(nproc);
-			for(int pin = 0; pin < nproc; ++pin){
-				for(int k = displays[pin]+1; k < displays[pin] + nofRecvsPerProc[pin]; ++k){
-					sendersPerProc[globalRecvsBuff[k]].insert(globalRecvsBuff[displays[pin]]);
-				}
-			}
+			//Count the octants and the bytes sent by this process
+			migratedOctants = headOffset + tailOffset;
+			migratedBytes = 0;
+			for(map<int,Class_Comm_Buffer>::iterator sit = sendBuffers.begin(); sit != sendBuffers.end(); ++sit)
+				migratedBytes += sit->second.commBufferSize;
 
-			//Communicate Octants (size)
-			MPI_Request* req = new MPI_Request[sendBuffers.size()+sendersPerProc[rank].size()];
-			MPI_Status* stats = new MPI_Status[sendBuffers.size()+sendersPerProc[rank].size()];
+			//COMMUNICATE THE BUFFERS TO THE RECEIVERS
+			//sendBuffers are posted first, then the size of the buffer received from each sender is computed
+			//from the old and new partition ranges for fixed size data, or read from the incoming message
+			//otherwise, so the buffer sizes are not exchanged
+			MPI_Request* req = new MPI_Request[sendBuffers.size()+senders.size()];
+			MPI_Status* stats = new MPI_Status[sendBuffers.size()+senders.size()];
 			int nReq = 0;
-			map<int,int> recvBufferSizePerProc;
-			set<int>::iterator senditend = sendersPerProc[rank].end();
-			for(set<int>::iterator sendit = sendersPerProc[rank].begin(); sendit != senditend; ++sendit){
-				recvBufferSizePerProc[*sendit] = 0;
-				error_flag = MPI_Irecv(&recvBufferSizePerProc[*sendit],1,MPI_UINT32_T,*sendit,rank,comm,&req[nReq]);
-				++nReq;
-			}
 			map<int,Class_Comm_Buffer>::reverse_iterator rsitend = sendBuffers.rend();
 			for(map<int,Class_Comm_Buffer>::reverse_iterator rsit = sendBuffers.rbegin(); rsit != rsitend; ++rsit){
-				error_flag =  MPI_Isend(&rsit->second.commBufferSize,1,MPI_UINT32_T,rsit->first,rsit->first,comm,&req[nReq]);
+				error_flag =  MPI_Isend(rsit->second.commBuffer,rsit->second.commBufferSize,MPI_BYTE,rsit->first,rsit->first,comm,&req[nReq]);
 				++nReq;
 			}
-			MPI_Waitall(nReq,req,stats);
-
-			//COMMUNICATE THE BUFFERS TO THE RECEIVERS
-			//recvBuffers structure is declared and each buffer is initialized to the right size
-			//then, sendBuffers are communicated by senders and stored in recvBuffers in the receivers
 			uint32_t nofNewHead = 0;
 			uint32_t nofNewTail = 0;
 			map<int,Class_Comm_Buffer> recvBuffers;
-
-			map<int,int>::iterator ritend = recvBufferSizePerProc.end();
-			for(map<int,int>::iterator rit = recvBufferSizePerProc.begin(); rit != ritend; ++rit){
-				recvBuffers[rit->first] = Class_Comm_Buffer(rit->second,'a',comm);
-			}
-
-			nReq = 0;
-			for(set<int>::iterator sendit = sendersPerProc[rank].begin(); sendit != senditend; ++sendit){
-				error_flag = MPI_Irecv(recvBuffers[*sendit].commBuffer,recvBuffers[*sendit].commBufferSize,MPI_PACKED,*sendit,rank,comm,&req[nReq]);
-				++nReq;
-			}
-			for(map<int,Class_Comm_Buffer>::reverse_iterator rsit = sendBuffers.rbegin(); rsit != rsitend; ++rsit){
-				error_flag =  MPI_Isend(rsit->second.commBuffer,rsit->second.commBufferSize,MPI_PACKED,rsit->first,rsit->first,comm,&req[nReq]);
+			set<int>::iterator senditend = senders.end();
+			for(set<int>::iterator sendit = senders.begin(); sendit != senditend; ++sendit){
+				int recvSize;
+				if(userData.fixedSize()){
+					recvSize = sizeof(int) + countMigrationOctants(newPartitionRangeGlobalidx,*sendit) * ((int)ceil((double)global2D.octantBytes / (double)(CHAR_BIT/8)) + (int)userData.fixedSize());
+				}
+				else{
+					MPI_Status probeStatus;
+					error_flag = MPI_Probe(*sendit,rank,comm,&probeStatus);
+					error_flag = MPI_Get_count(&probeStatus,MPI_BYTE,&recvSize);
+				}
+				recvBuffers[*sendit] = getPoolBuffer(recvSize);
+				error_flag = MPI_Irecv(recvBuffers[*sendit].commBuffer,recvBuffers[*sendit].commBufferSize,MPI_BYTE,*sendit,rank,comm,&req[nReq]);
 				++nReq;
 			}
 			MPI_Waitall(nReq,req,stats);
@@ -3981,7 +4203,7 @@ public:
 			map<int,Class_Comm_Buffer>::iterator rbitend = recvBuffers.end();
 			for(map<int,Class_Comm_Buffer>::iterator rbit = recvBuffers.begin(); rbit != rbitend; ++rbit){
 				uint32_t nofNewPerProc;
-				MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&rbit->second.pos,&nofNewPerProc,1,MPI_UINT32_T,comm);
+				rbit->second.read(nofNewPerProc);
 				nofNewOverProcs[rbit->first] = nofNewPerProc;
 				if(rbit->first < rank)
 					nofNewHead += nofNewPerProc;
@@ -3989,26 +4211,26 @@ public:
 					nofNewTail += nofNewPerProc;
 			}
 
-			//MOVE RESIDENT TO BEGIN IN OCTANTS
+			//send buffers are freed before the octants grow, the migration buffers are not kept in the pool
+			sendBuffers.clear();
+
+			//MOVE RESIDENTS IN RIGHT POSITION
 			uint32_t resEnd = octree.getNumOctants() - tailOffset;
 			uint32_t nofResidents = resEnd - headOffset;
-			uint32_t octCounter = 0;
-			for(uint32_t i = headOffset; i < resEnd; ++i){
-				octree.octants[octCounter] = octree.octants[i];
-				//TODO move data - DONE
-				userData.move(i,octCounter);
-				++octCounter;
-			}
 			uint32_t newCounter = nofNewHead + nofNewTail + nofResidents;
-			octree.octants.resize(newCounter);
-			userData.resize(newCounter);
-			//MOVE RESIDENTS IN RIGHT POSITION
-			uint32_t resCounter = nofNewHead + nofResidents - 1;
-			for(uint32_t k = 0; k < nofResidents ; ++k){
-				octree.octants[resCounter - k] = octree.octants[nofResidents - k - 1];
-				//TODO move data - DON
-				userData.move(nofResidents - k - 1,resCounter - k);
+			//one pass over the residents, in the direction that does not overwrite the residents still to move
+			if(newCounter > octree.getNumOctants())
+				userData.resize(newCounter);
+			if(nofNewHead < headOffset){
+				for(uint32_t i = 0; i < nofResidents; ++i)
+					userData.move(headOffset + i, nofNewHead + i);
 			}
+			else if(nofNewHead > headOffset){
+				for(uint32_t i = nofResidents; i > 0; --i)
+					userData.move(headOffset + i - 1, nofNewHead + i - 1);
+			}
+			userData.resize(newCounter);
+			moveResidents(headOffset, nofResidents, nofNewHead, newCounter);
 
 			//UNPACK BUFFERS AND BUILD NEW OCTANTS
 			newCounter = 0;
@@ -4022,38 +4244,26 @@ public:
 					jumpResident = true;
 				}
 				for(int i = nofNewPerProc - 1; i >= 0; --i){
-					error_flag = MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&rbit->second.pos,&x,1,MPI_UINT32_T,comm);
-					error_flag = MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&rbit->second.pos,&y,1,MPI_UINT32_T,comm);
-					error_flag = MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&rbit->second.pos,&l,1,MPI_UINT8_T,comm);
-					octree.octants[newCounter] = Class_Octant<2>(l,x,y);
-					error_flag = MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&rbit->second.pos,&m,1,MPI_INT8_T,comm);
-					octree.octants[newCounter].setMarker(m);
-					for(int j = 0; j < 12; ++j){
-						error_flag = MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&rbit->second.pos,&info[j],1,MPI::BOOL,comm);
-						octree.octants[newCounter].info[j] = info[j];
-					}
+					Class_Octant<2>::Wire wire;
+					rbit->second.read(wire);
+					octree.octants[newCounter] = Class_Octant<2>(wire);
 					//TODO Unpack data
 					userData.scatter(rbit->second,newCounter);
 					++newCounter;
 				}
 			}
-			octree.octants.shrink_to_fit();
 			userData.shrink();
 
+			recvBuffers.clear();
 			delete [] newPartitionRangeGlobalidx; newPartitionRangeGlobalidx = NULL;
-			delete [] nofRecvsPerProc; nofRecvsPerProc = NULL;
-			delete [] displays; displays = NULL;
 			delete [] req; req = NULL;
 			delete [] stats; stats = NULL;
-			delete [] globalRecvsBuff; globalRecvsBuff = NULL;
 
 			//Update and ghosts here
 			updateLoadBalance();
 			setPboundGhosts();
 
 		}
-		delete [] partition;
-		partition = NULL;
 
 		//Write info of final partition on log
 		log.writeLog(" ");
@@ -4064,9 +4274,9 @@ public:
 		}
 		log.writeLog(" ");
 		log.writeLog("---------------------------------------------");
-
-
 	}
+
+public:
 #endif /* NOMPI */
 	// =============================================================================== //
 
@@ -4085,32 +4295,37 @@ private:
 		}
 		else
 		{
-			//update max_depth
-			error_flag = MPI_Allreduce(&octree.local_max_depth,&max_depth,1,MPI_UINT8_T,MPI_MAX,comm);
-			//update global_num_octants
-			uint64_t local_num_octants = octree.getNumOctants();
-			error_flag = MPI_Allreduce(&local_num_octants,&global_num_octants,1,MPI_UINT64_T,MPI_SUM,comm);
-			//update partition_range_globalidx
-			uint64_t* rbuff = new uint64_t[nproc];
-			error_flag = MPI_Allgather(&local_num_octants,1,MPI_UINT64_T,rbuff,1,MPI_UINT64_T,comm);
-			for(int p = 0; p < nproc; ++p){
-				partition_range_globalidx[p] = 0;
-				for(int pp = 0; pp <=p; ++pp)
-					partition_range_globalidx[p] += rbuff[pp];
-				--partition_range_globalidx[p];
-			}
-			//update partition_range_position
-			uint64_t lastDescMorton = octree.getLastDesc().computeMorton();
-			error_flag = MPI_Allgather(&lastDescMorton,1,MPI_UINT64_T,partition_last_desc,1,MPI_UINT64_T,comm);
-			uint64_t firstDescMorton = octree.getFirstDesc().computeMorton();
-			error_flag = MPI_Allgather(&firstDescMorton,1,MPI_UINT64_T,partition_first_desc,1,MPI_UINT64_T,comm);
-			delete [] rbuff; rbuff = NULL;
+			//update max_depth, global_num_octants, partition_range_globalidx and partition_range_position
+			updatePartitionInfo();
 		}
 #endif
 	}
 
 	// =============================================================================== //
 
+#if NOMPI==0
+	/*! Check if the global refinement of the octree can be performed generating directly the
+	 * partition of each process (see buildUniform): the distribution must be enabled by setDistributeUniform,
+	 * the octree must be the same on each process (and not kept so by setKeepSerial), uniform and with
+	 * the same 2:1 balance flag on each octant.
+	 */
+	bool isUniformReplicated() {
+		if (!distributeUniform || !serial || keep_serial || nproc == 1 || max_depth >= MAX_LEVEL_2D)
+			return false;
+		if (global_num_octants != (uint64_t(1) << (2*max_depth)))
+			return false;
+		bool notBalance = octree.octants[0].getNotBalance();
+		vector<Class_Octant<2> >::const_iterator iter, iterend = octree.octants.end();
+		for (iter = octree.octants.begin(); iter != iterend; iter++){
+			if (iter->getLevel() != max_depth || iter->getNotBalance() != notBalance)
+				return false;
+		}
+		return true;
+	}
+#endif
+
+	// =============================================================================== //
+
 	void updateAfterCoarse(){
 #if NOMPI==0
 		if(serial){
@@ -4156,9 +4371,89 @@ private:
 
 	// =============================================================================== //
 
+	template<class Impl>
+	void updateAfterCoarse(Class_Data_Adapt_Interface<Impl> & userData){
+#if NOMPI==0
+		if(serial){
+#endif
+			updateAdapt();
+#if NOMPI==0
+		}
+		else{
+			//Only if parallel
+			updateAdapt();
+			uint64_t lastDescMortonPre, firstDescMortonPost;
+			lastDescMortonPre = (rank!=0) * partition_last_desc[rank-1];
+			firstDescMortonPost = (rank<nproc-1)*partition_first_desc[rank+1] + (rank==nproc-1)*partition_last_desc[rank];
+			octree.checkCoarse(lastDescMortonPre, firstDescMortonPost, userData);
+			updateAdapt();
+		}
+
+#endif
+	}
+
+	// =============================================================================== //
+
 #if NOMPI==0
+	template<class Impl>
+	uint8_t commCoarseFamily(Class_Data_Adapt_Interface<Impl> & userData) {
+		//SEND THE DATA OF THE FIRST OCTANTS TO THE PROCESS BEFORE IF THEY COMPLETE A FAMILY COARSENED THERE
+		//the data of the children of the last family received from the process after are appended to the local data,
+		//so the restriction of a family split between two processes involves all the children;
+		//user data that are not load balance user data cannot be packed, their restriction involves the local children
+		return commCoarseFamily(static_cast<Impl&>(userData), integral_constant<bool,Class_Data_Is_LB<Impl>::value>());
+	}
+
+	// =============================================================================== //
+
+	template<class Impl>
+	uint8_t commCoarseFamily(Impl & userData, false_type) {
+		return 0;
+	}
+
+	// =============================================================================== //
+
+	template<class Impl>
+	uint8_t commCoarseFamily(Impl & userData, true_type) {
+		uint32_t nocts = octree.getNumOctants();
+		uint8_t nsend = 0, nremote = 0;
+		MPI_Request req;
+		Class_Comm_Buffer sendBuffer;
+		if(rank != 0){
+			nsend = octree.countCoarseFamilyHead(partition_first_desc[rank-1]);
+			uint32_t buffSize = sizeof(uint8_t);
+			for(uint8_t i = 0; i < nsend; ++i)
+				buffSize += userData.size(i);
+			sendBuffer = getPoolBuffer(buffSize);
+			sendBuffer.write(nsend);
+			for(uint8_t i = 0; i < nsend; ++i)
+				userData.gather(sendBuffer,i);
+			error_flag = MPI_Isend(sendBuffer.commBuffer,sendBuffer.commBufferSize,MPI_BYTE,rank-1,rank-1,comm,&req);
+		}
+		if(rank != nproc-1){
+			MPI_Status status;
+			int recvSize;
+			error_flag = MPI_Probe(rank+1,rank,comm,&status);
+			error_flag = MPI_Get_count(&status,MPI_BYTE,&recvSize);
+			Class_Comm_Buffer recvBuffer = getPoolBuffer(recvSize);
+			error_flag = MPI_Recv(recvBuffer.commBuffer,recvSize,MPI_BYTE,rank+1,rank,comm,&status);
+			recvBuffer.read(nremote);
+			userData.resize(nocts+nremote);
+			for(uint8_t i = 0; i < nremote; ++i)
+				userData.scatter(recvBuffer,nocts+i);
+			releasePoolBuffer(recvBuffer);
+		}
+		if(rank != 0){
+			error_flag = MPI_Wait(&req,MPI_STATUS_IGNORE);
+			releasePoolBuffer(sendBuffer);
+		}
+		return nremote;
+	}
+
+	// =============================================================================== //
+
 	void commMarker() {
-		//PACK (mpi) LEVEL AND MARKER OF BORDER OCTANTS IN CHAR BUFFERS WITH SIZE (map value) TO BE SENT TO THE RIGHT PROCESS (map key)
+		//PACK LEVEL AND MARKER OF BORDER OCTANTS IN CHAR BUFFERS WITH SIZE (map value) TO BE SENT TO THE RIGHT PROCESS (map key)
 		//it visits every element in bordersPerProc (one for every neighbor proc)
 		//for every element it visits the border octants it contains and pack its marker in a new structure, sendBuffers
 		//this map has an entry Class_Comm_Buffer for every proc containing the size in bytes of the buffer and the octants marker
@@ -4173,60 +4468,22 @@ private:
 			int buffSize = bit->second.size() * (int)ceil((double)(global2D.markerBytes + global2D.boolBytes) / (double)(CHAR_BIT/8));
 			int key = bit->first;
 			const vector<uint32_t> & value = bit->second;
-			sendBuffers[key] = Class_Comm_Buffer(buffSize,'a',comm);
-			int pos = 0;
+			sendBuffers[key] = getPoolBuffer(buffSize);
 			int nofBorders = value.size();
 			for(int i = 0; i < nofBorders; ++i){
 				//the use of auxiliary variable can be avoided passing to MPI_Pack the members of octant but octant in that case cannot be const
 				const Class_Octant<2> & octant = octree.octants[value[i]];
 				marker = octant.getMarker();
 				mod	= octant.info[11];
-				error_flag = MPI_Pack(&marker,1,MPI_INT8_T,sendBuffers[key].commBuffer,buffSize,&pos,comm);
-				error_flag = MPI_Pack(&mod,1,MPI::BOOL,sendBuffers[key].commBuffer,buffSize,&pos,comm);
+				sendBuffers[key].write(marker);
+				sendBuffers[key].write(mod);
 			}
 		}
 
-		//COMMUNICATE THE SIZE OF BUFFER TO THE RECEIVERS
-		//the size of every borders buffer is communicated to the right process in order to build the receive buffer
-		//and stored in the recvBufferSizePerProc structure
-		MPI_Request* req = new MPI_Request[sendBuffers.size()*2];
-		MPI_Status* stats = new MPI_Status[sendBuffers.size()*2];
-		int nReq = 0;
-		map<int,int> recvBufferSizePerProc;
-		map<int,Class_Comm_Buffer>::iterator sitend = sendBuffers.end();
-		for(map<int,Class_Comm_Buffer>::iterator sit = sendBuffers.begin(); sit != sitend; ++sit){
-			recvBufferSizePerProc[sit->first] = 0;
-			error_flag = MPI_Irecv(&recvBufferSizePerProc[sit->first],1,MPI_UINT32_T,sit->first,rank,comm,&req[nReq]);
-			++nReq;
-		}
-		map<int,Class_Comm_Buffer>::reverse_iterator rsitend = sendBuffers.rend();
-		for(map<int,Class_Comm_Buffer>::reverse_iterator rsit = sendBuffers.rbegin(); rsit != rsitend; ++rsit){
-			error_flag =  MPI_Isend(&rsit->second.commBufferSize,1,MPI_UINT32_T,rsit->first,rsit->first,comm,&req[nReq]);
-			++nReq;
-		}
-		MPI_Waitall(nReq,req,stats);
-
-		//COMMUNICATE THE BUFFERS TO THE RECEIVERS
-		//recvBuffers structure is declared and each buffer is initialized to the right size
-		//then, sendBuffers are communicated by senders and stored in recvBuffers in the receivers
-		//at the same time every process compute the size in bytes of all the level and marker of ghost octants
-		uint32_t nofBytesOverProc = 0;
+		//COMMUNICATE THE BUFFERS TO THE NEIGHBOR PROCESSES
+		//sendBuffers are exchanged with the neighbor processes over the graph communicator and stored in recvBuffers
 		map<int,Class_Comm_Buffer> recvBuffers;
-		map<int,int>::iterator ritend = recvBufferSizePerProc.end();
-		for(map<int,int>::iterator rit = recvBufferSizePerProc.begin(); rit != ritend; ++rit){
-			recvBuffers[rit->first] = Class_Comm_Buffer(rit->second,'a',comm);
-		}
-		nReq = 0;
-		for(map<int,Class_Comm_Buffer>::iterator sit = sendBuffers.begin(); sit != sitend; ++sit){
-			nofBytesOverProc += recvBuffers[sit->first].commBufferSize;
-			error_flag = MPI_Irecv(recvBuffers[sit->first].commBuffer,recvBuffers[sit->first].commBufferSize,MPI_PACKED,sit->first,rank,comm,&req[nReq]);
-			++nReq;
-		}
-		for(map<int,Class_Comm_Buffer>::reverse_iterator rsit = sendBuffers.rbegin(); rsit != rsitend; ++rsit){
-			error_flag =  MPI_Isend(rsit->second.commBuffer,rsit->second.commBufferSize,MPI_PACKED,rsit->first,rsit->first,comm,&req[nReq]);
-			++nReq;
-		}
-		MPI_Waitall(nReq,req,stats);
+		commNeighbors(sendBuffers,recvBuffers);
 
 		//UNPACK BUFFERS AND BUILD GHOSTS CONTAINER OF CLASS_LOCAL_TREE
 		//every entry in recvBuffers is visited, each buffers from neighbor processes is unpacked octant by octant.
@@ -4234,21 +4491,17 @@ private:
 		uint32_t ghostCounter = 0;
 		map<int,Class_Comm_Buffer>::iterator rritend = recvBuffers.end();
 		for(map<int,Class_Comm_Buffer>::iterator rrit = recvBuffers.begin(); rrit != rritend; ++rrit){
-			int pos = 0;
 			int nofGhostsPerProc = int(rrit->second.commBufferSize / ((uint32_t) (global2D.markerBytes + global2D.boolBytes)));
 			for(int i = 0; i < nofGhostsPerProc; ++i){
-				error_flag = MPI_Unpack(rrit->second.commBuffer,rrit->second.commBufferSize,&pos,&marker,1,MPI_INT8_T,comm);
+				rrit->second.read(marker);
 				octree.ghosts[ghostCounter].setMarker(marker);
-				error_flag = MPI_Unpack(rrit->second.commBuffer,rrit->second.commBufferSize,&pos,&mod,1,MPI::BOOL,comm);
+				rrit->second.read(mod);
 				octree.ghosts[ghostCounter].info[11] = mod;
 				++ghostCounter;
 			}
 		}
-		recvBuffers.clear();
-		sendBuffers.clear();
-		recvBufferSizePerProc.clear();
-		delete [] req; req = NULL;
-		delete [] stats; stats = NULL;
+		releasePoolBuffers(recvBuffers);
+		releasePoolBuffers(sendBuffers);
 
 	}
 #endif
@@ -4362,11 +4615,289 @@ private:
 
 	// =============================================================================== //
 
-public:
-	/** Adapt the octree mesh with user setup for markers and 2:1 balancing conditions.
-	 */
-	bool adapt() {
-		bool globalDone = false, localDone = false, cDone = false;
+public:
+	/** Enable the measurement of the computational cost of the local octants.
+	 * The time measured on the octants in a step (startOctantTimer/stopOctantTimer or addOctantCost)
+	 * updates an exponential moving average of the cost of every octant. The costs are projected
+	 * by adapt (the children take an equal share of the father, the father takes the sum of the
+	 * children), they are migrated by loadBalance and they are used as weights by loadBalance()
+	 * and loadBalance(userData) once the octree is distributed.
+	 * \param[in] smoothing Weight of the last measure in the moving average, in (0,1] (default 0.5; 1 keeps only the last measure).
+	 */
+	void enableCostTracking(double smoothing = 0.5){
+		costSmoothing = (smoothing > 0.0 && smoothing <= 1.0) ? smoothing : 0.5;
+		if (!costTracking){
+			costTracking = true;
+			octantCost.assign(octree.getNumOctants(), 0.0);
+			costSample.assign(octree.getNumOctants(), -1.0);
+		}
+	}
+
+	// =============================================================================== //
+
+	/** Disable the measurement of the computational cost of the local octants and release the costs.
+	 */
+	void disableCostTracking(){
+		costTracking = false;
+		dvector().swap(octantCost);
+		dvector().swap(costSample);
+	}
+
+	// =============================================================================== //
+
+	/** Is the computational cost of the local octants measured?
+	 * \return True if the cost tracking is enabled.
+	 */
+	bool getCostTracking(){
+		return costTracking;
+	}
+
+	// =============================================================================== //
+
+	/** Start the octant timer, to be stopped by stopOctantTimer at the end of the work on an octant.
+	 */
+	void startOctantTimer(){
+		costTimer = chrono::steady_clock::now();
+	}
+
+	// =============================================================================== //
+
+	/** Stop the octant timer and add the elapsed time (in seconds) to the cost measured on an octant in the current step.
+	 * \param[in] idx Local index of the octant.
+	 */
+	void stopOctantTimer(uint32_t idx){
+		chrono::duration<double> elapsed = chrono::steady_clock::now() - costTimer;
+		addOctantCost(idx, idx+1, elapsed.count());
+	}
+
+	// =============================================================================== //
+
+	/** Add the time spent on a range of local octants to the cost measured in the current step,
+	 * the time is equally shared by the octants of the range.
+	 * \param[in] first Local index of the first octant of the range.
+	 * \param[in] last Local index past the last octant of the range.
+	 * \param[in] elapsed Time spent on the range (the same unit for all the measures).
+	 */
+	void addOctantCost(uint32_t first, uint32_t last, double elapsed){
+		if (!costTracking || first >= last) return;
+		resizeOctantCost();
+		double share = elapsed/double(last-first);
+		for (uint32_t i = first; i < last; i++){
+			costSample[i] = (costSample[i] < 0.0) ? share : costSample[i] + share;
+		}
+	}
+
+	// =============================================================================== //
+
+	/** Close the measures of the current step: the cost measured on every octant updates its
+	 * moving average, the octants not measured keep their cost.
+	 * It is called by adapt and loadBalance, so the measures of a step are never lost.
+	 */
+	void updateOctantCost(){
+		if (!costTracking) return;
+		resizeOctantCost();
+		uint32_t nocts = octree.getNumOctants();
+		for (uint32_t i = 0; i < nocts; i++){
+			if (costSample[i] >= 0.0){
+				octantCost[i] = (octantCost[i] > 0.0) ? costSmoothing*costSample[i] + (1.0-costSmoothing)*octantCost[i] : costSample[i];
+				costSample[i] = -1.0;
+			}
+		}
+	}
+
+	// =============================================================================== //
+
+	/** Get the smoothed computational cost of an octant.
+	 * \param[in] idx Local index of the octant.
+	 * \return Cost of the octant (0 if never measured or if the cost tracking is disabled).
+	 */
+	double getOctantCost(uint32_t idx){
+		if (!costTracking || idx >= octantCost.size()) return 0.0;
+		return octantCost[idx];
+	}
+
+	// =============================================================================== //
+
+	/** Get the smoothed computational costs of the local octants.
+	 * \return Cost of every local octant (empty if the cost tracking is disabled).
+	 */
+	const dvector & getOctantCost(){
+		resizeOctantCost();
+		return octantCost;
+	}
+
+	// =============================================================================== //
+
+private:
+	void resizeOctantCost(){
+		//KEEP THE COSTS SIZED AS THE LOCAL OCTANTS (THE NEW OCTANTS OF AN UNTRACKED CHANGE HAVE NO COST)
+		if (!costTracking) return;
+		uint32_t nocts = octree.getNumOctants();
+		if (octantCost.size() != nocts){
+			octantCost.resize(nocts, 0.0);
+			costSample.assign(nocts, -1.0);
+		}
+	}
+
+	// =============================================================================== //
+
+	template<class Impl>
+	bool adaptOctantCost(Impl & userData){
+		//ADAPT PROJECTING THE OCTANT COSTS IN THE SAME PASS OF THE USER DATA
+		updateOctantCost();
+		bool globalDone = adaptUserData(userData);
+		costSample.assign(octree.getNumOctants(), -1.0);
+		return globalDone;
+	}
+
+	// =============================================================================== //
+
+	bool adaptOctantCost(bool (Class_Para_Tree::*adaptMapped)(u32vector &), u32vector & mapidx){
+		//ADAPT WITH MAPPER AND PROJECT THE OCTANT COSTS ON THE NEW OCTANTS BY THE CHANGE SET
+		uint32_t nocts = octree.getNumOctants();
+		updateOctantCost();
+		costTracking = false;
+		bool globalDone = (this->*adaptMapped)(mapidx);
+		costTracking = true;
+		Class_Adapt_Changes changes;
+		changes.build(octree.octants, mapidx, nocts);
+		changes.applyShare(octantCost);
+		costSample.assign(octree.getNumOctants(), -1.0);
+		return globalDone;
+	}
+
+	// =============================================================================== //
+
+public:
+	/** Adapt the octree mesh with user setup for markers and 2:1 balancing conditions.
+	 */
+	bool adapt() {
+#if NOMPI==0
+		if(!isActive())
+			return false;
+#endif
+		if (costTracking){
+			Class_Data_Fields costData;
+			costData.addField<ADAPT_VOLUME>(octantCost);
+			return adaptOctantCost(costData);
+		}
+		bool globalDone = false, localDone = false, cDone = false;
+		uint32_t nocts = octree.getNumOctants();
+		vector<Class_Octant<2> >::iterator iter, iterend = octree.octants.end();
+
+		for (iter = octree.octants.begin(); iter != iterend; iter++){
+			iter->info[8] = false;
+			iter->info[9] = false;
+			iter->info[11] = false;
+		}
+#if NOMPI==0
+		if(serial){
+#endif
+			log.writeLog("---------------------------------------------");
+			log.writeLog(" ADAPT (Refine/Coarse)");
+			log.writeLog(" ");
+
+			// 2:1 Balance
+			balance21(true);
+
+			log.writeLog(" ");
+			log.writeLog(" Initial Number of octants	:	" + to_string(octree.getNumOctants()));
+
+			// Refine
+			while(octree.refine());
+
+			if (octree.getNumOctants() > nocts)
+				localDone = true;
+			log.writeLog(" Number of octants after Refine	:	" + to_string(octree.getNumOctants()));
+			nocts = octree.getNumOctants();
+			updateAdapt();
+
+			// Coarse
+			while(octree.coarse());
+			updateAfterCoarse();
+			balance21(false);
+			while(octree.refine());
+			updateAdapt();
+			if (octree.getNumOctants() < nocts){
+				localDone = true;
+			}
+			nocts = octree.getNumOctants();
+
+			log.writeLog(" Number of octants after Coarse	:	" + to_string(nocts));
+#if NOMPI==0
+			MPI_Barrier(comm);
+			error_flag = MPI_Allreduce(&localDone,&globalDone,1,MPI::BOOL,MPI_LOR,comm);
+#endif
+			log.writeLog(" ");
+			log.writeLog("---------------------------------------------");
+#if NOMPI==0
+		}
+		else{
+			log.writeLog("---------------------------------------------");
+			log.writeLog(" ADAPT (Refine/Coarse)");
+			log.writeLog(" ");
+
+			// 2:1 Balance
+			balance21(true);
+
+			log.writeLog(" ");
+			log.writeLog(" Initial Number of octants	:	" + to_string(global_num_octants));
+
+			// Refine
+			while(octree.refine());
+			if (octree.getNumOctants() > nocts)
+				localDone = true;
+			updateAdapt();
+			//setPboundGhosts();
+			log.writeLog(" Number of octants after Refine	:	" + to_string(global_num_octants));
+			nocts = octree.getNumOctants();
+
+			// Coarse
+			while(octree.coarse());
+			updateAfterCoarse();
+			updatePboundGhosts();
+			balance21(false);
+			while(octree.refine());
+			updateAdapt();
+			updatePboundGhosts();
+			if (octree.getNumOctants() < nocts){
+				localDone = true;
+			}
+			nocts = octree.getNumOctants();
+
+			MPI_Barrier(comm);
+			error_flag = MPI_Allreduce(&localDone,&globalDone,1,MPI::BOOL,MPI_LOR,comm);
+			log.writeLog(" Number of octants after Coarse	:	" + to_string(global_num_octants));
+			log.writeLog(" ");
+			log.writeLog("---------------------------------------------");
+		}
+		return globalDone;
+#else
+		return localDone;
+#endif
+	}
+
+	// =============================================================================== //
+
+	/** Adapt the octree mesh with user setup for markers and 2:1 balancing conditions.
+	 * Track the changes in structure octant by a mapper.
+	 * \param[out] mapidx Mapper from new octants to old octants.
+	 * mapidx[i] = j -> the i-th octant after adapt was in the j-th position before adapt;
+	 * if the i-th octant is new after refinement the j-th old octant was the father of the new octant;
+	 * if the i-th octant is new after coarsening the j-th old octant was the first child of the new octant.
+	 */
+	bool adapt(u32vector & mapidx) {
+#if NOMPI==0
+		if(!isActive()){
+			mapidx.clear();
+			return false;
+		}
+#endif
+		if (costTracking){
+			return adaptOctantCost(&Class_Para_Tree::adapt, mapidx);
+		}
+
+		bool globalDone = false, localDone = false;
 		uint32_t nocts = octree.getNumOctants();
 		vector<Class_Octant<2> >::iterator iter, iterend = octree.octants.end();
 
@@ -4375,6 +4906,14 @@ public:
 			iter->info[9] = false;
 			iter->info[11] = false;
 		}
+
+		// mapidx init
+		mapidx.clear();
+		mapidx.resize(nocts);
+		mapidx.shrink_to_fit();
+		for (uint32_t i=0; i<nocts; i++){
+			mapidx[i] = i;
+		}
 #if NOMPI==0
 		if(serial){
 #endif
@@ -4389,7 +4928,7 @@ public:
 			log.writeLog(" Initial Number of octants	:	" + to_string(octree.getNumOctants()));
 
 			// Refine
-			while(octree.refine());
+			while(octree.refine(mapidx));
 
 			if (octree.getNumOctants() > nocts)
 				localDone = true;
@@ -4398,10 +4937,10 @@ public:
 			updateAdapt();
 
 			// Coarse
-			while(octree.coarse());
-			updateAfterCoarse();
+			while(octree.coarse(mapidx));
+			updateAfterCoarse(mapidx);
 			balance21(false);
-			while(octree.refine());
+			while(octree.refine(mapidx));
 			updateAdapt();
 			if (octree.getNumOctants() < nocts){
 				localDone = true;
@@ -4429,22 +4968,21 @@ public:
 			log.writeLog(" Initial Number of octants	:	" + to_string(global_num_octants));
 
 			// Refine
-			while(octree.refine());
+			while(octree.refine(mapidx));
 			if (octree.getNumOctants() > nocts)
 				localDone = true;
 			updateAdapt();
-			//setPboundGhosts();
 			log.writeLog(" Number of octants after Refine	:	" + to_string(global_num_octants));
 			nocts = octree.getNumOctants();
 
 			// Coarse
-			while(octree.coarse());
-			updateAfterCoarse();
-			setPboundGhosts();
+			while(octree.coarse(mapidx));
+			updateAfterCoarse(mapidx);
+			updatePboundGhosts();
 			balance21(false);
-			while(octree.refine());
+			while(octree.refine(mapidx));
 			updateAdapt();
-			setPboundGhosts();
+			updatePboundGhosts();
 			if (octree.getNumOctants() < nocts){
 				localDone = true;
 			}
@@ -4465,14 +5003,37 @@ public:
 	// =============================================================================== //
 
 	/** Adapt the octree mesh with user setup for markers and 2:1 balancing conditions.
-	 * Track the changes in structure octant by a mapper.
-	 * \param[out] mapidx Mapper from new octants to old octants.
-	 * mapidx[i] = j -> the i-th octant after adapt was in the j-th position before adapt;
-	 * if the i-th octant is new after refinement the j-th old octant was the father of the new octant;
-	 * if the i-th octant is new after coarsening the j-th old octant was the first child of the new octant.
+	 * The user data are projected on the new octants during the same pass that rewrites
+	 * the octants (see Class_Data_Fields for a registry of fields with built-in policies).
+	 * \param[in,out] userData User data class derived from Class_Data_Adapt_Interface,
+	 * its size must be equal to the number of local octants before adapt.
+	 * If a family of octants to be coarsened is split between two processes, the data of
+	 * the children on the other process are sent to the process that keeps the father,
+	 * so the restriction involves all the children. This requires load balance user data
+	 * (derived from Class_Data_LB_Interface too, as Class_Data_Fields); otherwise, or if the
+	 * family is split among more than two processes, the restriction involves only the local children.
 	 */
-	bool adapt(u32vector & mapidx) {
+	template<class Impl>
+	bool adapt(Class_Data_Adapt_Interface<Impl> & userData) {
+#if NOMPI==0
+		if(!isActive())
+			return false;
+#endif
+		if (costTracking){
+			Class_Data_Fields costData;
+			costData.addField<ADAPT_VOLUME>(octantCost);
+			Class_Data_Pair<Impl,Class_Data_Fields> pairData(static_cast<Impl&>(userData), costData);
+			return adaptOctantCost(pairData);
+		}
+		return adaptUserData(userData);
+	}
+
+	// =============================================================================== //
 
+private:
+	template<class Impl>
+	bool adaptUserData(Class_Data_Adapt_Interface<Impl> & userData) {
+		//ADAPT AND PROJECT THE USER DATA IN THE SAME PASS
 		bool globalDone = false, localDone = false;
 		uint32_t nocts = octree.getNumOctants();
 		vector<Class_Octant<2> >::iterator iter, iterend = octree.octants.end();
@@ -4483,13 +5044,6 @@ public:
 			iter->info[11] = false;
 		}
 
-		// mapidx init
-		mapidx.clear();
-		mapidx.resize(nocts);
-		mapidx.shrink_to_fit();
-		for (uint32_t i=0; i<nocts; i++){
-			mapidx[i] = i;
-		}
 #if NOMPI==0
 		if(serial){
 #endif
@@ -4504,7 +5058,7 @@ public:
 			log.writeLog(" Initial Number of octants	:	" + to_string(octree.getNumOctants()));
 
 			// Refine
-			while(octree.refine(mapidx));
+			while(octree.refine(userData));
 
 			if (octree.getNumOctants() > nocts)
 				localDone = true;
@@ -4513,15 +5067,16 @@ public:
 			updateAdapt();
 
 			// Coarse
-			while(octree.coarse(mapidx));
-			updateAfterCoarse(mapidx);
+			while(octree.coarse(userData));
+			updateAfterCoarse(userData);
 			balance21(false);
-			while(octree.refine(mapidx));
+			while(octree.refine(userData));
 			updateAdapt();
 			if (octree.getNumOctants() < nocts){
 				localDone = true;
 			}
 			nocts = octree.getNumOctants();
+			userData.shrink();
 
 			log.writeLog(" Number of octants after Coarse	:	" + to_string(nocts));
 #if NOMPI==0
@@ -4544,7 +5099,7 @@ public:
 			log.writeLog(" Initial Number of octants	:	" + to_string(global_num_octants));
 
 			// Refine
-			while(octree.refine(mapidx));
+			while(octree.refine(userData));
 			if (octree.getNumOctants() > nocts)
 				localDone = true;
 			updateAdapt();
@@ -4552,17 +5107,19 @@ public:
 			nocts = octree.getNumOctants();
 
 			// Coarse
-			while(octree.coarse(mapidx));
-			updateAfterCoarse(mapidx);
-			setPboundGhosts();
+			if(octree.coarse(userData, commCoarseFamily(userData)))
+				while(octree.coarse(userData));
+			updateAfterCoarse(userData);
+			updatePboundGhosts();
 			balance21(false);
-			while(octree.refine(mapidx));
+			while(octree.refine(userData));
 			updateAdapt();
-			setPboundGhosts();
+			updatePboundGhosts();
 			if (octree.getNumOctants() < nocts){
 				localDone = true;
 			}
 			nocts = octree.getNumOctants();
+			userData.shrink();
 
 			MPI_Barrier(comm);
 			error_flag = MPI_Allreduce(&localDone,&globalDone,1,MPI::BOOL,MPI_LOR,comm);
@@ -4578,9 +5135,145 @@ public:
 
 	// =============================================================================== //
 
+public:
+	/** Adapt the octree mesh with user setup for markers and 2:1 balancing conditions.
+	 * Track the changes in structure octant by a compact change set (see Class_Adapt_Changes):
+	 * runs of unchanged octants, refined octants and coarsened families.
+	 * The runs are recorded during the same pass that rewrites the octants
+	 * (see Class_Data_Adapt_Recorder), without a mapper with one entry per octant.
+	 * \param[out] changes Change set of the local octants.
+	 */
+	bool adapt(Class_Adapt_Changes & changes) {
+		Class_Data_Adapt_Recorder recorder(octree.getNumOctants());
+
+		bool globalDone = adapt(recorder);
+		recorder.build(changes);
+		return globalDone;
+	}
+
+	// =============================================================================== //
+
+	/** Adapt the octree mesh evaluating the refinement/coarsening markers by a user functor.
+	 * The functor is called once for each local octant with the octant geometry in physical
+	 * domain, its return value is set as marker of the octant and then adapt() is performed.
+	 * The functor must be callable as
+	 * int8_t markerFunctor(uint32_t idx, const double center[3], const double nodes[][3], uint8_t level)
+	 * where nodes has 4 rows (with z coordinate of the domain origin).
+	 * If PABLO is compiled with OpenMP the evaluation loop is thread-parallel,
+	 * hence the functor must be thread-safe.
+	 * \param[in] markerFunctor User callable returning the marker of an octant.
+	 * \return Is the octree changed by the adaption?
+	 */
+	template<class Functor>
+	typename enable_if<!is_base_of<Class_Data_Adapt_Interface<Functor>, Functor>::value, bool>::type
+	adapt(Functor markerFunctor) {
+		int64_t nocts = int64_t(octree.getNumOctants());
+		double unit = trans.mapSize(1);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+		for (int64_t i = 0; i < nocts; i++){
+			Class_Octant<2>& oct = octree.octants[i];
+			double	center[3];
+			double	nodes[4][3];
+			double	x = trans.mapX(oct.x);
+			double	y = trans.mapY(oct.y);
+			double	z = trans.mapZ(uint32_t(0));
+			double	size = unit*double(oct.getSize());
+			center[0] = x + 0.5*size;
+			center[1] = y + 0.5*size;
+			center[2] = z;
+			for (uint8_t j = 0; j < global2D.nnodes; j++){
+				nodes[j][0] = x + double(j%2)*size;
+				nodes[j][1] = y + double(j/2)*size;
+				nodes[j][2] = z;
+			}
+			oct.marker = markerFunctor(uint32_t(i), center, nodes, oct.level);
+		}
+
+		return adapt();
+	}
+
+	// =============================================================================== //
+
+	/** Build the uniform octree of a given level directly in Morton order.
+	 * The current octree is replaced. Each process generates only its own contiguous
+	 * partition (the same balanced partition given by loadBalance), with boundary flags
+	 * set on the fly and the ghost layer built once. If the uniform octree has fewer
+	 * octants than processes it is replicated on each process (serial).
+	 * \param[in] level Refinement level of the uniform octree.
+	 * \param[in] balance 2:1 balance flag of the new octants (default true).
+	 */
+	void buildUniform(uint8_t level, bool balance = true) {
+		level = min(level, uint8_t(MAX_LEVEL_2D));
+		uint64_t nglobal = uint64_t(1) << (2*level);
+
+		log.writeLog("---------------------------------------------");
+		log.writeLog(" BUILD UNIFORM");
+		log.writeLog(" ");
+		log.writeLog(" Level				:	" + to_string(level));
+
+		max_depth = level;
+		global_num_octants = nglobal;
+#if NOMPI==0
+		serial = (nproc == 1 || nglobal < (uint64_t)nproc);
+		if(!serial){
+			uint8_t shift = 2*(MAX_LEVEL_2D - level);
+			uint32_t* partition = new uint32_t[nproc];
+			computePartition(partition);
+			uint64_t first = 0;
+			for(int p = 0; p < nproc; ++p){
+				partition_first_desc[p] = first << shift;
+				first += partition[p];
+				partition_range_globalidx[p] = first - 1;
+				partition_last_desc[p] = (first << shift) - 1;
+			}
+			octree.setUniform(level, partition_range_globalidx[rank] + 1 - partition[rank], partition[rank], balance);
+			delete [] partition; partition = NULL;
+			setPboundGhosts();
+		}
+		else{
+#endif
+			// The replicated octree spans the whole domain on every process, without ghosts
+			// or border octants left over from a previous distributed octree
+			octree.setUniform(level, 0, uint32_t(nglobal), balance);
+			uint64_t firstDesc = octree.getFirstDesc().computeMorton();
+			uint64_t lastDesc = octree.getLastDesc().computeMorton();
+			for(int p = 0; p < nproc; ++p){
+				partition_first_desc[p] = firstDesc;
+				partition_last_desc[p] = lastDesc;
+				partition_range_globalidx[p] = global_num_octants - 1;
+			}
+			octree.ghosts.clear();
+			octree.globalidx_ghosts.clear();
+			octree.size_ghosts = 0;
+			bordersPerProc.clear();
+#if NOMPI==0
+		}
+#endif
+		if(costTracking){
+			octantCost.assign(octree.getNumOctants(), 0.0);
+			costSample.assign(octree.getNumOctants(), -1.0);
+		}
+		log.writeLog(" Number of octants		:	" + to_string(global_num_octants));
+		log.writeLog(" ");
+		log.writeLog("---------------------------------------------");
+	}
+
+	// =============================================================================== //
+
 	/** Adapt the octree mesh refining all the octants by one level.
 	 */
 	bool adaptGlobalRefine() {
+#if NOMPI==0
+		if(!isActive())
+			return false;
+#endif
+		if (costTracking){
+			u32vector mapidx;
+			return adaptGlobalRefine(mapidx);
+		}
 		bool globalDone = false, localDone = false, cDone = false;
 		uint32_t nocts = octree.getNumOctants();
 		vector<Class_Octant<2> >::iterator iter, iterend = octree.octants.end();
@@ -4590,6 +5283,13 @@ public:
 			iter->info[9] = false;
 			iter->info[11] = false;
 		}
+#if NOMPI==0
+		if(isUniformReplicated()){
+			// Distribute the refined octree: each process generates only its partition
+			buildUniform(max_depth+1, !octree.octants[0].getNotBalance());
+			return true;
+		}
+#endif
 #if NOMPI==0
 		if(serial){
 #endif
@@ -4655,6 +5355,15 @@ public:
 	 * if the i-th octant is new after coarsening the j-th old octant was the first child of the new octant.
 	 */
 	bool adaptGlobalRefine(u32vector & mapidx) {
+#if NOMPI==0
+		if(!isActive()){
+			mapidx.clear();
+			return false;
+		}
+#endif
+		if (costTracking){
+			return adaptOctantCost(&Class_Para_Tree::adaptGlobalRefine, mapidx);
+		}
 
 		bool globalDone = false, localDone = false;
 		uint32_t nocts = octree.getNumOctants();
@@ -4673,6 +5382,20 @@ public:
 		for (uint32_t i=0; i<nocts; i++){
 			mapidx[i] = i;
 		}
+#if NOMPI==0
+		if(isUniformReplicated()){
+			// Distribute the refined octree: each process generates only its partition
+			buildUniform(max_depth+1, !octree.octants[0].getNotBalance());
+			nocts = octree.getNumOctants();
+			uint64_t first = serial ? 0 : partition_range_globalidx[rank] + 1 - nocts;
+			mapidx.resize(nocts);
+			mapidx.shrink_to_fit();
+			for (uint32_t i=0; i<nocts; i++){
+				mapidx[i] = uint32_t((first+i) >> 2);
+			}
+			return true;
+		}
+#endif
 #if NOMPI==0
 		if(serial){
 #endif
@@ -4733,6 +5456,14 @@ public:
 	/** Adapt the octree mesh coarsening all the octants by one level.
 	 */
 	bool adaptGlobalCoarse() {
+#if NOMPI==0
+		if(!isActive())
+			return false;
+#endif
+		if (costTracking){
+			u32vector mapidx;
+			return adaptGlobalCoarse(mapidx);
+		}
 		bool globalDone = false, localDone = false, cDone = false;
 		uint32_t nocts = octree.getNumOctants();
 		vector<Class_Octant<2> >::iterator iter, iterend = octree.octants.end();
@@ -4821,6 +5552,15 @@ public:
 	 * if the i-th octant is new after coarsening the j-th old octant was the first child of the new octant.
 	 */
 	bool adaptGlobalCoarse(u32vector & mapidx) {
+#if NOMPI==0
+		if(!isActive()){
+			mapidx.clear();
+			return false;
+		}
+#endif
+		if (costTracking){
+			return adaptOctantCost(&Class_Para_Tree::adaptGlobalCoarse, mapidx);
+		}
 
 		bool globalDone = false, localDone = false;
 		uint32_t nocts = octree.getNumOctants();
@@ -4912,92 +5652,329 @@ public:
 	// =============================================================================== //
 
 	/** Communicate data provided by the user between the processes.
+	 * The communication plan of the tree is reused until the ghost layer changes.
 	 */
 	template<class Impl>
 	void communicate(Class_Data_Comm_Interface<Impl> & userData){
-		//BUILD SEND BUFFERS
-		map<int,Class_Comm_Buffer> sendBuffers;
+		communicate(userData,commPlan);
+	};
+
+	// =============================================================================== //
+
+	/** Communicate data provided by the user between the processes with a communication plan.
+	 * The plan is built at the first call and rebuilt only if the ghost layer or the size policy
+	 * of the data are changed: keep one plan for every field communicated on the same mesh.
+	 * \param[in,out] userData User data to be communicated.
+	 * \param[in,out] plan Communication plan.
+	 */
+	template<class Impl>
+	void communicate(Class_Data_Comm_Interface<Impl> & userData, Class_Comm_Plan & plan){
+		communicateBegin(userData,plan);
+		communicateEnd(userData,plan);
+	};
+
+	// =============================================================================== //
+
+	/** Start the communication of the data provided by the user with the communication plan of the tree.
+	 * The data of the border octants are gathered at this call; the ghost data are available after communicateEnd.
+	 */
+	template<class Impl>
+	void communicateBegin(Class_Data_Comm_Interface<Impl> & userData){
+		communicateBegin(userData,commPlan);
+	};
+
+	// =============================================================================== //
+
+	/** Complete the communication started by communicateBegin(userData).
+	 */
+	template<class Impl>
+	void communicateEnd(Class_Data_Comm_Interface<Impl> & userData){
+		communicateEnd(userData,commPlan);
+	};
+
+	// =============================================================================== //
+
+	/** Start the communication of the data provided by the user with a communication plan.
+	 * The data of the border octants are gathered and the messages are started; the interior
+	 * octants (getInteriorOctants) can be computed before calling communicateEnd.
+	 * \param[in,out] userData User data to be communicated.
+	 * \param[in,out] plan Communication plan.
+	 */
+	template<class Impl>
+	void communicateBegin(Class_Data_Comm_Interface<Impl> & userData, Class_Comm_Plan & plan){
+		if(!isActive())
+			return;
 		size_t fixedDataSize = userData.fixedSize();
-		map<int,vector<uint32_t> >::iterator bitend = bordersPerProc.end();
-		map<int,vector<uint32_t> >::iterator bitbegin = bordersPerProc.begin();
-		for(map<int,vector<uint32_t> >::iterator bit = bitbegin; bit != bitend; ++bit){
-			const int & key = bit->first;
-			const vector<uint32_t> & pborders = bit->second;
-			size_t buffSize = 0;
+		waitCommPlan(plan);
+		if(!plan.isValid(ghostsStamp,fixedDataSize)){
+			buildCommPlan(plan,fixedDataSize);
+		}
+		int nofNeighbors = plan.procs.size();
+
+		//WRITE SEND BUFFERS
+		//variable size buffers are reallocated only if their size is changed
+		for(int i = 0; i < nofNeighbors; ++i){
+			const vector<uint32_t> & pborders = bordersPerProc[plan.procs[i]];
 			size_t nofPbordersPerProc = pborders.size();
-			if(fixedDataSize != 0){
-				buffSize = fixedDataSize*nofPbordersPerProc;
-			}
-			else{
-				for(size_t i = 0; i < nofPbordersPerProc; ++i){
-					buffSize += userData.size(pborders[i]);
+			if(fixedDataSize == 0){
+				int buffSize = 0;
+				for(size_t j = 0; j < nofPbordersPerProc; ++j){
+					buffSize += userData.size(pborders[j]);
+				}
+				if(buffSize != plan.sendSizes[i]){
+					plan.sendSizes[i] = buffSize;
+					plan.sendBuffers[i].resize(buffSize);
 				}
 			}
-			//enlarge buffer to store number of pborders from this proc
-			buffSize += sizeof(int);
-			//build buffer for this proc
-			sendBuffers[key] = Class_Comm_Buffer(buffSize,'a',comm);
-			//store number of pborders from this proc at the begining
-			MPI_Pack(&nofPbordersPerProc,1,MPI_INT,sendBuffers[key].commBuffer,sendBuffers[key].commBufferSize,&sendBuffers[key].pos,comm);
-
-			//WRITE SEND BUFFERS
+			Class_Comm_Buffer & sendBuffer = plan.sendBuffers[i];
+			sendBuffer.pos = 0;
 			for(size_t j = 0; j < nofPbordersPerProc; ++j){
-				userData.gather(sendBuffers[key],pborders[j]);
+				userData.gather(sendBuffer,pborders[j]);
 			}
 		}
 
-		//Communicate Buffers Size
-		MPI_Request* req = new MPI_Request[sendBuffers.size()*2];
-		MPI_Status* stats = new MPI_Status[sendBuffers.size()*2];
-		int nReq = 0;
-		map<int,int> recvBufferSizePerProc;
-		map<int,Class_Comm_Buffer>::iterator sitend = sendBuffers.end();
-		for(map<int,Class_Comm_Buffer>::iterator sit = sendBuffers.begin(); sit != sitend; ++sit){
-			recvBufferSizePerProc[sit->first] = 0;
-			error_flag = MPI_Irecv(&recvBufferSizePerProc[sit->first],1,MPI_UINT32_T,sit->first,rank,comm,&req[nReq]);
-			++nReq;
-		}
-		map<int,Class_Comm_Buffer>::reverse_iterator rsitend = sendBuffers.rend();
-		for(map<int,Class_Comm_Buffer>::reverse_iterator rsit = sendBuffers.rbegin(); rsit != rsitend; ++rsit){
-			error_flag =  MPI_Isend(&rsit->second.commBufferSize,1,MPI_UINT32_T,rsit->first,rsit->first,comm,&req[nReq]);
-			++nReq;
+		//START COMMUNICATION
+		startCommPlan(plan);
+	};
+
+	// =============================================================================== //
+
+	/** Complete the communication started by communicateBegin and scatter the ghost data.
+	 * \param[in,out] userData User data to be communicated.
+	 * \param[in,out] plan Communication plan.
+	 */
+	template<class Impl>
+	void communicateEnd(Class_Data_Comm_Interface<Impl> & userData, Class_Comm_Plan & plan){
+		if(!isActive())
+			return;
+		//WAIT COMMUNICATION
+		waitCommPlan(plan);
+
+		//READ RECEIVE BUFFERS
+		int nofNeighbors = plan.procs.size();
+		for(int i = 0; i < nofNeighbors; ++i){
+			Class_Comm_Buffer & recvBuffer = plan.recvBuffers[i];
+			recvBuffer.pos = 0;
+			for(uint32_t k = 0; k < plan.nofGhosts[i]; ++k){
+				userData.scatter(recvBuffer,plan.ghostOffsets[i]+k);
+			}
 		}
-		MPI_Waitall(nReq,req,stats);
+	};
+	// =============================================================================== //
 
-		//Communicate Buffers
-		map<int,Class_Comm_Buffer> recvBuffers;
-		map<int,int>::iterator ritend = recvBufferSizePerProc.end();
-		for(map<int,int>::iterator rit = recvBufferSizePerProc.begin(); rit != ritend; ++rit){
-			recvBuffers[rit->first] = Class_Comm_Buffer(rit->second,'a',comm);
+	/** Communicate a vector of data of the local octants to the ghost octants.
+	 * The data type has to be trivially copyable (e.g. double, array<double,N>): the border octants
+	 * are sent directly from data by indexed datatypes and the ghost data are received in place,
+	 * without buffers and without calls per octant. The typed plan of the tree is reused until
+	 * the ghost layer changes.
+	 * \param[in] data Data of the local octants (one per octant).
+	 * \param[out] ghostData Data of the ghost octants (resized to the number of ghosts).
+	 */
+	template<class T>
+	void communicate(vector<T> & data, vector<T> & ghostData){
+		communicate(data,ghostData,typedCommPlan);
+	};
+
+	// =============================================================================== //
+
+	/** Communicate a vector of data of the local octants to the ghost octants with a typed communication plan.
+	 * \param[in] data Data of the local octants.
+	 * \param[out] ghostData Data of the ghost octants (resized to the number of ghosts).
+	 * \param[in,out] plan Communication plan.
+	 */
+	template<class T>
+	void communicate(vector<T> & data, vector<T> & ghostData, Class_Comm_Plan & plan){
+		communicateBegin(data,ghostData,plan);
+		communicateEnd(data,ghostData,plan);
+	};
+
+	// =============================================================================== //
+
+	/** Start the communication of a vector of data of the local octants to the ghost octants.
+	 * data cannot be modified and ghostData cannot be used until communicateEnd.
+	 * \param[in] data Data of the local octants.
+	 * \param[out] ghostData Data of the ghost octants (resized to the number of ghosts).
+	 * \param[in,out] plan Communication plan.
+	 */
+	template<class T>
+	void communicateBegin(vector<T> & data, vector<T> & ghostData, Class_Comm_Plan & plan){
+		static_assert(is_trivially_copyable<T>::value, "typed communicate needs trivially copyable data");
+		if(!isActive())
+			return;
+		assert(data.size() == octree.getNumOctants());
+		waitCommPlan(plan);
+		if(!plan.isValid(ghostsStamp,sizeof(T),true)){
+			buildTypedCommPlan(plan,sizeof(T));
+		}
+		ghostData.resize(octree.getSizeGhost());
+		plan.pending = true;
+		if(!neighborComm)
+			return;
+		error_flag = MPI_Ineighbor_alltoallw(data.data(),plan.sendSizes.data(),plan.sendDispls.data(),plan.sendTypes.data(),
+				ghostData.data(),plan.recvSizes.data(),plan.recvDispls.data(),plan.types.data(),*neighborComm,&plan.neighborRequest);
+	};
+
+	// =============================================================================== //
+
+	/** Complete the communication started by communicateBegin(data,ghostData,plan).
+	 * \param[in] data Data of the local octants.
+	 * \param[out] ghostData Data of the ghost octants.
+	 * \param[in,out] plan Communication plan.
+	 */
+	template<class T>
+	void communicateEnd(vector<T> & data, vector<T> & ghostData, Class_Comm_Plan & plan){
+		if(!isActive())
+			return;
+		//the ghost data are received in place: the vectors must not be resized between begin and end
+		assert(data.size() == octree.getNumOctants() && ghostData.size() == octree.getSizeGhost());
+		waitCommPlan(plan);
+	};
+	// =============================================================================== //
+
+	/** Communicate all the fields of a registry with a ghost vector in one message per neighbor process.
+	 * The ghost vectors are resized to the number of ghosts.
+	 * \param[in,out] fields Registry of the fields to be communicated.
+	 */
+	void communicate(Class_Data_Fields & fields){
+		communicate(fields,fieldsCommPlan);
+	};
+
+	// =============================================================================== //
+
+	/** Communicate all the fields of a registry with a ghost vector in one message per neighbor process,
+	 * with a communication plan.
+	 * \param[in,out] fields Registry of the fields to be communicated.
+	 * \param[in,out] plan Communication plan.
+	 */
+	void communicate(Class_Data_Fields & fields, Class_Comm_Plan & plan){
+		fields.resizeGhosts(octree.getSizeGhost());
+		Class_Data_Fields::Ghosts ghosts(fields);
+		communicate(ghosts,plan);
+	};
+	// =============================================================================== //
+
+	/** Accumulate the data of the ghost octants to the local octants owning them (reverse of communicate(data,ghostData)).
+	 * The value of every ghost is sent back to its owner process and combined with the local value,
+	 * data[i] = op(data[i],ghostData[g]), for every ghost g of the octant i on the neighbor processes.
+	 * The contributions are combined in increasing rank order of the neighbor processes.
+	 * The typed plan of the tree (the plan of communicate(data,ghostData)) is reused until the ghost layer changes.
+	 * \param[in,out] data Data of the local octants.
+	 * \param[in] ghostData Data of the ghost octants (one per ghost).
+	 * \param[in] op Binary operation T(const T&, const T&), e.g. std::plus<T>() or a user functor.
+	 */
+	template<class T, class Op>
+	void accumulate(vector<T> & data, const vector<T> & ghostData, Op op){
+		accumulate(data,ghostData,op,typedCommPlan);
+	};
+
+	// =============================================================================== //
+
+	/** Accumulate the data of the ghost octants to the local octants owning them by summation.
+	 * \param[in,out] data Data of the local octants.
+	 * \param[in] ghostData Data of the ghost octants (one per ghost).
+	 */
+	template<class T>
+	void accumulate(vector<T> & data, const vector<T> & ghostData){
+		accumulate(data,ghostData,plus<T>(),typedCommPlan);
+	};
+
+	// =============================================================================== //
+
+	/** Accumulate the data of the ghost octants to the local octants owning them with a communication plan.
+	 * The ghost data of every neighbor are sent from their offset in ghostData, as received by the forward
+	 * exchange, and the contributions are received in a pooled buffer in the order of the border octants.
+	 * \param[in,out] data Data of the local octants.
+	 * \param[in] ghostData Data of the ghost octants (one per ghost).
+	 * \param[in] op Binary operation T(const T&, const T&).
+	 * \param[in,out] plan Typed communication plan.
+	 */
+	template<class T, class Op>
+	void accumulate(vector<T> & data, const vector<T> & ghostData, Op op, Class_Comm_Plan & plan){
+		static_assert(is_trivially_copyable<T>::value, "accumulate needs trivially copyable data");
+		if(!isActive())
+			return;
+		assert(data.size() == octree.getNumOctants() && ghostData.size() == octree.getSizeGhost());
+		waitCommPlan(plan);
+		if(!plan.isValid(ghostsStamp,sizeof(T),true)){
+			buildTypedCommPlan(plan,sizeof(T));
 		}
-		nReq = 0;
-		for(map<int,Class_Comm_Buffer>::iterator sit = sendBuffers.begin(); sit != sitend; ++sit){
-			error_flag = MPI_Irecv(recvBuffers[sit->first].commBuffer,recvBuffers[sit->first].commBufferSize,MPI_PACKED,sit->first,rank,comm,&req[nReq]);
-			++nReq;
+		if(!neighborComm)
+			return;
+		int nofNeighbors = plan.procs.size();
+		vector<int> recvCounts(nofNeighbors,0);
+		vector<MPI_Aint> recvDispls(nofNeighbors,0);
+		uint32_t recvSize = 0;
+		for(int i = 0; i < nofNeighbors; ++i){
+			recvCounts[i] = sizeof(T)*bordersPerProc[plan.procs[i]].size();
+			recvDispls[i] = recvSize;
+			recvSize += recvCounts[i];
+		}
+		Class_Comm_Buffer recvBuffer = getPoolBuffer(recvSize);
+		error_flag = MPI_Neighbor_alltoallw(ghostData.data(),plan.recvSizes.data(),plan.recvDispls.data(),plan.types.data(),
+				recvBuffer.commBuffer,recvCounts.data(),recvDispls.data(),plan.types.data(),*neighborComm);
+
+		//COMBINE THE CONTRIBUTIONS
+		for(int i = 0; i < nofNeighbors; ++i){
+			const vector<uint32_t> & borders = bordersPerProc[plan.procs[i]];
+			size_t nofBorders = borders.size();
+			for(size_t j = 0; j < nofBorders; ++j){
+				T value;
+				recvBuffer.read(value);
+				data[borders[j]] = op(data[borders[j]],value);
+			}
+		}
+		releasePoolBuffer(recvBuffer);
+	};
+#endif /* NOMPI */
+	// =============================================================================== //
+
+	/** Get the border octants, i.e. the local octants with at least one ghost neighbor
+	 * (through a face, an edge or a node). Their computation needs the ghost data.
+	 * \return Sorted local indices of the border octants.
+	 */
+	u32vector getBorderOctants(){
+		vector<bool> border;
+		markBorderOctants(border);
+		u32vector idx;
+		for(uint32_t i = 0; i < border.size(); ++i){
+			if(border[i])
+				idx.push_back(i);
 		}
-		for(map<int,Class_Comm_Buffer>::reverse_iterator rsit = sendBuffers.rbegin(); rsit != rsitend; ++rsit){
-			error_flag =  MPI_Isend(rsit->second.commBuffer,rsit->second.commBufferSize,MPI_PACKED,rsit->first,rsit->first,comm,&req[nReq]);
-			++nReq;
+		return idx;
+	}
+
+	// =============================================================================== //
+
+	/** Get the interior octants, i.e. the local octants without ghost neighbors.
+	 * They can be computed while the ghost data are communicated (communicateBegin/communicateEnd).
+	 * \return Sorted local indices of the interior octants.
+	 */
+	u32vector getInteriorOctants(){
+		vector<bool> border;
+		markBorderOctants(border);
+		u32vector idx;
+		for(uint32_t i = 0; i < border.size(); ++i){
+			if(!border[i])
+				idx.push_back(i);
 		}
-		MPI_Waitall(nReq,req,stats);
+		return idx;
+	}
 
-		//READ RECEIVE BUFFERS
-		int ghostOffset = 0;
-		map<int,Class_Comm_Buffer>::iterator rbitend = recvBuffers.end();
-		map<int,Class_Comm_Buffer>::iterator rbitbegin = recvBuffers.begin();
-		for(map<int,Class_Comm_Buffer>::iterator rbit = rbitbegin; rbit != rbitend; ++rbit){
-			int nofGhostFromThisProc = 0;
-			MPI_Unpack(rbit->second.commBuffer,rbit->second.commBufferSize,&rbit->second.pos,&nofGhostFromThisProc,1,MPI_INT,comm);
-			for(int k = 0; k < nofGhostFromThisProc; ++k){
-				userData.scatter(rbit->second, k+ghostOffset);
+	// =============================================================================== //
+
+private:
+	void markBorderOctants(vector<bool> & border){
+		//the border octants are sent as ghosts to the processes owning their ghost neighbors
+		border.assign(octree.getNumOctants(),false);
+		map<int,vector<uint32_t> >::iterator bitend = bordersPerProc.end();
+		for(map<int,vector<uint32_t> >::iterator bit = bordersPerProc.begin(); bit != bitend; ++bit){
+			for(uint32_t i = 0; i < bit->second.size(); ++i){
+				border[bit->second[i]] = true;
 			}
-			ghostOffset += nofGhostFromThisProc;
 		}
-		delete [] req; req = NULL;
-		delete [] stats; stats = NULL;
+	}
 
-	};
-#endif /* NOMPI */
+public:
 	// =============================================================================== //
 
 	/** Compute the connectivity of octants and store the coordinates of nodes.
@@ -5320,13 +6297,12 @@ public:
 					int buffSize = bit->second.size() * (int)ceil((double)(sizeof(uint64_t)) / (double)(CHAR_BIT/8));
 					int key = bit->first;
 					vector<uint64_t> & value = bit->second;
-					sendBuffers[key] = Class_Comm_Buffer(buffSize,'a',comm);
-					int pos = 0;
+					sendBuffers[key] = getPoolBuffer(buffSize);
 					int nofMortons = value.size();
 					for(int i = 0; i < nofMortons; ++i){
 						//the use of auxiliary variable can be avoided passing to MPI_Pack the members of octant but octant in that case cannot be const
 						uint64_t Morton = value[i];
-						error_flag = MPI_Pack(&Morton,1,MPI_UINT64_T,sendBuffers[key].commBuffer,buffSize,&pos,comm);
+						sendBuffers[key].write(Morton);
 					}
 				}
 
@@ -5358,16 +6334,16 @@ public:
 				map<int,Class_Comm_Buffer> recvBuffers;
 				map<int,int>::iterator ritend = recvBufferSizePerProc.end();
 				for(map<int,int>::iterator rit = recvBufferSizePerProc.begin(); rit != ritend; ++rit){
-					recvBuffers[rit->first] = Class_Comm_Buffer(rit->second,'a',comm);
+					recvBuffers[rit->first] = getPoolBuffer(rit->second);
 				}
 				nReq = 0;
 				for(map<int,Class_Comm_Buffer>::iterator sit = sendBuffers.begin(); sit != sitend; ++sit){
 					nofBytesOverProc += recvBuffers[sit->first].commBufferSize;
-					error_flag = MPI_Irecv(recvBuffers[sit->first].commBuffer,recvBuffers[sit->first].commBufferSize,MPI_PACKED,sit->first,rank,comm,&req[nReq]);
+					error_flag = MPI_Irecv(recvBuffers[sit->first].commBuffer,recvBuffers[sit->first].commBufferSize,MPI_BYTE,sit->first,rank,comm,&req[nReq]);
 					++nReq;
 				}
 				for(map<int,Class_Comm_Buffer>::reverse_iterator rsit = sendBuffers.rbegin(); rsit != rsitend; ++rsit){
-					error_flag =  MPI_Isend(rsit->second.commBuffer,rsit->second.commBufferSize,MPI_PACKED,rsit->first,rsit->first,comm,&req[nReq]);
+					error_flag =  MPI_Isend(rsit->second.commBuffer,rsit->second.commBufferSize,MPI_BYTE,rsit->first,rsit->first,comm,&req[nReq]);
 					++nReq;
 				}
 				MPI_Waitall(nReq,req,stats);
@@ -5379,17 +6355,16 @@ public:
 				uint64_t Morton = 0;
 				map<int,Class_Comm_Buffer>::iterator rritend = recvBuffers.end();
 				for(map<int,Class_Comm_Buffer>::iterator rrit = recvBuffers.begin(); rrit != rritend; ++rrit){
-					int pos = 0;
 					int nofMortonPerProc = int(rrit->second.commBufferSize / (uint32_t) (sizeof(uint64_t)));
 					for(int i = 0; i < nofMortonPerProc-1; ++i){
-						error_flag = MPI_Unpack(rrit->second.commBuffer,rrit->second.commBufferSize,&pos,&Morton,1,MPI_UINT64_T,comm);
+						rrit->second.read(Morton);
 						FirstMortonReceived[rrit->first].push_back(Morton);
 						++Mortoncounter;
 					}
 				}
 
-				recvBuffers.clear();
-				sendBuffers.clear();
+				releasePoolBuffers(recvBuffers);
+				releasePoolBuffers(sendBuffers);
 				recvBufferSizePerProc.clear();
 				delete [] req; req = NULL;
 				delete [] stats; stats = NULL;
@@ -5406,13 +6381,12 @@ public:
 					int buffSize = bit->second.size() * (int)ceil((double)(sizeof(uint64_t)) / (double)(CHAR_BIT/8));
 					int key = bit->first;
 					vector<uint64_t> & value = bit->second;
-					sendBuffers[key] = Class_Comm_Buffer(buffSize,'a',comm);
-					int pos = 0;
+					sendBuffers[key] = getPoolBuffer(buffSize);
 					int nofMortons = value.size();
 					for(int i = 0; i < nofMortons; ++i){
 						//the use of auxiliary variable can be avoided passing to MPI_Pack the members of octant but octant in that case cannot be const
 						uint64_t Morton = value[i];
-						error_flag = MPI_Pack(&Morton,1,MPI_UINT64_T,sendBuffers[key].commBuffer,buffSize,&pos,comm);
+						sendBuffers[key].write(Morton);
 					}
 				}
 
@@ -5444,16 +6418,16 @@ public:
 				map<int,Class_Comm_Buffer> recvBuffers;
 				map<int,int>::iterator ritend = recvBufferSizePerProc.end();
 				for(map<int,int>::iterator rit = recvBufferSizePerProc.begin(); rit != ritend; ++rit){
-					recvBuffers[rit->first] = Class_Comm_Buffer(rit->second,'a',comm);
+					recvBuffers[rit->first] = getPoolBuffer(rit->second);
 				}
 				nReq = 0;
 				for(map<int,Class_Comm_Buffer>::iterator sit = sendBuffers.begin(); sit != sitend; ++sit){
 					nofBytesOverProc += recvBuffers[sit->first].commBufferSize;
-					error_flag = MPI_Irecv(recvBuffers[sit->first].commBuffer,recvBuffers[sit->first].commBufferSize,MPI_PACKED,sit->first,rank,comm,&req[nReq]);
+					error_flag = MPI_Irecv(recvBuffers[sit->first].commBuffer,recvBuffers[sit->first].commBufferSize,MPI_BYTE,sit->first,rank,comm,&req[nReq]);
 					++nReq;
 				}
 				for(map<int,Class_Comm_Buffer>::reverse_iterator rsit = sendBuffers.rbegin(); rsit != rsitend; ++rsit){
-					error_flag =  MPI_Isend(rsit->second.commBuffer,rsit->second.commBufferSize,MPI_PACKED,rsit->first,rsit->first,comm,&req[nReq]);
+					error_flag =  MPI_Isend(rsit->second.commBuffer,rsit->second.commBufferSize,MPI_BYTE,rsit->first,rsit->first,comm,&req[nReq]);
 					++nReq;
 				}
 				MPI_Waitall(nReq,req,stats);
@@ -5465,16 +6439,15 @@ public:
 				uint64_t Morton = 0;
 				map<int,Class_Comm_Buffer>::iterator rritend = recvBuffers.end();
 				for(map<int,Class_Comm_Buffer>::iterator rrit = recvBuffers.begin(); rrit != rritend; ++rrit){
-					int pos = 0;
 					int nofMortonPerProc = int(rrit->second.commBufferSize / (uint32_t) (sizeof(uint64_t)));
 					for(int i = 0; i < nofMortonPerProc-1; ++i){
-						error_flag = MPI_Unpack(rrit->second.commBuffer,rrit->second.commBufferSize,&pos,&Morton,1,MPI_UINT64_T,comm);
+						rrit->second.read(Morton);
 						SecondMortonReceived[rrit->first].push_back(Morton);
 						++Mortoncounter;
 					}
 				}
-				recvBuffers.clear();
-				sendBuffers.clear();
+				releasePoolBuffers(recvBuffers);
+				releasePoolBuffers(sendBuffers);
 				recvBufferSizePerProc.clear();
 				delete [] req; req = NULL;
 				delete [] stats; stats = NULL;
@@ -5548,13 +6521,12 @@ public:
 					int buffSize = bit->second.size() * (int)ceil((double)(sizeof(uint32_t)) / (double)(CHAR_BIT/8));
 					int key = bit->first;
 					vector<uint32_t> & value = bit->second;
-					sendBuffers[key] = Class_Comm_Buffer(buffSize,'a',comm);
-					int pos = 0;
+					sendBuffers[key] = getPoolBuffer(buffSize);
 					int nofIndices = value.size();
 					for(int i = 0; i < nofIndices; ++i){
 						//the use of auxiliary variable can be avoided passing to MPI_Pack the members of octant but octant in that case cannot be const
 						uint32_t Index = value[i];
-						error_flag = MPI_Pack(&Index,1,MPI_UINT32_T,sendBuffers[key].commBuffer,buffSize,&pos,comm);
+						sendBuffers[key].write(Index);
 					}
 				}
 
@@ -5586,16 +6558,16 @@ public:
 				map<int,Class_Comm_Buffer> recvBuffers;
 				map<int,int>::iterator ritend = recvBufferSizePerProc.end();
 				for(map<int,int>::iterator rit = recvBufferSizePerProc.begin(); rit != ritend; ++rit){
-					recvBuffers[rit->first] = Class_Comm_Buffer(rit->second,'a',comm);
+					recvBuffers[rit->first] = getPoolBuffer(rit->second);
 				}
 				nReq = 0;
 				for(map<int,Class_Comm_Buffer>::iterator sit = sendBuffers.begin(); sit != sitend; ++sit){
 					nofBytesOverProc += recvBuffers[sit->first].commBufferSize;
-					error_flag = MPI_Irecv(recvBuffers[sit->first].commBuffer,recvBuffers[sit->first].commBufferSize,MPI_PACKED,sit->first,rank,comm,&req[nReq]);
+					error_flag = MPI_Irecv(recvBuffers[sit->first].commBuffer,recvBuffers[sit->first].commBufferSize,MPI_BYTE,sit->first,rank,comm,&req[nReq]);
 					++nReq;
 				}
 				for(map<int,Class_Comm_Buffer>::reverse_iterator rsit = sendBuffers.rbegin(); rsit != rsitend; ++rsit){
-					error_flag =  MPI_Isend(rsit->second.commBuffer,rsit->second.commBufferSize,MPI_PACKED,rsit->first,rsit->first,comm,&req[nReq]);
+					error_flag =  MPI_Isend(rsit->second.commBuffer,rsit->second.commBufferSize,MPI_BYTE,rsit->first,rsit->first,comm,&req[nReq]);
 					++nReq;
 				}
 				MPI_Waitall(nReq,req,stats);
@@ -5607,17 +6579,16 @@ public:
 				uint32_t Index = 0;
 				map<int,Class_Comm_Buffer>::iterator rritend = recvBuffers.end();
 				for(map<int,Class_Comm_Buffer>::iterator rrit = recvBuffers.begin(); rrit != rritend; ++rrit){
-					int pos = 0;
 					int nofIndexPerProc = int(rrit->second.commBufferSize / (uint32_t) (sizeof(uint32_t)));
 					for(int i = 0; i < nofIndexPerProc-1; ++i){
-						error_flag = MPI_Unpack(rrit->second.commBuffer,rrit->second.commBufferSize,&pos,&Index,1,MPI_UINT32_T,comm);
+						rrit->second.read(Index);
 						mapper[FirstLocalIndex[rrit->first][i]].first.first = Index;
 						++Indexcounter;
 					}
 
 				}
-				recvBuffers.clear();
-				sendBuffers.clear();
+				releasePoolBuffers(recvBuffers);
+				releasePoolBuffers(sendBuffers);
 				recvBufferSizePerProc.clear();
 				delete [] req; req = NULL;
 				delete [] stats; stats = NULL;
@@ -5633,13 +6604,12 @@ public:
 					int buffSize = bit->second.size() * (int)ceil((double)(sizeof(uint32_t)) / (double)(CHAR_BIT/8));
 					int key = bit->first;
 					vector<uint32_t> & value = bit->second;
-					sendBuffers[key] = Class_Comm_Buffer(buffSize,'a',comm);
-					int pos = 0;
+					sendBuffers[key] = getPoolBuffer(buffSize);
 					int nofIndices = value.size();
 					for(int i = 0; i < nofIndices; ++i){
 						//the use of auxiliary variable can be avoided passing to MPI_Pack the members of octant but octant in that case cannot be const
-						uint64_t Index = value[i];
-						error_flag = MPI_Pack(&Index,1,MPI_UINT32_T,sendBuffers[key].commBuffer,buffSize,&pos,comm);
+						uint32_t Index = value[i];
+						sendBuffers[key].write(Index);
 					}
 				}
 
@@ -5671,16 +6641,16 @@ public:
 				map<int,Class_Comm_Buffer> recvBuffers;
 				map<int,int>::iterator ritend = recvBufferSizePerProc.end();
 				for(map<int,int>::iterator rit = recvBufferSizePerProc.begin(); rit != ritend; ++rit){
-					recvBuffers[rit->first] = Class_Comm_Buffer(rit->second,'a',comm);
+					recvBuffers[rit->first] = getPoolBuffer(rit->second);
 				}
 				nReq = 0;
 				for(map<int,Class_Comm_Buffer>::iterator sit = sendBuffers.begin(); sit != sitend; ++sit){
 					nofBytesOverProc += recvBuffers[sit->first].commBufferSize;
-					error_flag = MPI_Irecv(recvBuffers[sit->first].commBuffer,recvBuffers[sit->first].commBufferSize,MPI_PACKED,sit->first,rank,comm,&req[nReq]);
+					error_flag = MPI_Irecv(recvBuffers[sit->first].commBuffer,recvBuffers[sit->first].commBufferSize,MPI_BYTE,sit->first,rank,comm,&req[nReq]);
 					++nReq;
 				}
 				for(map<int,Class_Comm_Buffer>::reverse_iterator rsit = sendBuffers.rbegin(); rsit != rsitend; ++rsit){
-					error_flag =  MPI_Isend(rsit->second.commBuffer,rsit->second.commBufferSize,MPI_PACKED,rsit->first,rsit->first,comm,&req[nReq]);
+					error_flag =  MPI_Isend(rsit->second.commBuffer,rsit->second.commBufferSize,MPI_BYTE,rsit->first,rsit->first,comm,&req[nReq]);
 					++nReq;
 				}
 				MPI_Waitall(nReq,req,stats);
@@ -5692,16 +6662,15 @@ public:
 				uint32_t Index = 0;
 				map<int,Class_Comm_Buffer>::iterator rritend = recvBuffers.end();
 				for(map<int,Class_Comm_Buffer>::iterator rrit = recvBuffers.begin(); rrit != rritend; ++rrit){
-					int pos = 0;
 					int nofIndexPerProc = int(rrit->second.commBufferSize / (uint32_t) (sizeof(uint32_t)));
 					for(int i = 0; i < nofIndexPerProc-1; ++i){
-						error_flag = MPI_Unpack(rrit->second.commBuffer,rrit->second.commBufferSize,&pos,&Index,1,MPI_UINT32_T,comm);
+						rrit->second.read(Index);
 						mapper[SecondLocalIndex[rrit->first][i]].first.second = Index;
 						++Indexcounter;
 					}
 				}
-				recvBuffers.clear();
-				sendBuffers.clear();
+				releasePoolBuffers(recvBuffers);
+				releasePoolBuffers(sendBuffers);
 				recvBufferSizePerProc.clear();
 				delete [] req; req = NULL;
 				delete [] stats; stats = NULL;
@@ -5720,6 +6689,10 @@ public:
 	 * \param[in] filename Seriously?....
 	 */
 	void writeLogical(string filename) {
+#if NOMPI==0
+		if(!isActive())
+			return;
+#endif
 
 		bool clear = false;
 		if (octree.connectivity.size() == 0) {
@@ -5881,6 +6854,10 @@ public:
 	 * \param[in] filename Seriously?....
 	 */
 	void write(string filename) {
+#if NOMPI==0
+		if(!isActive())
+			return;
+#endif
 
 		bool clear = false;
 		if (octree.connectivity.size() == 0) {
@@ -6043,6 +7020,10 @@ public:
 	 * \param[in] filename Seriously?....
 	 */
 	void writeTest(string filename, vector<double> data) {
+#if NOMPI==0
+		if(!isActive())
+			return;
+#endif
 
 		bool clear = false;
 		if (octree.connectivity.size() == 0) {
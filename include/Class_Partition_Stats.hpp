@@ -0,0 +1,96 @@
+#ifndef CLASS_PARTITION_STATS_HPP_
+#define CLASS_PARTITION_STATS_HPP_
+
+// =================================================================================== //
+// INCLUDES                                                                            //
+// =================================================================================== //
+#if NOMPI==0
+#include <mpi.h>
+#endif
+#include <stdint.h>
+#include <algorithm>
+
+// =================================================================================== //
+// NAME SPACES                                                                         //
+// =================================================================================== //
+using namespace std;
+
+// =================================================================================== //
+// CLASS DEFINITION                                                                    //
+// =================================================================================== //
+
+/*!
+ *	\brief Quality metrics of the partition of a parallel octree
+ *
+ *	Every metric holds the value of the local process and its minimum, maximum and
+ *	mean over the processes; the imbalance max/mean tells how far the partition is
+ *	from the ideal one (1). The metrics are filled by Class_Para_Tree::getPartitionStats
+ *	with a single reduction of all the local values.
+ */
+class Class_Partition_Stats {
+
+	template<int dim> friend class Class_Para_Tree;
+
+	// ------------------------------------------------------------------------------- //
+	// TYPES ------------------------------------------------------------------------- //
+public:
+	/*! Value of a metric on the local process and over the processes. */
+	struct Metric {
+		double local;		/**< Value on the local process */
+		double min;			/**< Minimum over the processes */
+		double max;			/**< Maximum over the processes */
+		double mean;		/**< Mean over the processes */
+
+		/*! Imbalance max/mean of the metric (1 if the mean is 0).
+		 */
+		double imbalance() const{
+			return (mean > 0.0) ? max/mean : 1.0;
+		};
+	};
+
+	// ------------------------------------------------------------------------------- //
+	// MEMBERS ----------------------------------------------------------------------- //
+	static const int nofMetrics = 6;	/**< Number of metrics */
+
+	Metric	octants;		/**< Number of local octants */
+	Metric	weight;			/**< Weight of the local octants (cost or number of octants) */
+	Metric	ghosts;			/**< Number of ghost octants */
+	Metric	neighbors;		/**< Number of neighbor processes */
+	Metric	commBytes;		/**< Bytes sent by one communicate of the ghost data */
+	Metric	nodeBytes;		/**< Bytes sent to the processes of other compute nodes by one communicate */
+
+	// ------------------------------------------------------------------------------- //
+	// CONSTRUCTORS ------------------------------------------------------------------ //
+public:
+	Class_Partition_Stats(){
+		Metric zero = {0.0, 0.0, 0.0, 0.0};
+		octants = weight = ghosts = neighbors = commBytes = nodeBytes = zero;
+	};
+
+	// ------------------------------------------------------------------------------- //
+	// METHODS ----------------------------------------------------------------------- //
+private:
+	/*! Metrics in a fixed order, to be filled and reduced as an array.
+	 */
+	Metric* getMetric(int i){
+		Metric* metrics[nofMetrics] = {&octants, &weight, &ghosts, &neighbors, &commBytes, &nodeBytes};
+		return metrics[i];
+	};
+
+#if NOMPI==0
+	/*! Reduction operator of the triples (min, max, sum) of the metrics,
+	 * to be used with a datatype of three contiguous doubles.
+	 */
+	static void reduce(void* in, void* inout, int* len, MPI_Datatype* datatype){
+		double* a = static_cast<double*>(in);
+		double* b = static_cast<double*>(inout);
+		for (int i = 0; i < *len; i++){
+			b[3*i] = std::min(a[3*i], b[3*i]);
+			b[3*i+1] = std::max(a[3*i+1], b[3*i+1]);
+			b[3*i+2] += a[3*i+2];
+		}
+	};
+#endif
+};
+
+#endif /* CLASS_PARTITION_STATS_HPP_ */
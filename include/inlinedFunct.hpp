@@ -38,6 +38,40 @@ inline uint64_t mortonEncode_magicbits(unsigned int x, unsigned int y){
 }
 
 
+// inverse of splitBy3: gather every third bit of a given integer
+inline unsigned int compactBy3(uint64_t a){
+	uint64_t x = a & 0x1249249249249249;
+	x = (x | x >> 2) & 0x10c30c30c30c30c3;
+	x = (x | x >> 4) & 0x100f00f00f00f00f;
+	x = (x | x >> 8) & 0x1f0000ff0000ff;
+	x = (x | x >> 16) & 0x1f00000000ffff;
+	x = (x | x >> 32) & 0x1fffff;
+	return (unsigned int)x;
+}
+
+inline void mortonDecode_magicbits(uint64_t morton, unsigned int & x, unsigned int & y, unsigned int & z){
+	x = compactBy3(morton);
+	y = compactBy3(morton >> 1);
+	z = compactBy3(morton >> 2);
+}
+
+// inverse of splitBy2: gather every second bit of a given integer
+inline unsigned int compactBy2(uint64_t a){
+	uint64_t x = a & 0x5555555555555555;
+	x = (x | x >> 1) & 0x3333333333333333;
+	x = (x | x >> 2) & 0xF0F0F0F0F0F0F0F;
+	x = (x | x >> 4) & 0xFF00FF00FF00FF;
+	x = (x | x >> 8) & 0xFFFF0000FFFF;
+	x = (x | x >> 16) & 0xFFFFFFFF;
+	return (unsigned int)x;
+}
+
+inline void mortonDecode_magicbits(uint64_t morton, unsigned int & x, unsigned int & y){
+	x = compactBy2(morton);
+	y = compactBy2(morton >> 1);
+}
+
+
 
 inline uint64_t keyXY(uint64_t x, uint64_t y){
 	uint64_t answer = 0;
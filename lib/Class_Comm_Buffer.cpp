@@ -4,6 +4,7 @@
 Class_Comm_Buffer::Class_Comm_Buffer(){
 
 	commBufferSize = 0;
+	commBufferCapacity = 0;
 	commBuffer = NULL;
 	pos = 0;
 	comm = MPI_COMM_WORLD;
@@ -12,31 +13,50 @@ Class_Comm_Buffer::Class_Comm_Buffer(){
 Class_Comm_Buffer::Class_Comm_Buffer(MPI_Comm comm_) : comm(comm_){
 
 	commBufferSize = 0;
+	commBufferCapacity = 0;
 	commBuffer = NULL;
 	pos = 0;
 }
 
+Class_Comm_Buffer::Class_Comm_Buffer(uint32_t size, MPI_Comm comm_) : comm(comm_){
+
+	commBufferSize = size;
+	commBufferCapacity = size;
+	commBuffer = new char [size];
+	pos = 0;
+}
+
 Class_Comm_Buffer::Class_Comm_Buffer(uint32_t size, char value, MPI_Comm comm_) : comm(comm_){
 
 	commBufferSize = size;
+	commBufferCapacity = size;
 	commBuffer = new char [size];
-	for(uint32_t i = 0; i < size; ++i)
-		commBuffer[i] = value;
+	memset(commBuffer,value,size);
 	pos = 0;
 }
 
 Class_Comm_Buffer::Class_Comm_Buffer(const Class_Comm_Buffer& other) {
 
 	commBufferSize = other.commBufferSize;
-	//	if(commBuffer != NULL){
-	//		delete [] commBuffer;
-	//		commBuffer = NULL;
-	//	}
+	commBufferCapacity = other.commBufferSize;
 	commBuffer = new char [commBufferSize];
-	for(uint32_t i = 0; i < commBufferSize; ++i)
-		commBuffer[i] = other.commBuffer[i];
+	if(commBufferSize)
+		memcpy(commBuffer,other.commBuffer,commBufferSize);
+	pos = other.pos;
+	comm = other.comm;
+}
+
+Class_Comm_Buffer::Class_Comm_Buffer(Class_Comm_Buffer&& other) noexcept {
+
+	commBufferSize = other.commBufferSize;
+	commBufferCapacity = other.commBufferCapacity;
+	commBuffer = other.commBuffer;
 	pos = other.pos;
 	comm = other.comm;
+	other.commBufferSize = 0;
+	other.commBufferCapacity = 0;
+	other.commBuffer = NULL;
+	other.pos = 0;
 }
 
 Class_Comm_Buffer::~Class_Comm_Buffer() {
@@ -47,17 +67,41 @@ Class_Comm_Buffer::~Class_Comm_Buffer() {
 Class_Comm_Buffer& Class_Comm_Buffer::operator =(const Class_Comm_Buffer& rhs) {
 	if(this != &rhs)
 	{
-		char* new_array = new char[rhs.commBufferSize];
-		copy(rhs.commBuffer,rhs.commBuffer+rhs.commBufferSize,new_array);
+		resize(rhs.commBufferSize);
+		if(commBufferSize)
+			memcpy(commBuffer,rhs.commBuffer,commBufferSize);
+		pos = rhs.pos;
+		comm = rhs.comm;
+	}
+	return *this;
 
-		delete [] commBuffer;
+}
 
-		commBuffer = new_array;
+Class_Comm_Buffer& Class_Comm_Buffer::operator =(Class_Comm_Buffer&& rhs) noexcept {
+	if(this != &rhs)
+	{
+		delete [] commBuffer;
+		commBuffer = rhs.commBuffer;
 		commBufferSize = rhs.commBufferSize;
+		commBufferCapacity = rhs.commBufferCapacity;
 		pos = rhs.pos;
 		comm = rhs.comm;
+		rhs.commBuffer = NULL;
+		rhs.commBufferSize = 0;
+		rhs.commBufferCapacity = 0;
+		rhs.pos = 0;
 	}
 	return *this;
 
 }
+
+void Class_Comm_Buffer::resize(uint32_t size) {
+	if(size > commBufferCapacity){
+		delete [] commBuffer;
+		commBuffer = new char [size];
+		commBufferCapacity = size;
+	}
+	commBufferSize = size;
+	pos = 0;
+}
 #endif
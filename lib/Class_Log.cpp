@@ -48,6 +48,9 @@ void Class_Log::writeLog(string msg) {
 
 	int rank = 0;
 #if NOMPI==0
+	// no log on a process out of the communicator (idle process of a tree)
+	if(comm == MPI_COMM_NULL)
+		return;
 	int error_flag = MPI_Comm_rank(comm,&rank);
 #endif
 	if(rank == 0){
@@ -66,3 +69,13 @@ void Class_Log::writeLog(string msg) {
 	error_flag = MPI_Barrier(comm);
 #endif
 	return; };
+
+// ----------------------------------------------------------------------------------- //
+#if NOMPI==0
+void Class_Log::setComm(MPI_Comm comm_) {
+
+	// Communicator of the processes sharing the log, MPI_COMM_NULL for a process
+	// out of the communicator (it writes no log)
+	comm = comm_;
+};
+#endif
@@ -34,13 +34,9 @@ inline void User_Data_LB<D>::scatter(Buffer& buff, const uint32_t e) {
 
 template<class D>
 inline void User_Data_LB<D>::assign(uint32_t stride, uint32_t length) {
-	Data dataCopy = data;
-	typename Data::iterator first = dataCopy.begin() + stride;
-	typename Data::iterator last = first + length;
-	data.assign(first,last);
+	data.erase(data.begin() + stride + length, data.end());
+	data.erase(data.begin(), data.begin() + stride);
 	data.shrink_to_fit();
-	first = dataCopy.end();
-	last = dataCopy.end();
 };
 
 template<class D>
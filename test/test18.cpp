@@ -0,0 +1,62 @@
+#include "preprocessor_defines.dat"
+#include "Class_Global.hpp"
+#include "Class_Para_Tree.hpp"
+
+using namespace std;
+
+// =================================================================================== //
+
+int main(int argc, char *argv[]) {
+
+#if NOMPI==0
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		/**<Instantation of a 2D para_tree object.*/
+		Class_Para_Tree<2> pablo18;
+
+		/**<Refine globally two level and write the para_tree.*/
+		for (int iter=1; iter<3; iter++){
+			pablo18.adaptGlobalRefine();
+		}
+#if NOMPI==0
+		/**<PARALLEL TEST: Call loadBalance, the octree is now distributed over the processes.*/
+		pablo18.loadBalance();
+#endif
+		pablo18.updateConnectivity();
+		pablo18.write("Pablo18_iter2");
+
+		/**<Define a center point and a radius.*/
+		double xc, yc;
+		xc = yc = 0.5;
+		double radius = 0.4;
+
+		/**<Define the marker functor: refine the octants with at least one node inside the circle.
+		 * The functor receives the geometry of each octant directly from PABLO (no temporaries).*/
+		auto marker = [&](uint32_t idx, const double center[3], const double nodes[][3], uint8_t level) -> int8_t {
+			for (int j=0; j<global2D.nnodes; j++){
+				double x = nodes[j][0];
+				double y = nodes[j][1];
+				if ((pow((x-xc),2.0)+pow((y-yc),2.0) <= pow(radius,2.0))){
+					return 1;
+				}
+			}
+			return 0;
+		};
+
+		/**<Functor-driven adapt() 6 times.*/
+		for (int iter=3; iter<9; iter++){
+			/**<Evaluate the markers and adapt octree.*/
+			pablo18.adapt(marker);
+
+			/**<Update the connectivity and write the para_tree.*/
+			pablo18.updateConnectivity();
+			pablo18.write("Pablo18_iter"+to_string(iter));
+		}
+#if NOMPI==0
+	}
+
+	MPI::Finalize();
+#endif
+}
@@ -0,0 +1,73 @@
+#include "preprocessor_defines.dat"
+#include "Class_Global.hpp"
+#include "Class_Para_Tree.hpp"
+
+using namespace std;
+
+// =================================================================================== //
+
+int main(int argc, char *argv[]) {
+
+#if NOMPI==0
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		/**<Instantation of a 2D para_tree object.*/
+		Class_Para_Tree<2> pablo19;
+
+		/**<Refine globally four level.*/
+		for (int iter=1; iter<5; iter++){
+			pablo19.adaptGlobalRefine();
+		}
+
+		/**<Define a center point and a radius.*/
+		double xc, yc;
+		xc = yc = 0.5;
+		double radius = 0.25;
+
+		/**<Define the user fields: a smooth function of the octant center (averaged in coarsening)
+		 * and the area of the octants (volume-weighted, i.e. split in refinement and summed in coarsening).*/
+		uint32_t nocts = pablo19.getNumOctants();
+		vector<double> phi(nocts), area(nocts);
+		for (int i=0; i<nocts; i++){
+			vector<double> center = pablo19.getCenter(i);
+			phi[i] = sqrt(pow((center[0]-xc),2.0)+pow((center[1]-yc),2.0)) - radius;
+			area[i] = pablo19.getVolume(i);
+		}
+
+		/**<Register the fields, they are projected by adapt in the same pass that rewrites the octants.*/
+		Class_Data_Fields fields;
+		fields.addField<ADAPT_AVERAGE>(phi);
+		fields.addField<ADAPT_VOLUME>(area);
+
+		/**<Refine the octants crossed by the circle and coarse the others 5 times.*/
+		for (int iter=0; iter<5; iter++){
+			nocts = pablo19.getNumOctants();
+			for (int i=0; i<nocts; i++){
+				double size = pablo19.getSize(i);
+				if (fabs(phi[i]) < size){
+					pablo19.setMarker(i, 1);
+				}
+				else if (pablo19.getLevel(i) > 2){
+					pablo19.setMarker(i, -1);
+				}
+			}
+			pablo19.adapt(fields);
+
+			/**<The total area is preserved by the projection.*/
+			double totArea = 0.0;
+			for (int i=0; i<pablo19.getNumOctants(); i++){
+				totArea += area[i];
+			}
+			pablo19.log.writeLog(" Total area of the octants : " + to_string(totArea));
+		}
+		pablo19.updateConnectivity();
+		pablo19.write("Pablo19");
+
+#if NOMPI==0
+	}
+
+	MPI::Finalize();
+#endif
+}
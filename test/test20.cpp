@@ -0,0 +1,51 @@
+#include "preprocessor_defines.dat"
+#include "Class_Global.hpp"
+#include "Class_Para_Tree.hpp"
+
+using namespace std;
+
+// =================================================================================== //
+
+int main(int argc, char *argv[]) {
+
+#if NOMPI==0
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		/**<Instantation of a 3D para_tree object.*/
+		Class_Para_Tree<3> pablo20;
+
+		/**<Build directly the uniform octree of level 5: each process generates only its own
+		 * partition in Morton order, no global refinement and no loadBalance are needed.*/
+		pablo20.buildUniform(5);
+		pablo20.updateConnectivity();
+		pablo20.write("Pablo20_iter0");
+
+		/**<Define a center point and a radius.*/
+		double xc, yc, zc;
+		xc = yc = zc = 0.5;
+		double radius = 0.25;
+
+		/**<Refine the octants with the center inside the sphere.*/
+		for (int iter=1; iter<3; iter++){
+			uint32_t nocts = pablo20.getNumOctants();
+			for (uint32_t i=0; i<nocts; i++){
+				vector<double> center = pablo20.getCenter(i);
+				if ((pow((center[0]-xc),2.0)+pow((center[1]-yc),2.0)+pow((center[2]-zc),2.0) <= pow(radius,2.0))){
+					pablo20.setMarker(i, 1);
+				}
+			}
+			pablo20.adapt();
+#if NOMPI==0
+			pablo20.loadBalance();
+#endif
+			pablo20.updateConnectivity();
+			pablo20.write("Pablo20_iter"+to_string(iter));
+		}
+#if NOMPI==0
+	}
+
+	MPI::Finalize();
+#endif
+}
@@ -0,0 +1,124 @@
+#include "preprocessor_defines.dat"
+#include "Class_Global.hpp"
+#include "Class_Para_Tree.hpp"
+#include "User_Data_Comm.hpp"
+
+using namespace std;
+
+// =================================================================================== //
+
+int main(int argc, char *argv[]) {
+
+#if NOMPI==0
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		int iter = 0;
+		int dim = 2;
+
+		/**<Instantation of a 2D para_tree object.*/
+		Class_Para_Tree<2> pablo21;
+
+		/**<Refine globally five level.*/
+		for (iter=1; iter<6; iter++){
+			pablo21.adaptGlobalRefine();
+		}
+
+#if NOMPI==0
+		/**<PARALLEL TEST: Call loadBalance, the octree is now distributed over the processes.*/
+		pablo21.loadBalance();
+#endif
+
+		/**<Define a center point and a radius.*/
+		double xc, yc;
+		xc = yc = 0.5;
+		double radius = 0.25;
+
+		/**<Define vectors of data.*/
+		uint32_t nocts = pablo21.getNumOctants();
+		uint32_t nghosts = pablo21.getNumGhosts();
+		vector<double> oct_data(nocts, 0.0), ghost_data(nghosts, 0.0);
+
+		/**<Assign a data to the octants with the center inside the circle.*/
+		for (int i=0; i<nocts; i++){
+			vector<double> center = pablo21.getCenter(i);
+			if ((pow((center[0]-xc),2.0)+pow((center[1]-yc),2.0) <= pow(radius,2.0))){
+				oct_data[i] = 1.0;
+			}
+		}
+
+		/**<Split the octants: the interior ones have no ghost neighbours, the border ones need the ghost data.*/
+		vector<uint32_t> interior = pablo21.getInteriorOctants();
+		vector<uint32_t> border = pablo21.getBorderOctants();
+
+		/**<Store the one ring neighbours of the octants (faces and nodes).*/
+		vector<vector<uint32_t> > neigh(nocts);
+		vector<vector<bool> > isghost(nocts);
+		vector<uint32_t> neigh_t;
+		vector<bool> isghost_t;
+		uint8_t iface, nfaces, codim;
+		for (int i=0; i<nocts; i++){
+			for (codim=1; codim<dim+1; codim++){
+				nfaces = (codim == 1) ? global2D.nfaces : global2D.nnodes;
+				for (iface=0; iface<nfaces; iface++){
+					pablo21.findNeighbours(i,iface,codim,neigh_t,isghost_t);
+					neigh[i].insert(neigh[i].end(), neigh_t.begin(), neigh_t.end());
+					isghost[i].insert(isghost[i].end(), isghost_t.begin(), isghost_t.end());
+				}
+			}
+		}
+
+		/**<User data communicator of the octant data to the ghost data.*/
+		User_Data_Comm<vector<double> > data_comm(oct_data, ghost_data);
+
+		/**<Smoothing iterations: the interior octants are smoothed while the ghost data are communicated.*/
+		vector<double> oct_data_smooth(nocts, 0.0);
+		for (iter=1; iter<26; iter++){
+#if NOMPI==0
+			/**<Start the communication of the data of the border octants.*/
+			pablo21.communicateBegin(data_comm);
+#endif
+
+			/**<Smoothing the interior octants (no ghost data needed).*/
+			for (int k=0; k<interior.size(); k++){
+				uint32_t i = interior[k];
+				oct_data_smooth[i] = oct_data[i]/(neigh[i].size()+1);
+				for (int j=0; j<neigh[i].size(); j++){
+					oct_data_smooth[i] += oct_data[neigh[i][j]]/(neigh[i].size()+1);
+				}
+			}
+
+#if NOMPI==0
+			/**<Complete the communication, the ghost data are updated.*/
+			pablo21.communicateEnd(data_comm);
+#endif
+
+			/**<Smoothing the border octants.*/
+			for (int k=0; k<border.size(); k++){
+				uint32_t i = border[k];
+				oct_data_smooth[i] = oct_data[i]/(neigh[i].size()+1);
+				for (int j=0; j<neigh[i].size(); j++){
+					if (isghost[i][j]){
+						oct_data_smooth[i] += ghost_data[neigh[i][j]]/(neigh[i].size()+1);
+					}
+					else{
+						oct_data_smooth[i] += oct_data[neigh[i][j]]/(neigh[i].size()+1);
+					}
+				}
+			}
+
+			oct_data = oct_data_smooth;
+		}
+
+		/**<Update the connectivity and write the para_tree.*/
+		pablo21.updateConnectivity();
+		pablo21.writeTest("Pablo21_iter"+to_string(iter), oct_data);
+
+#if NOMPI==0
+	}
+
+	MPI::Finalize();
+#endif
+}
+
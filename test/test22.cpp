@@ -0,0 +1,59 @@
+#include "preprocessor_defines.dat"
+#include "Class_Global.hpp"
+#include "Class_Para_Tree.hpp"
+#include "User_Data_LB.hpp"
+
+using namespace std;
+
+// =================================================================================== //
+
+int main(int argc, char *argv[]) {
+
+#if NOMPI==0
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		int iter = 0;
+
+		/**<Instantation of a 2D para_tree object.*/
+		Class_Para_Tree<2> pablo22;
+
+		/**<Refine globally five level.*/
+		for (iter=1; iter<6; iter++){
+			pablo22.adaptGlobalRefine();
+		}
+
+		/**<Define a center point and a radius.*/
+		double xc, yc;
+		xc = yc = 0.5;
+		double radius = 0.25;
+
+		/**<Define the computational cost of the octants: the octants inside the circle cost ten times more.*/
+		uint32_t nocts = pablo22.getNumOctants();
+		vector<double> weights(nocts, 1.0);
+		for (int i=0; i<nocts; i++){
+			vector<double> center = pablo22.getCenter(i);
+			if ((pow((center[0]-xc),2.0)+pow((center[1]-yc),2.0) <= pow(radius,2.0))){
+				weights[i] = 10.0;
+			}
+		}
+
+#if NOMPI==0
+		/**<PARALLEL TEST: Call weighted loadBalance, the octree is now distributed over the processes
+		 * with the same total cost on each process. The weights are migrated as user data.*/
+		User_Data_LB<vector<double> > weights_lb(weights);
+		pablo22.loadBalance(weights_lb, weights);
+#endif
+
+		/**<Update the connectivity and write the para_tree.*/
+		pablo22.updateConnectivity();
+		pablo22.writeTest("Pablo22_iter0", weights);
+
+#if NOMPI==0
+	}
+
+	MPI::Finalize();
+#endif
+}
+
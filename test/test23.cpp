@@ -0,0 +1,84 @@
+#include "preprocessor_defines.dat"
+#include "Class_Global.hpp"
+#include "Class_Para_Tree.hpp"
+
+using namespace std;
+
+// =================================================================================== //
+
+int main(int argc, char *argv[]) {
+
+#if NOMPI==0
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		int iter = 0;
+
+		/**<Instantation of a 2D para_tree object.*/
+		Class_Para_Tree<2> pablo23;
+
+		/**<Refine globally four level and distribute the octree.*/
+		for (iter=1; iter<5; iter++){
+			pablo23.adaptGlobalRefine();
+		}
+#if NOMPI==0
+		pablo23.loadBalance();
+#endif
+
+		/**<Define a center point and a radius.*/
+		double xc, yc;
+		xc = yc = 0.5;
+		double radius = 0.25;
+
+		/**<Measure the computational cost of the octants: the costs are projected by adapt,
+		 * migrated by loadBalance and used by loadBalance as weights of the partition.*/
+		pablo23.enableCostTracking(0.5);
+
+		for (iter=0; iter<4; iter++){
+
+			/**<Work on the octants: the octants inside the circle are ten times more expensive.*/
+			uint32_t nocts = pablo23.getNumOctants();
+			for (uint32_t i=0; i<nocts; i++){
+				pablo23.startOctantTimer();
+				vector<double> center = pablo23.getCenter(i);
+				int nwork = (pow((center[0]-xc),2.0)+pow((center[1]-yc),2.0) <= pow(radius,2.0)) ? 20000 : 2000;
+				volatile double work = 0.0;
+				for (int k=0; k<nwork; k++){
+					work = work + sqrt(double(k));
+				}
+				pablo23.stopOctantTimer(i);
+			}
+
+			/**<Refine the octants on the circle boundary.*/
+			for (uint32_t i=0; i<nocts; i++){
+				vector<vector<double> > nodes = pablo23.getNodes(i);
+				bool inside = false, outside = false;
+				for (int j=0; j<global2D.nnodes; j++){
+					double dist = pow((nodes[j][0]-xc),2.0)+pow((nodes[j][1]-yc),2.0);
+					inside = inside || (dist <= pow(radius,2.0));
+					outside = outside || (dist > pow(radius,2.0));
+				}
+				if (inside && outside && pablo23.getLevel(i) < 7){
+					pablo23.setMarker(i,1);
+				}
+			}
+			pablo23.adapt();
+
+#if NOMPI==0
+			/**<Load balance by the measured costs.*/
+			pablo23.loadBalance();
+#endif
+		}
+
+		/**<Update the connectivity and write the para_tree with the octant costs.*/
+		pablo23.updateConnectivity();
+		vector<double> cost = pablo23.getOctantCost();
+		pablo23.writeTest("Pablo23_iter0", cost);
+
+#if NOMPI==0
+	}
+
+	MPI::Finalize();
+#endif
+}
@@ -0,0 +1,80 @@
+#include "preprocessor_defines.dat"
+#include "Class_Global.hpp"
+#include "Class_Para_Tree.hpp"
+
+using namespace std;
+
+// =================================================================================== //
+
+int main(int argc, char *argv[]) {
+
+#if NOMPI==0
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		int iter = 0;
+
+		/**<Instantation of a 2D para_tree object.*/
+		Class_Para_Tree<2> pablo24;
+
+		/**<Refine globally five level and distribute the octree.*/
+		for (iter=1; iter<6; iter++){
+			pablo24.adaptGlobalRefine();
+		}
+#if NOMPI==0
+		pablo24.loadBalance();
+#endif
+
+		/**<Define a center point and a radius.*/
+		double xc, yc;
+		xc = yc = 0.5;
+		double radius = 0.25;
+
+		/**<Refine twice the octants on the circle boundary.*/
+		for (iter=0; iter<2; iter++){
+			uint32_t nocts = pablo24.getNumOctants();
+			for (uint32_t i=0; i<nocts; i++){
+				vector<vector<double> > nodes = pablo24.getNodes(i);
+				bool inside = false, outside = false;
+				for (int j=0; j<global2D.nnodes; j++){
+					double dist = pow((nodes[j][0]-xc),2.0)+pow((nodes[j][1]-yc),2.0);
+					inside = inside || (dist <= pow(radius,2.0));
+					outside = outside || (dist > pow(radius,2.0));
+				}
+				if (inside && outside){
+					pablo24.setMarker(i,1);
+				}
+			}
+			pablo24.adapt();
+		}
+
+#if NOMPI==0
+		/**<Flat partition: the octants are split evenly over the processes.*/
+		pablo24.loadBalance();
+		Class_Partition_Stats flat = pablo24.getPartitionStats();
+
+		/**<Node-aware partition: the octants are split over the compute nodes, with the families
+		 * of the last two levels kept on the same node, and then over the processes of every node.*/
+		pablo24.setNodeAware(true, 2);
+		pablo24.loadBalance();
+		Class_Partition_Stats node = pablo24.getPartitionStats();
+
+		/**<Compare the bytes sent to other compute nodes by one communicate of a double per octant.*/
+		if (pablo24.rank == 0){
+			cout << "inter-node bytes: flat " << flat.nodeBytes.mean*pablo24.nproc
+					<< ", node-aware " << node.nodeBytes.mean*pablo24.nproc
+					<< " (imbalance " << node.octants.imbalance() << ")" << endl;
+		}
+#endif
+
+		/**<Write the para_tree.*/
+		pablo24.updateConnectivity();
+		pablo24.write("Pablo24_iter0");
+
+#if NOMPI==0
+	}
+
+	MPI::Finalize();
+#endif
+}
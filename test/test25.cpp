@@ -0,0 +1,87 @@
+#include "preprocessor_defines.dat"
+#include "Class_Global.hpp"
+#include "Class_Para_Tree.hpp"
+
+using namespace std;
+
+// =================================================================================== //
+
+/**<Mark for two refinements the octants with center in the lower left corner of the domain.*/
+void setCornerMarkers(Class_Para_Tree<2> & pablo){
+	uint32_t nocts = pablo.getNumOctants();
+	for (uint32_t i=0; i<nocts; i++){
+		vector<double> center = pablo.getCenter(i);
+		if (center[0] < 0.3 && center[1] < 0.3){
+			pablo.setMarker(i,2);
+		}
+	}
+}
+
+// =================================================================================== //
+
+int main(int argc, char *argv[]) {
+
+#if NOMPI==0
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		int iter = 0;
+
+		/**<Instantation of two 2D para_tree objects.*/
+		Class_Para_Tree<2> pablo25;
+		Class_Para_Tree<2> pablo25p;
+
+		/**<Refine globally four level and distribute the octrees.*/
+		for (iter=1; iter<5; iter++){
+			pablo25.adaptGlobalRefine();
+			pablo25p.adaptGlobalRefine();
+		}
+#if NOMPI==0
+		pablo25.loadBalance();
+		pablo25p.loadBalance();
+#endif
+
+		/**<Classic sequence: adapt and then load balance the refined octree.*/
+		setCornerMarkers(pablo25);
+		pablo25.adapt();
+#if NOMPI==0
+		uint32_t peak = pablo25.getNumOctants();
+		pablo25.loadBalance();
+		uint64_t migrated = pablo25.getMigratedOctants();
+
+		/**<Predictive sequence: load balance the octants weighted by their markers and then adapt.*/
+		setCornerMarkers(pablo25p);
+		pablo25p.loadBalanceMarkers();
+		uint64_t migratedp = pablo25p.getMigratedOctants();
+		pablo25p.adapt();
+		uint32_t peakp = pablo25p.getNumOctants();
+
+		/**<Compare the maximum number of octants held by a process and the migrated octants.*/
+		uint32_t maxPeak, maxPeakp;
+		uint64_t sumMigrated, sumMigratedp;
+		MPI_Reduce(&peak, &maxPeak, 1, MPI_UINT32_T, MPI_MAX, 0, MPI_COMM_WORLD);
+		MPI_Reduce(&peakp, &maxPeakp, 1, MPI_UINT32_T, MPI_MAX, 0, MPI_COMM_WORLD);
+		MPI_Reduce(&migrated, &sumMigrated, 1, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+		MPI_Reduce(&migratedp, &sumMigratedp, 1, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+		Class_Partition_Stats stats = pablo25p.getPartitionStats();
+		if (pablo25.rank == 0){
+			cout << "classic: max octants " << maxPeak << ", migrated " << sumMigrated << endl;
+			cout << "predictive: max octants " << maxPeakp << ", migrated " << sumMigratedp
+					<< " (imbalance " << stats.octants.imbalance() << ")" << endl;
+		}
+#else
+		setCornerMarkers(pablo25p);
+		pablo25p.adapt();
+#endif
+
+		/**<Write the para_tree.*/
+		pablo25p.updateConnectivity();
+		pablo25p.write("Pablo25_iter0");
+
+#if NOMPI==0
+	}
+
+	MPI::Finalize();
+#endif
+}
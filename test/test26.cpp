@@ -0,0 +1,86 @@
+#include "preprocessor_defines.dat"
+#include "Class_Global.hpp"
+#include "Class_Para_Tree.hpp"
+
+using namespace std;
+
+// =================================================================================== //
+
+int main(int argc, char *argv[]) {
+
+#if NOMPI==0
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		int iter = 0;
+
+		/**<Instantation of a 2D para_tree object.*/
+		Class_Para_Tree<2> pablo26;
+
+		/**<Refine globally two level: the octree has 16 octants.*/
+		for (iter=1; iter<3; iter++){
+			pablo26.adaptGlobalRefine();
+		}
+
+#if NOMPI==0
+		/**<Keep at least 16 octants per active process: with few octants the octree is
+		 * distributed only on the first processes, the other processes are idle.*/
+		pablo26.setShrinkThreshold(16);
+		int fullRank;
+		MPI_Comm_rank(MPI_COMM_WORLD, &fullRank);
+#endif
+
+		/**<Refine globally three times, the idle processes are activated when the mesh grows.*/
+		for (iter=0; iter<4; iter++){
+#if NOMPI==0
+			/**<loadBalance is called by all the processes, the other methods return immediately on the idle ones.*/
+			pablo26.loadBalance();
+			int local[2] = {int(pablo26.getNumOctants()), int(pablo26.isActive())}, global[2];
+			MPI_Allreduce(local, global, 2, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+			if (fullRank == 0){
+				cout << "octants " << global[0] << ", active processes " << global[1] << endl;
+			}
+#endif
+			if (iter < 3){
+				pablo26.adaptGlobalRefine();
+			}
+		}
+
+#if NOMPI==0
+		/**<Raise the threshold and balance with a weight per octant: the octants and their weights
+		 * move first on the processes staying active.*/
+		pablo26.setShrinkThreshold(512);
+		uint32_t nocts = pablo26.getNumOctants();
+		vector<double> weights(nocts);
+		for (uint32_t i=0; i<nocts; i++){
+			vector<double> center = pablo26.getCenter(i);
+			weights[i] = 1.0 + center[0];
+		}
+		pablo26.loadBalance(weights);
+
+		/**<Communicate the global index on all the processes, the idle ones have no octants and no ghosts.*/
+		nocts = pablo26.getNumOctants();
+		vector<double> oct_idx(nocts), ghost_idx;
+		for (uint32_t i=0; i<nocts; i++){
+			oct_idx[i] = double(pablo26.getGlobalIdx(i));
+		}
+		pablo26.communicate(oct_idx, ghost_idx);
+		int local[3] = {int(nocts), int(pablo26.isActive()), int(ghost_idx.size() != pablo26.getNumGhosts())}, global[3];
+		MPI_Allreduce(local, global, 3, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+		if (fullRank == 0){
+			cout << "weighted load balance: octants " << global[0] << ", active processes " << global[1]
+					<< ", processes with wrong ghosts " << global[2] << endl;
+		}
+#endif
+
+		/**<Write the para_tree, the idle processes write nothing.*/
+		pablo26.updateConnectivity();
+		pablo26.write("Pablo26_iter0");
+
+#if NOMPI==0
+	}
+
+	MPI::Finalize();
+#endif
+}
@@ -0,0 +1,97 @@
+#include "preprocessor_defines.dat"
+#include "Class_Global.hpp"
+#include "Class_Para_Tree.hpp"
+#include <array>
+
+using namespace std;
+
+// =================================================================================== //
+
+int main(int argc, char *argv[]) {
+
+#if NOMPI==0
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		int iter = 0;
+
+		/**<Instantation of a 2D para_tree object.*/
+		Class_Para_Tree<2> pablo27;
+
+		/**<Refine globally four level.*/
+		for (iter=1; iter<5; iter++){
+			pablo27.adaptGlobalRefine();
+		}
+
+#if NOMPI==0
+		/**<PARALLEL TEST: Call loadBalance, the octree is now distributed over the processes.*/
+		pablo27.loadBalance();
+#endif
+
+		/**<Define a center point and a radius.*/
+		double xc, yc;
+		xc = yc = 0.5;
+		double radius = 0.25;
+
+		/**<Refine the octants with the center inside the circle and distribute the octree again.*/
+		for (iter=1; iter<3; iter++){
+			uint32_t nocts = pablo27.getNumOctants();
+			for (uint32_t i=0; i<nocts; i++){
+				vector<double> center = pablo27.getCenter(i);
+				if ((pow((center[0]-xc),2.0)+pow((center[1]-yc),2.0) <= pow(radius,2.0))){
+					pablo27.setMarker(i,1);
+				}
+			}
+			pablo27.adapt();
+#if NOMPI==0
+			pablo27.loadBalance();
+#endif
+		}
+
+		/**<Define the data of the octants: the global index (double) and the center (array of two double).*/
+		uint32_t nocts = pablo27.getNumOctants();
+		vector<double> oct_data(nocts);
+		vector<array<double,2> > oct_center(nocts);
+		for (uint32_t i=0; i<nocts; i++){
+			oct_data[i] = double(pablo27.getGlobalIdx(i));
+			vector<double> center = pablo27.getCenter(i);
+			oct_center[i][0] = center[0];
+			oct_center[i][1] = center[1];
+		}
+
+#if NOMPI==0
+		/**<Communicate the vectors of data directly: the ghost vectors are resized to the number of ghosts.*/
+		vector<double> ghost_data;
+		vector<array<double,2> > ghost_center;
+		pablo27.communicate(oct_data, ghost_data);
+		pablo27.communicate(oct_center, ghost_center);
+
+		/**<Check the ghost data against the global index and the center of the ghost octants.*/
+		uint32_t nghosts = pablo27.getNumGhosts();
+		int wrong = (ghost_data.size() != nghosts || ghost_center.size() != nghosts);
+		for (uint32_t i=0; i<nghosts && !wrong; i++){
+			Class_Octant<2> *ghost = pablo27.getGhostOctant(i);
+			vector<double> center = pablo27.getCenter(ghost);
+			if (ghost_data[i] != double(pablo27.getGhostGlobalIdx(i)) || ghost_center[i][0] != center[0] || ghost_center[i][1] != center[1]){
+				wrong++;
+			}
+		}
+		int nwrong = 0, ntotghosts = 0, nloc = nghosts;
+		MPI_Reduce(&wrong, &nwrong, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+		MPI_Reduce(&nloc, &ntotghosts, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+		if (pablo27.rank == 0){
+			cout << "ghosts " << ntotghosts << ", processes with wrong ghost data " << nwrong << endl;
+		}
+#endif
+
+		/**<Update the connectivity and write the para_tree.*/
+		pablo27.updateConnectivity();
+		pablo27.writeTest("Pablo27_iter0", oct_data);
+
+#if NOMPI==0
+	}
+
+	MPI::Finalize();
+#endif
+}
@@ -0,0 +1,102 @@
+#include "preprocessor_defines.dat"
+#include "Class_Global.hpp"
+#include "Class_Para_Tree.hpp"
+
+using namespace std;
+
+// =================================================================================== //
+
+/**<Combine the global index of a local octant with the global index received back from a ghost copy:
+ * the result is -1 if they differ.*/
+struct Check_Index {
+	double operator()(const double & local, const double & ghost) const {
+		return (local == ghost) ? local : -1.0;
+	}
+};
+
+// =================================================================================== //
+
+int main(int argc, char *argv[]) {
+
+#if NOMPI==0
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		int iter = 0;
+
+		/**<Instantation of a 2D para_tree object.*/
+		Class_Para_Tree<2> pablo28;
+
+		/**<Refine globally four level.*/
+		for (iter=1; iter<5; iter++){
+			pablo28.adaptGlobalRefine();
+		}
+
+#if NOMPI==0
+		/**<PARALLEL TEST: Call loadBalance, the octree is now distributed over the processes.*/
+		pablo28.loadBalance();
+#endif
+
+		/**<Define a center point and a radius.*/
+		double xc, yc;
+		xc = yc = 0.5;
+		double radius = 0.25;
+
+		/**<Refine the octants with the center inside the circle and distribute the octree again.*/
+		uint32_t nocts = pablo28.getNumOctants();
+		for (uint32_t i=0; i<nocts; i++){
+			vector<double> center = pablo28.getCenter(i);
+			if ((pow((center[0]-xc),2.0)+pow((center[1]-yc),2.0) <= pow(radius,2.0))){
+				pablo28.setMarker(i,1);
+			}
+		}
+		pablo28.adapt();
+#if NOMPI==0
+		pablo28.loadBalance();
+#endif
+
+		/**<Define the data of the octants: the number of ghost copies on the other processes (zero).*/
+		nocts = pablo28.getNumOctants();
+		uint32_t nghosts = pablo28.getNumGhosts();
+		vector<double> oct_copies(nocts, 0.0);
+
+#if NOMPI==0
+		/**<Every ghost contributes one to the octant owning it: the sum over the processes of the
+		 * accumulated copies is the total number of ghosts.*/
+		vector<double> ghost_copies(nghosts, 1.0);
+		pablo28.accumulate(oct_copies, ghost_copies);
+
+		/**<Send the global index to the ghosts and back to the owners, combined by a user functor.*/
+		vector<double> oct_idx(nocts), ghost_idx;
+		for (uint32_t i=0; i<nocts; i++){
+			oct_idx[i] = double(pablo28.getGlobalIdx(i));
+		}
+		pablo28.communicate(oct_idx, ghost_idx);
+		pablo28.accumulate(oct_idx, ghost_idx, Check_Index());
+
+		/**<Check the sum of the copies and the global indices.*/
+		double local[3] = {0.0, double(nghosts), 0.0}, global[3];
+		for (uint32_t i=0; i<nocts; i++){
+			local[0] += oct_copies[i];
+			if (oct_idx[i] != double(pablo28.getGlobalIdx(i))){
+				local[2] += 1.0;
+			}
+		}
+		MPI_Reduce(local, global, 3, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+		if (pablo28.rank == 0){
+			cout << "ghosts " << global[1] << ", accumulated copies " << global[0]
+					<< ", octants with wrong index " << global[2] << endl;
+		}
+#endif
+
+		/**<Update the connectivity and write the para_tree with the number of ghost copies.*/
+		pablo28.updateConnectivity();
+		pablo28.writeTest("Pablo28_iter0", oct_copies);
+
+#if NOMPI==0
+	}
+
+	MPI::Finalize();
+#endif
+}
@@ -0,0 +1,131 @@
+#include "preprocessor_defines.dat"
+#include "Class_Global.hpp"
+#include "Class_Para_Tree.hpp"
+#include <array>
+
+using namespace std;
+
+// =================================================================================== //
+
+/**<Fill the fields of the octants from their global index and center.*/
+void setFields(Class_Para_Tree<2> & pablo, vector<double> & phi, vector<array<float,3> > & vel, vector<uint64_t> & idx, vector<uint8_t> & level){
+	uint32_t nocts = pablo.getNumOctants();
+	phi.resize(nocts);
+	vel.resize(nocts);
+	idx.resize(nocts);
+	level.resize(nocts);
+	for (uint32_t i=0; i<nocts; i++){
+		vector<double> center = pablo.getCenter(i);
+		phi[i] = sin(center[0])*cos(center[1]);
+		vel[i][0] = float(center[0]);
+		vel[i][1] = float(center[1]);
+		vel[i][2] = float(pablo.getLevel(i));
+		idx[i] = pablo.getGlobalIdx(i);
+		level[i] = pablo.getLevel(i);
+	}
+}
+
+// =================================================================================== //
+
+int main(int argc, char *argv[]) {
+
+#if NOMPI==0
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		int iter = 0;
+
+		/**<Instantation of a 2D para_tree object.*/
+		Class_Para_Tree<2> pablo29;
+
+		/**<Refine globally four level.*/
+		for (iter=1; iter<5; iter++){
+			pablo29.adaptGlobalRefine();
+		}
+
+#if NOMPI==0
+		/**<PARALLEL TEST: Call loadBalance, the octree is now distributed over the processes.*/
+		pablo29.loadBalance();
+#endif
+
+		/**<Define the fields: a scalar (double), a vector of three components (float), the global index (uint64_t)
+		 * and the level (uint8_t, migrated by the load balance but not communicated to the ghosts).*/
+		vector<double> phi, ghost_phi;
+		vector<array<float,3> > vel, ghost_vel;
+		vector<uint64_t> idx, ghost_idx;
+		vector<uint8_t> level;
+		setFields(pablo29, phi, vel, idx, level);
+
+		/**<Register the fields, the ones with a ghost vector are communicated together.*/
+		Class_Data_Fields fields;
+		fields.addField<ADAPT_COPY>(phi, ghost_phi);
+		fields.addField<ADAPT_COPY>(vel, ghost_vel);
+		fields.addField<ADAPT_COPY>(idx, ghost_idx);
+		fields.addField<ADAPT_COPY>(level);
+
+#if NOMPI==0
+		/**<Communicate the fields with a ghost vector in one message per neighbor process.*/
+		pablo29.communicate(fields);
+
+		/**<Check the ghost values against the ghost octants.*/
+		uint32_t nghosts = pablo29.getNumGhosts();
+		int wrong[2] = {0, 0}, nwrong[2];
+		if (ghost_phi.size() != nghosts || ghost_vel.size() != nghosts || ghost_idx.size() != nghosts){
+			wrong[0]++;
+		}
+		for (uint32_t i=0; i<nghosts && !wrong[0]; i++){
+			Class_Octant<2> *ghost = pablo29.getGhostOctant(i);
+			vector<double> center = pablo29.getCenter(ghost);
+			if (ghost_phi[i] != sin(center[0])*cos(center[1]) || ghost_vel[i][0] != float(center[0])
+					|| ghost_vel[i][1] != float(center[1]) || ghost_vel[i][2] != float(pablo29.getLevel(ghost))
+					|| ghost_idx[i] != pablo29.getGhostGlobalIdx(i)){
+				wrong[0]++;
+			}
+		}
+
+		/**<Refine the octants in the lower left corner: the octree is not balanced anymore.*/
+		uint32_t nocts = pablo29.getNumOctants();
+		for (uint32_t i=0; i<nocts; i++){
+			vector<double> center = pablo29.getCenter(i);
+			if (center[0] < 0.4 && center[1] < 0.4){
+				pablo29.setMarker(i,1);
+			}
+		}
+		pablo29.adapt();
+		setFields(pablo29, phi, vel, idx, level);
+
+		/**<Load balance the octree with the fields: all the fields of an octant migrate in the same message.*/
+		pablo29.loadBalance(fields);
+
+		/**<Check the migrated values: the global index and the center of an octant do not change.*/
+		nocts = pablo29.getNumOctants();
+		if (phi.size() != nocts || vel.size() != nocts || idx.size() != nocts || level.size() != nocts){
+			wrong[1]++;
+		}
+		for (uint32_t i=0; i<nocts && !wrong[1]; i++){
+			vector<double> center = pablo29.getCenter(i);
+			if (phi[i] != sin(center[0])*cos(center[1]) || vel[i][0] != float(center[0]) || vel[i][1] != float(center[1])
+					|| vel[i][2] != float(pablo29.getLevel(i)) || idx[i] != pablo29.getGlobalIdx(i) || level[i] != pablo29.getLevel(i)){
+				wrong[1]++;
+			}
+		}
+		uint64_t migrated = pablo29.getMigratedOctants(), sumMigrated;
+		MPI_Reduce(wrong, nwrong, 2, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+		MPI_Reduce(&migrated, &sumMigrated, 1, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+		if (pablo29.rank == 0){
+			cout << "communicate: processes with wrong ghost fields " << nwrong[0] << endl;
+			cout << "loadBalance: migrated octants " << sumMigrated << ", processes with wrong fields " << nwrong[1] << endl;
+		}
+#endif
+
+		/**<Update the connectivity and write the para_tree with the scalar field.*/
+		pablo29.updateConnectivity();
+		pablo29.writeTest("Pablo29_iter0", phi);
+
+#if NOMPI==0
+	}
+
+	MPI::Finalize();
+#endif
+}
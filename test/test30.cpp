@@ -0,0 +1,81 @@
+#include "preprocessor_defines.dat"
+#include "Class_Global.hpp"
+#include "Class_Para_Tree.hpp"
+
+using namespace std;
+
+// =================================================================================== //
+
+/**<Refine the octants inside a small circle of center (xc,yc).*/
+void setCircleMarkers(Class_Para_Tree<2> & pablo, double xc, double yc){
+	double radius = 0.05;
+	uint32_t nocts = pablo.getNumOctants();
+	for (uint32_t i=0; i<nocts; i++){
+		vector<double> center = pablo.getCenter(i);
+		if ((pow((center[0]-xc),2.0)+pow((center[1]-yc),2.0) <= pow(radius,2.0))){
+			pablo.setMarker(i,1);
+		}
+	}
+}
+
+// =================================================================================== //
+
+int main(int argc, char *argv[]) {
+
+#if NOMPI==0
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		int iter = 0;
+
+		/**<Instantation of two 2D para_tree objects.*/
+		Class_Para_Tree<2> pablo30;
+		Class_Para_Tree<2> pablo30t;
+
+		/**<Refine globally five level and distribute the octrees.*/
+		for (iter=1; iter<6; iter++){
+			pablo30.adaptGlobalRefine();
+			pablo30t.adaptGlobalRefine();
+		}
+#if NOMPI==0
+		pablo30.loadBalance();
+		pablo30t.loadBalance();
+#endif
+
+		/**<Refine small circles along the diagonal, every step unbalances slightly the octrees: the first octree is balanced by the plain loadBalance,
+		 * the second one by the incremental loadBalance with tolerance 0.1 on the imbalance.*/
+		double tolerance = 0.1;
+		for (iter=0; iter<8; iter++){
+			double xc = 0.1 + 0.1*iter;
+			setCircleMarkers(pablo30, xc, 1.0-xc);
+			pablo30.adapt();
+			setCircleMarkers(pablo30t, xc, 1.0-xc);
+			pablo30t.adapt();
+#if NOMPI==0
+			pablo30.loadBalance();
+			pablo30t.loadBalance(tolerance);
+
+			/**<Compare the migrated octants and check that every process holds at most (1+tolerance) times the mean.*/
+			uint64_t migrated[2] = {pablo30.getMigratedOctants(), pablo30t.getMigratedOctants()}, sumMigrated[2];
+			MPI_Reduce(migrated, sumMigrated, 2, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+			Class_Partition_Stats stats = pablo30t.getPartitionStats();
+			if (pablo30.rank == 0){
+				cout << "iter " << iter << ": octants " << pablo30t.global_num_octants
+						<< ", migrated plain " << sumMigrated[0] << ", migrated with tolerance " << sumMigrated[1]
+						<< ", max/mean " << stats.octants.imbalance()
+						<< (stats.octants.max <= (1.0+tolerance)*stats.octants.mean ? " (within tolerance)" : " (OUT OF TOLERANCE)") << endl;
+			}
+#endif
+		}
+
+		/**<Update the connectivity and write the para_tree balanced with tolerance.*/
+		pablo30t.updateConnectivity();
+		pablo30t.write("Pablo30_iter0");
+
+#if NOMPI==0
+	}
+
+	MPI::Finalize();
+#endif
+}
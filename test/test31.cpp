@@ -0,0 +1,78 @@
+#include "preprocessor_defines.dat"
+#include "Class_Global.hpp"
+#include "Class_Para_Tree.hpp"
+
+using namespace std;
+
+// =================================================================================== //
+
+int main(int argc, char *argv[]) {
+
+#if NOMPI==0
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		int iter = 0;
+
+		/**<Instantation of two 2D para_tree objects.*/
+		Class_Para_Tree<2> pablo31;
+		Class_Para_Tree<2> pablo31d;
+
+#if NOMPI==0
+		/**<The global refinement of the second octree is distributed: each process generates only its partition.*/
+		pablo31d.setDistributeUniform(true);
+#endif
+
+		/**<Refine globally five level.*/
+		for (iter=1; iter<6; iter++){
+			pablo31.adaptGlobalRefine();
+			pablo31d.adaptGlobalRefine();
+		}
+
+#if NOMPI==0
+		/**<The first octree is still the same on each process, the second one is already distributed.*/
+		int wrong[2] = {0, 0}, nwrong[2];
+		if (pablo31.getNumOctants() != pablo31.global_num_octants){
+			wrong[0]++;
+		}
+		uint64_t nocts31d = pablo31d.getNumOctants(), sum31d;
+		MPI_Allreduce(&nocts31d, &sum31d, 1, MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+		if (sum31d != pablo31d.global_num_octants || (pablo31d.nproc > 1 && nocts31d == pablo31d.global_num_octants)){
+			wrong[0]++;
+		}
+
+		/**<PARALLEL TEST: Call loadBalance on both the octrees (the second one is distributed since the first
+		 * global refinement with enough octants, then refined locally): the partitions of the two octrees are the same.*/
+		pablo31.loadBalance();
+		pablo31d.loadBalance();
+		uint32_t nocts = pablo31.getNumOctants();
+		if (nocts != pablo31d.getNumOctants()){
+			wrong[1]++;
+		}
+		for (uint32_t i=0; i<nocts && !wrong[1]; i++){
+			if (pablo31.getGlobalIdx(i) != pablo31d.getGlobalIdx(i) || pablo31.getLevel(i) != pablo31d.getLevel(i)
+					|| pablo31.getCenter(i) != pablo31d.getCenter(i) || pablo31.getBound(pablo31.getOctant(i)) != pablo31d.getBound(pablo31d.getOctant(i))){
+				wrong[1]++;
+			}
+		}
+		if (pablo31.getNumGhosts() != pablo31d.getNumGhosts()){
+			wrong[1]++;
+		}
+		MPI_Reduce(wrong, nwrong, 2, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+		if (pablo31.rank == 0){
+			cout << "octants " << pablo31.global_num_octants << ", processes with wrong serial or distributed refinement " << nwrong[0]
+					<< ", processes with different balanced octrees " << nwrong[1] << endl;
+		}
+#endif
+
+		/**<Update the connectivity and write the distributed para_tree.*/
+		pablo31d.updateConnectivity();
+		pablo31d.write("Pablo31_iter0");
+
+#if NOMPI==0
+	}
+
+	MPI::Finalize();
+#endif
+}
@@ -0,0 +1,104 @@
+#include "preprocessor_defines.dat"
+#include "Class_Global.hpp"
+#include "Class_Para_Tree.hpp"
+
+using namespace std;
+
+// =================================================================================== //
+
+/**<Refine to level 5 the octants inside a circle of center (xc,yc) and coarsen to level 4 the octants outside it:
+ * the max depth of the octree does not change.*/
+void setRingMarkers(Class_Para_Tree<2> & pablo, double xc, double yc){
+	double radius = 0.25;
+	uint32_t nocts = pablo.getNumOctants();
+	for (uint32_t i=0; i<nocts; i++){
+		vector<double> center = pablo.getCenter(i);
+		bool inside = (pow((center[0]-xc),2.0)+pow((center[1]-yc),2.0) <= pow(radius,2.0));
+		if (inside && pablo.getLevel(i) < 5){
+			pablo.setMarker(i,1);
+		}
+		else if (!inside && pablo.getLevel(i) > 4){
+			pablo.setMarker(i,-1);
+		}
+	}
+}
+
+// =================================================================================== //
+
+/**<Store the ghost octants of the local process: global index, level, center and boundary flags.*/
+void getGhostLayer(Class_Para_Tree<2> & pablo, vector<vector<double> > & ghostLayer){
+	uint32_t nghosts = pablo.getNumGhosts();
+	ghostLayer.resize(nghosts);
+	for (uint32_t i=0; i<nghosts; i++){
+		Class_Octant<2> *ghost = pablo.getGhostOctant(i);
+		vector<double> center = pablo.getCenter(ghost);
+		ghostLayer[i].clear();
+		ghostLayer[i].push_back(double(pablo.getGhostGlobalIdx(i)));
+		ghostLayer[i].push_back(double(pablo.getLevel(ghost)));
+		ghostLayer[i].push_back(center[0]);
+		ghostLayer[i].push_back(center[1]);
+		ghostLayer[i].push_back(double(pablo.getBalance(ghost)));
+		for (uint8_t iface=0; iface<4; iface++){
+			ghostLayer[i].push_back(double(pablo.getBound(ghost,iface)));
+			ghostLayer[i].push_back(double(pablo.getPbound(ghost,iface)));
+		}
+	}
+}
+
+// =================================================================================== //
+
+int main(int argc, char *argv[]) {
+
+#if NOMPI==0
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		int iter = 0;
+
+		/**<Instantation of a 2D para_tree object.*/
+		Class_Para_Tree<2> pablo32;
+
+		/**<Refine globally four level and distribute the octree.*/
+		for (iter=1; iter<5; iter++){
+			pablo32.adaptGlobalRefine();
+		}
+#if NOMPI==0
+		pablo32.loadBalance();
+#endif
+
+		/**<Move a refined circle along the diagonal: the partition and the max depth do not change,
+		 * so after every adapt the ghost layer is updated exchanging only the changed border octants.*/
+		for (iter=0; iter<6; iter++){
+			double xc = 0.25 + 0.1*iter;
+			setRingMarkers(pablo32, xc, xc);
+			pablo32.adapt();
+		}
+
+#if NOMPI==0
+		/**<Rebuild the complete ghost layer by a load balance keeping the partition (large tolerance)
+		 * and compare it with the incremental ghost layer.*/
+		vector<vector<double> > incrementalGhosts, fullGhosts;
+		getGhostLayer(pablo32, incrementalGhosts);
+		pablo32.loadBalance(100.0);
+		getGhostLayer(pablo32, fullGhosts);
+		int wrong = (incrementalGhosts != fullGhosts), nwrong;
+		uint64_t migrated = pablo32.getMigratedOctants(), sumMigrated;
+		MPI_Reduce(&wrong, &nwrong, 1, MPI_INT, MPI_SUM, 0, MPI_COMM_WORLD);
+		MPI_Reduce(&migrated, &sumMigrated, 1, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+		if (pablo32.rank == 0){
+			cout << "octants " << pablo32.global_num_octants << ", migrated octants " << sumMigrated
+					<< ", processes with incremental ghosts different from the rebuilt ones " << nwrong << endl;
+		}
+#endif
+
+		/**<Update the connectivity and write the para_tree.*/
+		pablo32.updateConnectivity();
+		pablo32.write("Pablo32_iter0");
+
+#if NOMPI==0
+	}
+
+	MPI::Finalize();
+#endif
+}
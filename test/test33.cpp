@@ -0,0 +1,101 @@
+#include "preprocessor_defines.dat"
+#include "Class_Global.hpp"
+#include "Class_Para_Tree.hpp"
+
+using namespace std;
+
+// =================================================================================== //
+
+/**<Density of the mass field, a smooth function of the octant center.*/
+double density(const vector<double> & center){
+	return 1.0 + center[0] + center[1]*center[1];
+}
+
+// =================================================================================== //
+
+int main(int argc, char *argv[]) {
+
+#if NOMPI==0
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		/**<Instantation of a 2D para_tree object.*/
+		Class_Para_Tree<2> pablo33;
+
+		/**<Refine globally five level.*/
+		for (int iter=1; iter<6; iter++){
+			pablo33.adaptGlobalRefine();
+		}
+
+#if NOMPI==0
+		/**<PARALLEL TEST: Call loadBalance, the partition boundaries split some families of octants
+		 * (with 3 processes every process holds a number of octants not multiple of 4).*/
+		pablo33.loadBalance();
+#endif
+
+		/**<Define the user fields: the mass of the octants (volume-weighted, summed in coarsening)
+		 * and the density (averaged in coarsening).*/
+		uint32_t nocts = pablo33.getNumOctants();
+		vector<double> mass(nocts), rho(nocts);
+		for (uint32_t i=0; i<nocts; i++){
+			vector<double> center = pablo33.getCenter(i);
+			rho[i] = density(center);
+			mass[i] = rho[i]*pablo33.getVolume(i);
+		}
+
+		/**<Register the fields, Class_Data_Fields are load balance user data too: the children of a family
+		 * split between two processes are sent to the process that keeps the father.*/
+		Class_Data_Fields fields;
+		fields.addField<ADAPT_VOLUME>(mass);
+		fields.addField<ADAPT_AVERAGE>(rho);
+
+		/**<Coarse the octree three times, load balancing it after every adapt.*/
+		for (int iter=0; iter<3; iter++){
+			double localMass[2] = {0.0, 0.0}, globalMass[2];
+			nocts = pablo33.getNumOctants();
+			for (uint32_t i=0; i<nocts; i++){
+				localMass[0] += mass[i];
+				pablo33.setMarker(i, -1);
+			}
+			pablo33.adapt(fields);
+#if NOMPI==0
+			pablo33.loadBalance(fields);
+#endif
+
+			/**<The total mass is preserved and the density of the new fathers is the mean density of all
+			 * their children, i.e. the mass of the father over its area (getVolume in 2D).*/
+			int wrong = 0;
+			nocts = pablo33.getNumOctants();
+			for (uint32_t i=0; i<nocts; i++){
+				localMass[1] += mass[i];
+				if (fabs(rho[i]*pablo33.getVolume(i) - mass[i]) > 1.0e-12*mass[i]){
+					wrong++;
+				}
+			}
+#if NOMPI==0
+			int nwrong = 0;
+			MPI_Allreduce(localMass, globalMass, 2, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+			MPI_Allreduce(&wrong, &nwrong, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+			wrong = nwrong;
+#else
+			globalMass[0] = localMass[0];
+			globalMass[1] = localMass[1];
+#endif
+			if (pablo33.rank == 0){
+				cout << "iter " << iter << ": octants " << pablo33.global_num_octants << ", mass before " << setprecision(15) << globalMass[0]
+						<< ", mass after " << globalMass[1] << ", relative error " << setprecision(3) << fabs(globalMass[1]-globalMass[0])/globalMass[0]
+						<< ", octants with wrong density " << wrong << endl;
+			}
+		}
+
+		/**<Update the connectivity and write the para_tree with the density.*/
+		pablo33.updateConnectivity();
+		pablo33.writeTest("Pablo33_iter0", rho);
+
+#if NOMPI==0
+	}
+
+	MPI::Finalize();
+#endif
+}
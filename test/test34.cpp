@@ -0,0 +1,83 @@
+#include "preprocessor_defines.dat"
+#include "Class_Global.hpp"
+#include "Class_Para_Tree.hpp"
+
+using namespace std;
+
+// =================================================================================== //
+
+int main(int argc, char *argv[]) {
+
+#if NOMPI==0
+	MPI::Init(argc, argv);
+
+	{
+#endif
+		/**<Instantation of a 2D para_tree object.*/
+		Class_Para_Tree<2> pablo34;
+
+		/**<Refine globally four level.*/
+		for (int iter=1; iter<5; iter++){
+			pablo34.adaptGlobalRefine();
+		}
+
+		/**<Define a center point and a radius.*/
+		double xc, yc;
+		xc = yc = 0.5;
+		double radius = 0.25;
+
+		/**<Define the user data: a smooth function of the octant center (copied in refinement and coarsening),
+		 * the area of the octants (split in refinement and summed in coarsening) and the x coordinate of the center.*/
+		uint32_t nocts = pablo34.getNumOctants();
+		vector<double> phi(nocts), area(nocts), x(nocts);
+		for (int i=0; i<nocts; i++){
+			vector<double> center = pablo34.getCenter(i);
+			phi[i] = sqrt(pow((center[0]-xc),2.0)+pow((center[1]-yc),2.0)) - radius;
+			area[i] = pablo34.getVolume(i);
+		}
+
+		/**<Refine the octants crossed by the circle and coarse the others 5 times.
+		 * The change set of every adapt updates the user data in place.*/
+		Class_Adapt_Changes changes;
+		for (int iter=0; iter<5; iter++){
+			nocts = pablo34.getNumOctants();
+			for (int i=0; i<nocts; i++){
+				x[i] = pablo34.getCenter(i)[0];
+				double size = pablo34.getSize(i);
+				if (fabs(phi[i]) < size){
+					pablo34.setMarker(i, 1);
+				}
+				else if (pablo34.getLevel(i) > 2){
+					pablo34.setMarker(i, -1);
+				}
+			}
+			pablo34.adapt(changes);
+			changes.apply(phi);
+			changes.apply(x);
+			changes.applyShare(area);
+
+			/**<The area is the area of the new octants and the unchanged octants keep their center.*/
+			int wrong = 0;
+			for (int i=0; i<pablo34.getNumOctants(); i++){
+				bool unchanged = !pablo34.getIsNewR(i) && !pablo34.getIsNewC(i);
+				if (fabs(area[i] - pablo34.getVolume(i)) > 1.0e-12*area[i] || (unchanged && x[i] != pablo34.getCenter(i)[0])){
+					wrong++;
+				}
+			}
+			pablo34.log.writeLog(" Kept runs : " + to_string(changes.kept.size()) + ", refined : " + to_string(changes.refined.size())
+					+ ", coarsened : " + to_string(changes.coarsened.size()) + ", octants with wrong data : " + to_string(wrong));
+			if (pablo34.rank == 0){
+				cout << "iter " << iter << ": octants " << changes.oldSize << " -> " << changes.newSize << ", kept runs " << changes.kept.size()
+						<< ", refined " << changes.refined.size() << ", coarsened " << changes.coarsened.size()
+						<< ", octants with wrong data " << wrong << endl;
+			}
+		}
+		pablo34.updateConnectivity();
+		pablo34.writeTest("Pablo34", phi);
+
+#if NOMPI==0
+	}
+
+	MPI::Finalize();
+#endif
+}